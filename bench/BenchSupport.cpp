@@ -0,0 +1,154 @@
+#include "BenchSupport.h"
+#include "SimulatedDualSense.h"
+#include "DualSenseReport.h"
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <random>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+// Counts C++ heap allocations (the array and nothrow forms forward to these)
+static std::atomic<uint64_t> g_heapAllocations{0};
+
+void* operator new(std::size_t size) {
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* block = std::malloc(size ? size : 1)) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    size = (size + align - 1) / align * align;
+#ifdef _WIN32
+    void* block = _aligned_malloc(size ? size : align, align);
+#else
+    void* block = std::aligned_alloc(align, size ? size : align);
+#endif
+    if (block) {
+        return block;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::size_t) noexcept {
+    std::free(block);
+}
+
+void operator delete(void* block, std::align_val_t) noexcept {
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    std::free(block);
+#endif
+}
+
+void operator delete(void* block, std::size_t, std::align_val_t alignment) noexcept {
+    operator delete(block, alignment);
+}
+
+uint64_t heapAllocationCount() {
+    return g_heapAllocations.load(std::memory_order_relaxed);
+}
+
+std::vector<std::vector<uint8_t>> generateReports(bool bluetooth, size_t count) {
+    SimulatedDualSense generator(bluetooth ? SimulatedDualSense::Transport::Bluetooth
+                                           : SimulatedDualSense::Transport::USB);
+    generator.connect();
+    std::vector<std::vector<uint8_t>> reports;
+    for (size_t i = 0; i < count && generator.update(); i++) {
+        reports.emplace_back(generator.getLastReport(), generator.getLastReport() + generator.getLastReportSize());
+    }
+    return reports;
+}
+
+std::vector<NormalizedState> generateStates(size_t count) {
+    std::vector<NormalizedState> states;
+    for (const auto& report : generateReports(false, count)) {
+        ControllerState raw;
+        parseDualSenseReport(report.data(), report.size(), raw);
+        states.push_back(normalizeControllerState(raw));
+    }
+    return states;
+}
+
+uint32_t crc32Bitwise(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320u : 0u);
+        }
+    }
+    return ~crc;
+}
+
+namespace {
+
+struct Quat {
+    double w = 1.0, x = 0.0, y = 0.0, z = 0.0;
+
+    Quat operator*(const Quat& q) const {
+        return {w * q.w - x * q.x - y * q.y - z * q.z, w * q.x + x * q.w + y * q.z - z * q.y,
+                w * q.y - x * q.z + y * q.w + z * q.x, w * q.z + x * q.y - y * q.x + z * q.w};
+    }
+
+    // World up (+Y) in body coordinates
+    void up(double& ux, double& uy, double& uz) const {
+        ux = 2.0 * (x * y + w * z);
+        uy = 1.0 - 2.0 * (x * x + z * z);
+        uz = 2.0 * (y * z - w * x);
+    }
+};
+
+}  // namespace
+
+std::vector<FusionSample> generateFusionTrajectory(double seconds, const double (&biasDegS)[3]) {
+    constexpr double DT = 0.001;
+    constexpr double DEG = 3.14159265358979323846 / 180.0;
+    std::mt19937 rng(18);
+    std::normal_distribution<double> gyroNoise(0.0, 0.2);
+    std::normal_distribution<double> accelNoise(0.0, 0.005);
+
+    std::vector<FusionSample> samples;
+    Quat truth;
+    for (double t = 0.0; t < seconds; t += DT) {
+        bool moving = t >= 3.0 && t < 13.0;
+        double rate[3] = {0.0, 0.0, 0.0};
+        if (moving) {
+            double m = t - 3.0;
+            rate[0] = 60.0 * std::sin(2.0 * 3.14159265358979323846 * 0.5 * m);
+            rate[1] = 90.0 * std::sin(2.0 * 3.14159265358979323846 * 0.3 * m);
+            rate[2] = 40.0 * std::sin(2.0 * 3.14159265358979323846 * 0.7 * m);
+        }
+
+        // Exact rotation over the step
+        double angle = std::sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]) * DEG * DT;
+        if (angle > 0.0) {
+            double s = std::sin(angle / 2.0) / (angle / (DEG * DT));
+            truth = truth * Quat{std::cos(angle / 2.0), rate[0] * s, rate[1] * s, rate[2] * s};
+        }
+
+        FusionSample sample;
+        truth.up(sample.upX, sample.upY, sample.upZ);
+        sample.moving = moving;
+        NormalizedState& state = sample.state;
+        state.deltaTime = static_cast<float>(DT);
+        state.gyroX = static_cast<float>(rate[0] + biasDegS[0] + gyroNoise(rng));
+        state.gyroY = static_cast<float>(rate[1] + biasDegS[1] + gyroNoise(rng));
+        state.gyroZ = static_cast<float>(rate[2] + biasDegS[2] + gyroNoise(rng));
+        state.accelX = static_cast<float>(sample.upX + accelNoise(rng));
+        state.accelY = static_cast<float>(sample.upY + accelNoise(rng));
+        state.accelZ = static_cast<float>(sample.upZ + accelNoise(rng));
+        samples.push_back(sample);
+    }
+    return samples;
+}
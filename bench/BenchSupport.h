@@ -0,0 +1,34 @@
+#pragma once
+
+// Input generators and reference implementations shared by ps5scripts_bench
+// (which times them) and ps5scripts_tests (which checks against them).
+
+#include "Common.h"
+
+// C++ heap allocations since start-up. BenchSupport.cpp replaces the global
+// operator new of whichever executable links it, so a test can check a path
+// allocates nothing outside the Lua heap either.
+uint64_t heapAllocationCount();
+
+// Reports from the SimulatedDualSense generator, which steps its routine 1 ms
+// per report and exercises every button, D-Pad direction and touch gesture.
+// Generator reports rather than random bytes for timing: random touch bytes
+// would make the touch branch mispredict half the time.
+std::vector<std::vector<uint8_t>> generateReports(bool bluetooth, size_t count);
+
+// The same USB reports, parsed and normalized
+std::vector<NormalizedState> generateStates(size_t count);
+
+// Bit-at-a-time CRC-32 (IEEE, reflected), the reference for the sliced one
+uint32_t crc32Bitwise(const uint8_t* data, size_t length);
+
+// A known orientation trajectory at 1 kHz: 3 s still, 10 s of rotation on
+// all axes, then still. Gyro samples carry the given bias plus noise.
+struct FusionSample {
+    NormalizedState state;
+    InputContext context;   // Filled in by the filter under test
+    double upX, upY, upZ;   // Ground truth: world up in body coordinates
+    bool moving;
+};
+
+std::vector<FusionSample> generateFusionTrajectory(double seconds, const double (&biasDegS)[3]);
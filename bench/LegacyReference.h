@@ -0,0 +1,299 @@
+#pragma once
+
+// Reference copies of the original state structs (one bool per button), the
+// hand-written DualSense input parsers and the Xbox conversion, as they were
+// before the shared payload parser and packed button masks. Only used by the
+// tests, to check the current code report for report, and by the bench, to
+// compare speed and struct size.
+
+#include "Common.h"
+#include "XusbReport.h"
+
+namespace legacy {
+
+struct ControllerState {
+    // Sticks (0-255, 128 = center)
+    uint8_t leftStickX = 128;
+    uint8_t leftStickY = 128;
+    uint8_t rightStickX = 128;
+    uint8_t rightStickY = 128;
+
+    // Triggers (0-255)
+    uint8_t leftTrigger = 0;
+    uint8_t rightTrigger = 0;
+
+    // D-Pad (0-7 for directions, 8 = released)
+    uint8_t dpad = 8;
+
+    // Buttons
+    bool square = false;
+    bool cross = false;
+    bool circle = false;
+    bool triangle = false;
+    bool l1 = false;
+    bool r1 = false;
+    bool l2Button = false;  // L2 as button (fully pressed)
+    bool r2Button = false;  // R2 as button
+    bool share = false;     // Create button on PS5
+    bool options = false;
+    bool l3 = false;        // Left stick press
+    bool r3 = false;        // Right stick press
+    bool ps = false;        // PS button
+    bool touchpad = false;  // Touchpad press
+    bool mute = false;      // Mute button
+
+    // Touchpad coordinates (if needed)
+    int16_t touchX = 0;
+    int16_t touchY = 0;
+    bool touchActive = false;
+
+    // Gyro/Accelerometer (raw values)
+    int16_t gyroX = 0;
+    int16_t gyroY = 0;
+    int16_t gyroZ = 0;
+    int16_t accelX = 0;
+    int16_t accelY = 0;
+    int16_t accelZ = 0;
+
+    // Device sensor clock (DUALSENSE_SENSOR_TICK_US units, wraps at 2^32)
+    uint32_t sensorTimestamp = 0;
+
+    // Timestamp
+    uint64_t timestamp = 0;
+};
+
+struct NormalizedState {
+    float leftStickX = 0.0f;
+    float leftStickY = 0.0f;
+    float rightStickX = 0.0f;
+    float rightStickY = 0.0f;
+    float leftTrigger = 0.0f;
+    float rightTrigger = 0.0f;
+
+    // Buttons same as ControllerState
+    bool square = false;
+    bool cross = false;
+    bool circle = false;
+    bool triangle = false;
+    bool l1 = false;
+    bool r1 = false;
+    bool l2Button = false;
+    bool r2Button = false;
+    bool share = false;
+    bool options = false;
+    bool l3 = false;
+    bool r3 = false;
+    bool ps = false;
+    bool touchpad = false;
+    bool mute = false;
+    uint8_t dpad = 8;
+
+    // Gyro normalized
+    float gyroX = 0.0f;
+    float gyroY = 0.0f;
+    float gyroZ = 0.0f;
+
+    // Delta time since last update (seconds)
+    float deltaTime = 0.0f;
+};
+
+inline void parseUSBReport(const uint8_t* data, ControllerState& state) {
+    // USB report structure (offset by 1 for report ID)
+    state.leftStickX = data[1];
+    state.leftStickY = data[2];
+    state.rightStickX = data[3];
+    state.rightStickY = data[4];
+    state.leftTrigger = data[5];
+    state.rightTrigger = data[6];
+
+    // Buttons byte 8
+    uint8_t buttons1 = data[8];
+    state.dpad = buttons1 & 0x0F;
+    state.square = (buttons1 & 0x10) != 0;
+    state.cross = (buttons1 & 0x20) != 0;
+    state.circle = (buttons1 & 0x40) != 0;
+    state.triangle = (buttons1 & 0x80) != 0;
+
+    // Buttons byte 9
+    uint8_t buttons2 = data[9];
+    state.l1 = (buttons2 & 0x01) != 0;
+    state.r1 = (buttons2 & 0x02) != 0;
+    state.l2Button = (buttons2 & 0x04) != 0;
+    state.r2Button = (buttons2 & 0x08) != 0;
+    state.share = (buttons2 & 0x10) != 0;
+    state.options = (buttons2 & 0x20) != 0;
+    state.l3 = (buttons2 & 0x40) != 0;
+    state.r3 = (buttons2 & 0x80) != 0;
+
+    // Buttons byte 10
+    uint8_t buttons3 = data[10];
+    state.ps = (buttons3 & 0x01) != 0;
+    state.touchpad = (buttons3 & 0x02) != 0;
+    state.mute = (buttons3 & 0x04) != 0;
+
+    // Gyro and accelerometer (bytes 16-27)
+    state.gyroX = static_cast<int16_t>(data[16] | (data[17] << 8));
+    state.gyroY = static_cast<int16_t>(data[18] | (data[19] << 8));
+    state.gyroZ = static_cast<int16_t>(data[20] | (data[21] << 8));
+    state.accelX = static_cast<int16_t>(data[22] | (data[23] << 8));
+    state.accelY = static_cast<int16_t>(data[24] | (data[25] << 8));
+    state.accelZ = static_cast<int16_t>(data[26] | (data[27] << 8));
+
+    // Sensor timestamp (bytes 28-31)
+    state.sensorTimestamp = static_cast<uint32_t>(data[28]) | (static_cast<uint32_t>(data[29]) << 8) |
+                            (static_cast<uint32_t>(data[30]) << 16) | (static_cast<uint32_t>(data[31]) << 24);
+
+    // Touch data (bytes 33+)
+    if (data[33] & 0x80) {
+        state.touchActive = false;
+    } else {
+        state.touchActive = true;
+        state.touchX = ((data[35] & 0x0F) << 8) | data[34];
+        state.touchY = (data[36] << 4) | ((data[35] & 0xF0) >> 4);
+    }
+}
+
+inline void parseBluetoothReport(const uint8_t* data, ControllerState& state) {
+    // Bluetooth report has 1 byte offset compared to USB
+    state.leftStickX = data[2];
+    state.leftStickY = data[3];
+    state.rightStickX = data[4];
+    state.rightStickY = data[5];
+    state.leftTrigger = data[6];
+    state.rightTrigger = data[7];
+
+    // Buttons
+    uint8_t buttons1 = data[9];
+    state.dpad = buttons1 & 0x0F;
+    state.square = (buttons1 & 0x10) != 0;
+    state.cross = (buttons1 & 0x20) != 0;
+    state.circle = (buttons1 & 0x40) != 0;
+    state.triangle = (buttons1 & 0x80) != 0;
+
+    uint8_t buttons2 = data[10];
+    state.l1 = (buttons2 & 0x01) != 0;
+    state.r1 = (buttons2 & 0x02) != 0;
+    state.l2Button = (buttons2 & 0x04) != 0;
+    state.r2Button = (buttons2 & 0x08) != 0;
+    state.share = (buttons2 & 0x10) != 0;
+    state.options = (buttons2 & 0x20) != 0;
+    state.l3 = (buttons2 & 0x40) != 0;
+    state.r3 = (buttons2 & 0x80) != 0;
+
+    uint8_t buttons3 = data[11];
+    state.ps = (buttons3 & 0x01) != 0;
+    state.touchpad = (buttons3 & 0x02) != 0;
+    state.mute = (buttons3 & 0x04) != 0;
+
+    // Gyro/Accel at different offsets for Bluetooth
+    state.gyroX = static_cast<int16_t>(data[17] | (data[18] << 8));
+    state.gyroY = static_cast<int16_t>(data[19] | (data[20] << 8));
+    state.gyroZ = static_cast<int16_t>(data[21] | (data[22] << 8));
+    state.accelX = static_cast<int16_t>(data[23] | (data[24] << 8));
+    state.accelY = static_cast<int16_t>(data[25] | (data[26] << 8));
+    state.accelZ = static_cast<int16_t>(data[27] | (data[28] << 8));
+
+    state.sensorTimestamp = static_cast<uint32_t>(data[29]) | (static_cast<uint32_t>(data[30]) << 8) |
+                            (static_cast<uint32_t>(data[31]) << 16) | (static_cast<uint32_t>(data[32]) << 24);
+}
+
+inline bool parseDualSenseReport(const uint8_t* data, size_t length, ControllerState& state) {
+    if (length >= 64 && data[0] == 0x01) {
+        parseUSBReport(data, state);
+        return true;
+    } else if (length >= 78 && data[0] == 0x31) {
+        parseBluetoothReport(data, state);
+        return true;
+    }
+    return false;
+}
+
+inline NormalizedState normalizeControllerState(const ControllerState& state) {
+    NormalizedState norm;
+
+    // Normalize sticks to -1.0 to 1.0
+    norm.leftStickX = normalizeStick(state.leftStickX);
+    norm.leftStickY = normalizeStick(state.leftStickY);
+    norm.rightStickX = normalizeStick(state.rightStickX);
+    norm.rightStickY = normalizeStick(state.rightStickY);
+
+    // Normalize triggers to 0.0 to 1.0
+    norm.leftTrigger = normalizeTrigger(state.leftTrigger);
+    norm.rightTrigger = normalizeTrigger(state.rightTrigger);
+
+    // Copy buttons
+    norm.square = state.square;
+    norm.cross = state.cross;
+    norm.circle = state.circle;
+    norm.triangle = state.triangle;
+    norm.l1 = state.l1;
+    norm.r1 = state.r1;
+    norm.l2Button = state.l2Button;
+    norm.r2Button = state.r2Button;
+    norm.share = state.share;
+    norm.options = state.options;
+    norm.l3 = state.l3;
+    norm.r3 = state.r3;
+    norm.ps = state.ps;
+    norm.touchpad = state.touchpad;
+    norm.mute = state.mute;
+    norm.dpad = state.dpad;
+
+    // Normalize gyro (typical range is about -2000 to 2000 for normal movement)
+    constexpr float GYRO_SCALE = 1.0f / 2000.0f;
+    norm.gyroX = static_cast<float>(state.gyroX) * GYRO_SCALE;
+    norm.gyroY = static_cast<float>(state.gyroY) * GYRO_SCALE;
+    norm.gyroZ = static_cast<float>(state.gyroZ) * GYRO_SCALE;
+
+    return norm;
+}
+
+inline ::XusbReport toXusbReport(const NormalizedState& state) {
+    ::XusbReport report;
+
+    // Convert normalized sticks (-1.0 to 1.0) to Xbox format (-32768 to 32767)
+    report.sThumbLX = static_cast<int16_t>(std::clamp(state.leftStickX * 32767.0f, -32768.0f, 32767.0f));
+    report.sThumbLY = static_cast<int16_t>(std::clamp(-state.leftStickY * 32767.0f, -32768.0f, 32767.0f));  // Inverted Y
+    report.sThumbRX = static_cast<int16_t>(std::clamp(state.rightStickX * 32767.0f, -32768.0f, 32767.0f));
+    report.sThumbRY = static_cast<int16_t>(std::clamp(-state.rightStickY * 32767.0f, -32768.0f, 32767.0f));  // Inverted Y
+
+    // Convert triggers (0.0 to 1.0) to Xbox format (0 to 255)
+    report.bLeftTrigger = static_cast<uint8_t>(std::clamp(state.leftTrigger * 255.0f, 0.0f, 255.0f));
+    report.bRightTrigger = static_cast<uint8_t>(std::clamp(state.rightTrigger * 255.0f, 0.0f, 255.0f));
+
+    // Map buttons
+    // PS5 -> Xbox mapping:
+    // Cross -> A, Circle -> B, Square -> X, Triangle -> Y
+    // L1 -> LB, R1 -> RB, L3 -> LS, R3 -> RS
+    // Share -> Back, Options -> Start, PS -> Guide
+    report.wButtons = 0;
+
+    if (state.cross)     report.wButtons |= XUSB_BUTTON_A;
+    if (state.circle)    report.wButtons |= XUSB_BUTTON_B;
+    if (state.square)    report.wButtons |= XUSB_BUTTON_X;
+    if (state.triangle)  report.wButtons |= XUSB_BUTTON_Y;
+    if (state.l1)        report.wButtons |= XUSB_BUTTON_LEFT_SHOULDER;
+    if (state.r1)        report.wButtons |= XUSB_BUTTON_RIGHT_SHOULDER;
+    if (state.l3)        report.wButtons |= XUSB_BUTTON_LEFT_THUMB;
+    if (state.r3)        report.wButtons |= XUSB_BUTTON_RIGHT_THUMB;
+    if (state.share)     report.wButtons |= XUSB_BUTTON_BACK;
+    if (state.options)   report.wButtons |= XUSB_BUTTON_START;
+    if (state.ps)        report.wButtons |= XUSB_BUTTON_GUIDE;
+
+    // D-Pad mapping (PS5 uses 0-7 for directions, 8 = released)
+    switch (state.dpad) {
+        case 0: report.wButtons |= XUSB_BUTTON_DPAD_UP; break;
+        case 1: report.wButtons |= XUSB_BUTTON_DPAD_UP | XUSB_BUTTON_DPAD_RIGHT; break;
+        case 2: report.wButtons |= XUSB_BUTTON_DPAD_RIGHT; break;
+        case 3: report.wButtons |= XUSB_BUTTON_DPAD_DOWN | XUSB_BUTTON_DPAD_RIGHT; break;
+        case 4: report.wButtons |= XUSB_BUTTON_DPAD_DOWN; break;
+        case 5: report.wButtons |= XUSB_BUTTON_DPAD_DOWN | XUSB_BUTTON_DPAD_LEFT; break;
+        case 6: report.wButtons |= XUSB_BUTTON_DPAD_LEFT; break;
+        case 7: report.wButtons |= XUSB_BUTTON_DPAD_UP | XUSB_BUTTON_DPAD_LEFT; break;
+        default: break;  // 8 = released
+    }
+
+    return report;
+}
+
+}  // namespace legacy
@@ -0,0 +1,1375 @@
+// Headless benchmark for the input pipeline.
+//
+// Drives synthetic (or replayed) DualSense USB/Bluetooth reports through report
+// parsing, the shipped Lua script chain and the Xbox report conversion, and
+// reports throughput, CPU time per frame and tail latency. Builds and runs
+// without Win32, D3D11, ImGui or ViGEm. It only measures; the correctness
+// checks are in ps5scripts_tests.
+//
+// Usage: ps5scripts_bench [options]
+//   --rate <hz>          Report rate to emulate, 0 = unpaced (default 1000)
+//   --seconds <s>        Duration of each run (default 5)
+//   --transport <t>      usb, bt or both (default both)
+//   --scripts <dir>      Script folder (default: the repo's scripts/)
+//   --replay <file>      Replay raw input reports instead of the generator
+//   --scenario <name>    pipeline, snapshot, pacing, backlog, parser, state, crc,
+//                        output, touch, fusion, hotplug, pads, bridge, params,
+//                        engines, gc or all (default pipeline)
+//   --backlog <policy>   latest or replay: queued-report policy for pipeline runs
+//   --spin-us <us>       Pacing spin window before each deadline (default 200)
+//   --priority <p>       Pacing thread priority: normal, high, games or proaudio
+//   --affinity <mask>    Pacing thread CPU mask in hex (default: any CPU)
+//   --timer-us <us>      Pacing timer resolution / slack (default: OS default)
+//   --csv <file>         Write latency summaries as CSV
+//   --json <file>        Write latency summaries as JSON
+
+#include "InputProcessor.h"
+#include "PipelinePool.h"
+#include "SimulatedDualSense.h"
+#include "CaptureSink.h"
+#include "StateSnapshot.h"
+#include "LatencyHistogram.h"
+#include "PacingScheduler.h"
+#include "ThreadTuning.h"
+#include "DualSenseReport.h"
+#include "Crc32.h"
+#include "TouchGestures.h"
+#include "MotionFusion.h"
+#include "LegacyReference.h"
+#include "BenchSupport.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <random>
+#include <iostream>
+#include <sstream>
+
+#ifndef PS5SCRIPTS_DEFAULT_SCRIPTS_DIR
+#define PS5SCRIPTS_DEFAULT_SCRIPTS_DIR "scripts"
+#endif
+
+namespace {
+
+struct BenchOptions {
+    float rateHz = 1000.0f;
+    double seconds = 5.0;
+    bool usb = true;
+    bool bluetooth = true;
+    std::string scriptsFolder = PS5SCRIPTS_DEFAULT_SCRIPTS_DIR;
+    std::string replayFile;
+    bool runPipeline = true;
+    bool runSnapshot = false;
+    bool runPacing = false;
+    bool runBacklog = false;
+    bool runParser = false;
+    bool runState = false;
+    bool runCrc = false;
+    bool runOutput = false;
+    bool runTouch = false;
+    bool runFusion = false;
+    bool runHotplug = false;
+    bool runPads = false;
+    bool runBridge = false;
+    bool runParams = false;
+    bool runEngines = false;
+    bool runGc = false;
+    BacklogPolicy backlogPolicy = BacklogPolicy::LatestOnly;
+    int spinUs = 200;
+    ThreadTuning tuning;
+    std::string csvFile;
+    std::string jsonFile;
+};
+
+void printUsage() {
+    std::printf("Usage: ps5scripts_bench [--rate hz] [--seconds s] [--transport usb|bt|both]\n"
+                "                        [--scripts dir] [--replay file] [--scenario pipeline|snapshot|pacing|backlog|parser|state|crc|output|touch|fusion|hotplug|pads|bridge|params|engines|gc|all]\n"
+                "                        [--spin-us us] [--priority normal|high|games|proaudio] [--affinity mask]\n"
+                "                        [--timer-us us] [--backlog latest|replay] [--csv file] [--json file]\n");
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--rate" && hasValue) {
+            options.rateHz = std::strtof(argv[++i], nullptr);
+        } else if (arg == "--seconds" && hasValue) {
+            options.seconds = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--transport" && hasValue) {
+            std::string value = argv[++i];
+            options.usb = (value == "usb" || value == "both");
+            options.bluetooth = (value == "bt" || value == "both");
+            if (!options.usb && !options.bluetooth) return false;
+        } else if (arg == "--scripts" && hasValue) {
+            options.scriptsFolder = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            options.replayFile = argv[++i];
+        } else if (arg == "--scenario" && hasValue) {
+            std::string value = argv[++i];
+            options.runPipeline = (value == "pipeline" || value == "all");
+            options.runSnapshot = (value == "snapshot" || value == "all");
+            options.runPacing = (value == "pacing" || value == "all");
+            options.runBacklog = (value == "backlog" || value == "all");
+            options.runParser = (value == "parser" || value == "all");
+            options.runState = (value == "state" || value == "all");
+            options.runCrc = (value == "crc" || value == "all");
+            options.runOutput = (value == "output" || value == "all");
+            options.runTouch = (value == "touch" || value == "all");
+            options.runFusion = (value == "fusion" || value == "all");
+            options.runHotplug = (value == "hotplug" || value == "all");
+            options.runPads = (value == "pads" || value == "all");
+            options.runBridge = (value == "bridge" || value == "all");
+            options.runParams = (value == "params" || value == "all");
+            options.runEngines = (value == "engines" || value == "all");
+            options.runGc = (value == "gc" || value == "all");
+            if (!options.runPipeline && !options.runSnapshot && !options.runPacing && !options.runBacklog &&
+                !options.runParser && !options.runState && !options.runCrc && !options.runOutput &&
+                !options.runTouch && !options.runFusion &&
+                !options.runHotplug && !options.runPads && !options.runBridge && !options.runParams &&
+                !options.runEngines && !options.runGc) {
+                return false;
+            }
+        } else if (arg == "--priority" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "normal") options.tuning.priority = ThreadPriority::Normal;
+            else if (value == "high") options.tuning.priority = ThreadPriority::High;
+            else if (value == "games") options.tuning.priority = ThreadPriority::Games;
+            else if (value == "proaudio") options.tuning.priority = ThreadPriority::ProAudio;
+            else return false;
+        } else if (arg == "--affinity" && hasValue) {
+            options.tuning.affinityMask = std::strtoull(argv[++i], nullptr, 16);
+        } else if (arg == "--timer-us" && hasValue) {
+            options.tuning.timerResolutionUs = std::atoi(argv[++i]);
+        } else if (arg == "--backlog" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "latest") options.backlogPolicy = BacklogPolicy::LatestOnly;
+            else if (value == "replay") options.backlogPolicy = BacklogPolicy::ReplayAll;
+            else return false;
+        } else if (arg == "--spin-us" && hasValue) {
+            options.spinUs = std::atoi(argv[++i]);
+        } else if (arg == "--csv" && hasValue) {
+            options.csvFile = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonFile = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return options.rateHz >= 0.0f && options.seconds > 0.0 && options.spinUs >= 0;
+}
+
+void printSummaryRow(const std::string& name, const LatencyHistogram::Summary& s) {
+    std::printf("  %-28s %10llu %9.2f %9.2f %9.2f %9.2f %9.2f\n",
+                name.c_str(), static_cast<unsigned long long>(s.count),
+                s.meanNs / 1000.0, s.p50Ns / 1000.0, s.p99Ns / 1000.0, s.p999Ns / 1000.0, s.maxNs / 1000.0);
+}
+
+void printSummaryHeader() {
+    std::printf("  %-28s %10s %9s %9s %9s %9s %9s\n", "stage", "count", "mean_us", "p50_us", "p99_us", "p99.9_us", "max_us");
+}
+
+// Enable the shipped chain (files starting with '_' are templates)
+size_t enableShippedScripts(InputProcessor& processor) {
+    ScriptManager& scripts = processor.getScriptManager();
+    size_t enabled = 0;
+    for (auto& script : scripts.getScripts()) {
+        std::string file = std::filesystem::path(script.config.filename).filename().string();
+        if (script.loaded && !file.empty() && file[0] != '_') {
+            scripts.setScriptEnabled(script.config.name, true);
+            enabled++;
+        }
+    }
+    return enabled;
+}
+
+// ============================================================================
+// Pipeline: SimulatedDualSense -> InputProcessor (scripts) -> NullSink
+// ============================================================================
+bool runPipeline(const BenchOptions& options, SimulatedDualSense::Transport transport,
+                 std::vector<LatencyReportEntry>& report) {
+    bool bluetooth = transport == SimulatedDualSense::Transport::Bluetooth;
+    const char* label = bluetooth ? "bt" : "usb";
+
+    auto device = std::make_unique<SimulatedDualSense>(transport);
+    device->setReportRate(options.rateHz);
+    if (!options.replayFile.empty() && !device->loadReportFile(options.replayFile)) {
+        std::fprintf(stderr, "Failed to load replay file: %s\n", options.replayFile.c_str());
+        return false;
+    }
+    auto sink = std::make_unique<NullSink>();
+    NullSink* sinkPtr = sink.get();
+
+    InputProcessor processor(std::move(device), std::move(sink));
+    if (!processor.initialize(nullptr, options.scriptsFolder)) {
+        std::fprintf(stderr, "Failed to initialize pipeline\n");
+        return false;
+    }
+
+    processor.setBacklogPolicy(options.backlogPolicy);
+    size_t enabled = enableShippedScripts(processor);
+
+    std::printf("\n[pipeline/%s] rate=%s scripts=%zu source=%s\n", label,
+                options.rateHz > 0.0f ? std::to_string(static_cast<int>(options.rateHz)).c_str() : "unpaced",
+                enabled, options.replayFile.empty() ? "generator" : options.replayFile.c_str());
+
+    // Warm up the Lua states and caches before measuring
+    for (int i = 0; i < 1000; i++) {
+        processor.update();
+    }
+    processor.resetLatencyStats();
+    processor.resetSubmitStats();
+    uint64_t framesBefore = sinkPtr->getFrameCount();
+
+    auto wallStart = std::chrono::steady_clock::now();
+    auto wallEnd = wallStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+    std::clock_t cpuStart = std::clock();
+
+    // Block on the device like the event-driven processing loop does
+    int timeoutMs = options.rateHz > 0.0f ? 10 : 0;
+    while (std::chrono::steady_clock::now() < wallEnd) {
+        processor.update(timeoutMs);
+    }
+
+    std::clock_t cpuEnd = std::clock();
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    double cpuSeconds = static_cast<double>(cpuEnd - cpuStart) / CLOCKS_PER_SEC;
+    uint64_t frames = sinkPtr->getFrameCount() - framesBefore;
+
+    std::printf("  frames=%llu throughput=%.0f frames/s cpu=%.2f us/frame (%.1f%% of one core)\n",
+                static_cast<unsigned long long>(frames),
+                frames / wallSeconds,
+                frames > 0 ? cpuSeconds * 1e6 / static_cast<double>(frames) : 0.0,
+                cpuSeconds / wallSeconds * 100.0);
+
+    OutputSubmitStats submits = processor.getSubmitStats();
+    std::printf("  submitted=%llu suppressed=%llu (%.1f%% of frames unchanged)\n",
+                static_cast<unsigned long long>(submits.submitted),
+                static_cast<unsigned long long>(submits.suppressed),
+                frames > 0 ? 100.0 * static_cast<double>(submits.suppressed) / static_cast<double>(frames) : 0.0);
+
+    InputReportStats inputReports = processor.getInputReportStats();
+    std::printf("  input reports accepted=%llu crc_dropped=%llu\n",
+                static_cast<unsigned long long>(inputReports.accepted),
+                static_cast<unsigned long long>(inputReports.crcFailures));
+
+    DeltaTimeStats dt = processor.getDeltaTimeStats();
+    std::printf("  dt host mean=%.1f sd=%.2f us, device mean=%.1f sd=%.2f us, fallbacks=%llu\n",
+                dt.hostMeanUs, dt.hostStdDevUs, dt.deviceMeanUs, dt.deviceStdDevUs,
+                static_cast<unsigned long long>(dt.fallbacks));
+
+    printSummaryHeader();
+    for (const auto& entry : processor.getLatencyReport()) {
+        printSummaryRow(entry.name, entry.summary);
+        report.push_back({std::string(label) + "/" + entry.name, entry.summary});
+    }
+
+    return frames > 0;
+}
+
+// ============================================================================
+// Snapshot: publish cost of an 8 kHz writer while readers poll the frame
+// ============================================================================
+bool runSnapshot(const BenchOptions& options, std::vector<LatencyReportEntry>& report) {
+    constexpr int READER_COUNT = 2;
+    constexpr auto WRITER_PERIOD = std::chrono::microseconds(125);  // 8 kHz
+
+    std::printf("\n[snapshot] 8 kHz writer, %d readers, %.1f s\n", READER_COUNT, options.seconds);
+
+    SeqLock<FrameSnapshot> snapshot;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    LatencyHistogram publishTime;
+    uint64_t writes = 0;
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READER_COUNT; r++) {
+        readers.emplace_back([&]() {
+            uint64_t localReads = 0;
+            float checksum = 0.0f;
+            while (!stop.load(std::memory_order_relaxed)) {
+                checksum += snapshot.load().input.leftStickX;
+                localReads++;
+            }
+            volatile float sink = checksum;
+            (void)sink;
+            reads += localReads;
+        });
+    }
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+    auto next = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() < end) {
+        float value = static_cast<float>(++writes);
+        FrameSnapshot frame;
+        frame.input.leftStickX = frame.input.deltaTime = frame.input.gyroZ = value;
+        frame.output.leftStickX = frame.output.rightTrigger = frame.output.deltaTime = value;
+
+        auto start = std::chrono::steady_clock::now();
+        snapshot.store(frame);
+        publishTime.record(std::chrono::steady_clock::now() - start);
+
+        next += WRITER_PERIOD;
+        std::this_thread::sleep_until(next);
+    }
+
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+
+    std::printf("  writes=%llu reads=%llu\n",
+                static_cast<unsigned long long>(writes),
+                static_cast<unsigned long long>(reads.load()));
+    printSummaryHeader();
+    printSummaryRow("publish", publishTime.summarize());
+    report.push_back({"snapshot/publish", publishTime.summarize()});
+    return true;
+}
+
+// ============================================================================
+// Pacing: periodic-mode scheduler alone, at --rate with --spin-us
+// ============================================================================
+bool runPacing(const BenchOptions& options, std::vector<LatencyReportEntry>& report) {
+    float rate = options.rateHz > 0.0f ? options.rateHz : 1000.0f;
+    std::printf("\n[pacing] target=%.0f Hz spin=%d us priority=%s, %.1f s\n", rate, options.spinUs,
+                getThreadPriorityName(options.tuning.priority), options.seconds);
+
+    ThreadTuningScope tuning(options.tuning);
+    std::istringstream status(tuning.getStatus());
+    for (std::string line; std::getline(status, line);) {
+        std::printf("  %s\n", line.c_str());
+    }
+
+    PacingScheduler pacer;
+    pacer.setRate(rate);
+    pacer.setSpinWindow(std::chrono::microseconds(options.spinUs));
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+    std::clock_t cpuStart = std::clock();
+    while (std::chrono::steady_clock::now() < end) {
+        pacer.waitNext();
+    }
+    double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+    PacingStats stats = pacer.getStats();
+    std::printf("  achieved=%.1f Hz ticks=%llu missed=%llu cpu=%.1f%% of one core\n",
+                stats.achievedHz,
+                static_cast<unsigned long long>(stats.ticks),
+                static_cast<unsigned long long>(stats.missedTicks),
+                cpuSeconds / options.seconds * 100.0);
+    printSummaryHeader();
+    printSummaryRow("lateness", stats.lateness);
+    report.push_back({"pacing/lateness", stats.lateness});
+    return true;
+}
+
+// ============================================================================
+// Backlog: event-driven loop with periodic stalls (a GC pause or slow script)
+// so reports queue up, run once per backlog policy
+// ============================================================================
+bool runBacklog(const BenchOptions& options, std::vector<LatencyReportEntry>& report) {
+    constexpr auto STALL_EVERY = std::chrono::milliseconds(250);
+    constexpr auto STALL_LENGTH = std::chrono::milliseconds(20);
+    float rate = options.rateHz > 0.0f ? options.rateHz : 1000.0f;
+
+    for (BacklogPolicy policy : {BacklogPolicy::LatestOnly, BacklogPolicy::ReplayAll}) {
+        const char* label = policy == BacklogPolicy::ReplayAll ? "replay" : "latest";
+
+        auto device = std::make_unique<SimulatedDualSense>(SimulatedDualSense::Transport::USB);
+        device->setReportRate(rate);
+        SimulatedDualSense* devicePtr = device.get();
+        auto sink = std::make_unique<NullSink>();
+        NullSink* sinkPtr = sink.get();
+
+        InputProcessor processor(std::move(device), std::move(sink));
+        if (!processor.initialize(nullptr, options.scriptsFolder)) {
+            std::fprintf(stderr, "Failed to initialize pipeline\n");
+            return false;
+        }
+        processor.setBacklogPolicy(policy);
+        enableShippedScripts(processor);
+
+        std::printf("\n[backlog/%s] rate=%.0f Hz, %lld ms stall every %lld ms, %.1f s\n", label, rate,
+                    static_cast<long long>(STALL_LENGTH.count()), static_cast<long long>(STALL_EVERY.count()),
+                    options.seconds);
+
+        for (int i = 0; i < 100; i++) {
+            processor.update(10);
+        }
+        processor.resetLatencyStats();
+        uint64_t reportsBefore = devicePtr->getReportCount();
+        uint64_t framesBefore = sinkPtr->getFrameCount();
+
+        auto start = std::chrono::steady_clock::now();
+        auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(options.seconds));
+        auto nextStall = start + STALL_EVERY;
+        while (std::chrono::steady_clock::now() < end) {
+            processor.update(10);
+            if (std::chrono::steady_clock::now() >= nextStall) {
+                std::this_thread::sleep_for(STALL_LENGTH);
+                nextStall += STALL_EVERY;
+            }
+        }
+
+        BacklogStats backlog = processor.getBacklogStats();
+        uint64_t reports = devicePtr->getReportCount() - reportsBefore;
+        uint64_t frames = sinkPtr->getFrameCount() - framesBefore;
+        std::printf("  reports=%llu frames=%llu coalesced=%llu wakes=%llu backlogged=%llu depth mean=%.2f max=%u\n",
+                    static_cast<unsigned long long>(reports),
+                    static_cast<unsigned long long>(frames),
+                    static_cast<unsigned long long>(backlog.coalesced),
+                    static_cast<unsigned long long>(backlog.wakes),
+                    static_cast<unsigned long long>(backlog.backloggedWakes),
+                    backlog.meanDepth, backlog.maxDepth);
+
+        printSummaryHeader();
+        LatencyHistogram::Summary frame = processor.getStageHistogram(PipelineStage::Frame).summarize();
+        printSummaryRow("Frame", frame);
+        report.push_back({std::string("backlog/") + label + "/Frame", frame});
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Parser: the current parser against the original hand-written one, in
+// ns per report
+// ============================================================================
+int16_t firstTouchX(const legacy::ControllerState& state) { return state.touchX; }
+int16_t firstTouchX(const ControllerState& state) { return state.touch[0].x; }
+
+template <typename State>
+using ParseFunction = bool (*)(const uint8_t* data, size_t length, State& state);
+
+template <typename State>
+double timeParser(const std::vector<std::vector<uint8_t>>& reports, int passes, ParseFunction<State> parse) {
+    // Called through a volatile pointer so neither parser is inlined into the
+    // loop and specialized for the few fields the checksum reads
+    volatile ParseFunction<State> call = parse;
+    State state;
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (const auto& report : reports) {
+            call(report.data(), report.size(), state);
+            checksum += state.gyroX + state.dpad + firstTouchX(state);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Keep the work observable so it cannot be optimized away
+    volatile uint64_t sink = checksum;
+    (void)sink;
+    return seconds * 1e9 / (static_cast<double>(reports.size()) * passes);
+}
+
+bool runParser(const BenchOptions& options) {
+    constexpr size_t REPORT_COUNT = 4096;
+    constexpr int PASSES = 50;
+
+    std::printf("\n[parser] %zu generator reports per transport\n", REPORT_COUNT);
+    std::printf("  %-12s %12s %12s %9s\n", "transport", "legacy_ns", "current_ns", "speedup");
+
+    for (bool bluetooth : {false, true}) {
+        std::vector<std::vector<uint8_t>> reports = generateReports(bluetooth, REPORT_COUNT);
+
+        // Alternate the two and keep the best of several runs to damp noise
+        double legacyNs = 1e9;
+        double currentNs = 1e9;
+        for (int run = 0; run < 5; run++) {
+            legacyNs = std::min(legacyNs, timeParser<legacy::ControllerState>(reports, PASSES, legacy::parseDualSenseReport));
+            currentNs = std::min(currentNs, timeParser<ControllerState>(reports, PASSES, parseDualSenseReport));
+        }
+
+        std::printf("  %-12s %12.2f %12.2f %8.2fx\n", bluetooth ? "bluetooth" : "usb",
+                    legacyNs, currentNs, currentNs > 0.0 ? legacyNs / currentNs : 0.0);
+    }
+
+    (void)options;
+    return true;
+}
+
+// ============================================================================
+// State: packed button masks against the original one-bool-per-button
+// structs. Reports struct sizes, the cost of copying a state (as the
+// snapshot and backlog do) and of normalize + Xbox conversion.
+// ============================================================================
+template <typename State>
+using ConvertFunction = XusbReport (*)(const State& state);
+
+XusbReport convertLegacy(const legacy::ControllerState& state) {
+    return legacy::toXusbReport(legacy::normalizeControllerState(state));
+}
+
+XusbReport convertPacked(const ControllerState& state) {
+    return toXusbReport(normalizeControllerState(state));
+}
+
+template <typename State>
+double timeConvert(const std::vector<State>& states, int passes, ConvertFunction<State> convert) {
+    volatile ConvertFunction<State> call = convert;
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (const State& state : states) {
+            XusbReport report = call(state);
+            checksum += report.wButtons + report.sThumbLX;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    volatile uint64_t sink = checksum;
+    (void)sink;
+    return seconds * 1e9 / (static_cast<double>(states.size()) * passes);
+}
+
+template <typename State>
+double timeCopy(const std::vector<State>& states, int passes) {
+    // A ring of copies through a volatile index, so each copy is a real
+    // load/store of the whole struct rather than being elided
+    std::vector<State> ring(64);
+    volatile size_t mask = ring.size() - 1;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i < states.size(); i++) {
+            ring[i & mask] = states[i];
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    volatile uint8_t sink = ring[0].dpad;
+    (void)sink;
+    return seconds * 1e9 / (static_cast<double>(states.size()) * passes);
+}
+
+bool runState(const BenchOptions& options) {
+    constexpr size_t REPORT_COUNT = 4096;
+    constexpr int PASSES = 50;
+
+    std::printf("\n[state] struct size in bytes\n");
+    std::printf("  %-16s %8s %8s\n", "struct", "legacy", "packed");
+    std::printf("  %-16s %8zu %8zu\n", "ControllerState", sizeof(legacy::ControllerState), sizeof(ControllerState));
+    std::printf("  %-16s %8zu %8zu\n", "NormalizedState", sizeof(legacy::NormalizedState), sizeof(NormalizedState));
+
+    // Same reports decoded into both layouts
+    std::vector<std::vector<uint8_t>> reports = generateReports(false, REPORT_COUNT);
+    std::vector<legacy::ControllerState> legacyStates(reports.size());
+    std::vector<ControllerState> packedStates(reports.size());
+    for (size_t i = 0; i < reports.size(); i++) {
+        legacy::parseDualSenseReport(reports[i].data(), reports[i].size(), legacyStates[i]);
+        parseDualSenseReport(reports[i].data(), reports[i].size(), packedStates[i]);
+    }
+
+    double legacyConvertNs = 1e9;
+    double packedConvertNs = 1e9;
+    double legacyCopyNs = 1e9;
+    double packedCopyNs = 1e9;
+    for (int run = 0; run < 5; run++) {
+        legacyConvertNs = std::min(legacyConvertNs, timeConvert<legacy::ControllerState>(legacyStates, PASSES, convertLegacy));
+        packedConvertNs = std::min(packedConvertNs, timeConvert<ControllerState>(packedStates, PASSES, convertPacked));
+        legacyCopyNs = std::min(legacyCopyNs, timeCopy(legacyStates, PASSES));
+        packedCopyNs = std::min(packedCopyNs, timeCopy(packedStates, PASSES));
+    }
+
+    std::printf("  %-16s %8s %8s %9s\n", "ns per state", "legacy", "packed", "speedup");
+    std::printf("  %-16s %8.2f %8.2f %8.2fx\n", "copy", legacyCopyNs, packedCopyNs,
+                packedCopyNs > 0.0 ? legacyCopyNs / packedCopyNs : 0.0);
+    std::printf("  %-16s %8.2f %8.2f %8.2fx\n", "normalize+xusb", legacyConvertNs, packedConvertNs,
+                packedConvertNs > 0.0 ? legacyConvertNs / packedConvertNs : 0.0);
+
+    (void)options;
+    return true;
+}
+
+// ============================================================================
+// CRC: slice-by-8 CRC-32 against bit-at-a-time and byte-at-a-time versions
+// ============================================================================
+uint32_t crc32Bytewise(const uint8_t* data, size_t length) {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> t = {};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320u : 0u);
+            }
+            t[i] = crc;
+        }
+        return t;
+    }();
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < length; i++) {
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+using CrcFunction = uint32_t (*)(const uint8_t* data, size_t length);
+
+double timeCrc(const std::vector<std::vector<uint8_t>>& reports, int passes, CrcFunction crc) {
+    volatile CrcFunction call = crc;
+    uint32_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; pass++) {
+        for (const auto& report : reports) {
+            checksum ^= call(report.data(), report.size() - DUALSENSE_BT_CRC_SIZE);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    volatile uint32_t sink = checksum;
+    (void)sink;
+    return seconds * 1e9 / (static_cast<double>(reports.size()) * passes);
+}
+
+bool runCrc(const BenchOptions& options) {
+    constexpr size_t REPORT_COUNT = 4096;
+    constexpr int PASSES = 50;
+
+    std::printf("\n[crc] CRC-32 for Bluetooth reports\n");
+    std::vector<std::vector<uint8_t>> reports = generateReports(true, REPORT_COUNT);
+
+    // Cost per report over the 74 covered bytes; at 1 kHz, ns per report is
+    // also microseconds of CPU per second
+    double bitwiseNs = 1e9;
+    double bytewiseNs = 1e9;
+    double slicedNs = 1e9;
+    for (int run = 0; run < 5; run++) {
+        bitwiseNs = std::min(bitwiseNs, timeCrc(reports, PASSES / 10, crc32Bitwise));
+        bytewiseNs = std::min(bytewiseNs, timeCrc(reports, PASSES, crc32Bytewise));
+        slicedNs = std::min(slicedNs, timeCrc(reports, PASSES, crc32));
+    }
+    std::printf("  %-14s %10s %16s\n", "method", "ns/report", "cpu at 1 kHz");
+    std::printf("  %-14s %10.1f %13.4f %%\n", "bitwise", bitwiseNs, bitwiseNs * 1000.0 / 1e9 * 100.0);
+    std::printf("  %-14s %10.1f %13.4f %%\n", "byte table", bytewiseNs, bytewiseNs * 1000.0 / 1e9 * 100.0);
+    std::printf("  %-14s %10.1f %13.4f %%\n", "slice-by-8", slicedNs, slicedNs * 1000.0 / 1e9 * 100.0);
+
+    (void)options;
+    return true;
+}
+
+// ============================================================================
+// Output: LED changes at the input rate against a rate-limited output channel
+// with a slow (Bluetooth-like) write: how long setLEDColor takes (it must
+// never wait for a write) and how many reports go out
+// ============================================================================
+bool runOutput(const BenchOptions& options, std::vector<LatencyReportEntry>& report) {
+    constexpr float MAX_OUTPUT_RATE = OutputReportScheduler::DEFAULT_MAX_RATE_HZ;
+    constexpr auto WRITE_LATENCY = std::chrono::microseconds(2000);
+    float rate = options.rateHz > 0.0f ? options.rateHz : 1000.0f;
+
+    SimulatedDualSense device(SimulatedDualSense::Transport::Bluetooth);
+    device.setMaxOutputRate(MAX_OUTPUT_RATE);
+    device.setOutputWriteLatency(WRITE_LATENCY);
+    device.connect();
+
+    PacingScheduler pacer;
+    pacer.setRate(rate);
+    LatencyHistogram callTime;
+    uint64_t changes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+    while (std::chrono::steady_clock::now() < end) {
+        pacer.waitNext();
+        // Every call is a real change (never the default blue)
+        uint8_t r = static_cast<uint8_t>(changes + 1);
+        uint8_t g = static_cast<uint8_t>((changes + 1) >> 8);
+        uint8_t b = static_cast<uint8_t>(255 - r);
+        auto callStart = std::chrono::steady_clock::now();
+        device.setLEDColor(r, g, b);
+        callTime.record(std::chrono::steady_clock::now() - callStart);
+        changes++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Let the last pending report go out
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    OutputReportStats stats = device.getOutputReportStats();
+    device.disconnect();
+
+    std::printf("\n[output] %llu LED changes at %.0f Hz, writes limited to %.0f Hz, %lld us per write\n",
+                static_cast<unsigned long long>(changes), rate, MAX_OUTPUT_RATE,
+                static_cast<long long>(WRITE_LATENCY.count()));
+    std::printf("  sent=%llu (%.0f reports/s) coalesced=%llu failed=%llu\n",
+                static_cast<unsigned long long>(stats.sent), stats.sent / seconds,
+                static_cast<unsigned long long>(stats.coalesced),
+                static_cast<unsigned long long>(stats.failed));
+    printSummaryHeader();
+    printSummaryRow("setLEDColor call", callTime.summarize());
+    report.push_back({"output/setLEDColor", callTime.summarize()});
+    return true;
+}
+
+// ============================================================================
+// Touch: the gesture recognizer over the generator's 4 s touch routine (tap,
+// swipe right, pinch out, two-finger tap), in ns per frame
+// ============================================================================
+bool runTouch(const BenchOptions& options) {
+    constexpr size_t REPORT_COUNT = 3 * 4000;   // Generator steps 1 ms per report
+    constexpr float FRAME_DT = 0.001f;
+
+    std::vector<ControllerState> states;
+    size_t twoContactFrames = 0;
+    for (const auto& report : generateReports(false, REPORT_COUNT)) {
+        ControllerState state;
+        parseDualSenseReport(report.data(), report.size(), state);
+        twoContactFrames += (state.touch[0].active && state.touch[1].active) ? 1 : 0;
+        states.push_back(state);
+    }
+
+    // Best of five
+    double bestNs = 1e9;
+    for (int run = 0; run < 5; run++) {
+        TouchGestureRecognizer recognizer;
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const ControllerState& state : states) {
+            checksum += recognizer.update(state.touch, FRAME_DT);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        volatile uint64_t sink = checksum;
+        (void)sink;
+        bestNs = std::min(bestNs, seconds * 1e9 / static_cast<double>(states.size()));
+    }
+
+    std::printf("\n[touch] %zu reports (%zu with two contacts), recognizer %.1f ns/frame\n",
+                states.size(), twoContactFrames, bestNs);
+
+    (void)options;
+    return true;
+}
+
+// ============================================================================
+// Fusion: the native stage against the same filter written in Lua, over a
+// known orientation trajectory (still, 10 s of rotation on all axes, still)
+// ============================================================================
+// The same Mahony update, as a script author would have to write it
+const char* LUA_FUSION_SCRIPT =
+    "local qw, qx, qy, qz = 1.0, 0.0, 0.0, 0.0\n"
+    "local DEG = math.pi / 180\n"
+    "function process(input)\n"
+    "    local wx, wy, wz = input.gyro_x * DEG, input.gyro_y * DEG, input.gyro_z * DEG\n"
+    "    local ax, ay, az = input.accel_x, input.accel_y, input.accel_z\n"
+    "    local n = math.sqrt(ax * ax + ay * ay + az * az)\n"
+    "    if n > 0.85 and n < 1.15 then\n"
+    "        ax, ay, az = ax / n, ay / n, az / n\n"
+    "        local vx = 2 * (qx * qy + qw * qz)\n"
+    "        local vy = 1 - 2 * (qx * qx + qz * qz)\n"
+    "        local vz = 2 * (qy * qz - qw * qx)\n"
+    "        wx = wx + 2 * (ay * vz - az * vy)\n"
+    "        wy = wy + 2 * (az * vx - ax * vz)\n"
+    "        wz = wz + 2 * (ax * vy - ay * vx)\n"
+    "    end\n"
+    "    local h = 0.5 * input.dt\n"
+    "    local hx, hy, hz = wx * h, wy * h, wz * h\n"
+    "    qw, qx, qy, qz = qw - qx * hx - qy * hy - qz * hz, qx + qw * hx + qy * hz - qz * hy,\n"
+    "                     qy + qw * hy - qx * hz + qz * hx, qz + qw * hz + qx * hy - qy * hx\n"
+    "    local len = math.sqrt(qw * qw + qx * qx + qy * qy + qz * qz)\n"
+    "    qw, qx, qy, qz = qw / len, qx / len, qy / len, qz / len\n"
+    "    return input\n"
+    "end\n";
+
+double timeScript(const char* source, const std::vector<FusionSample>& samples) {
+    ScriptEngine engine;
+    if (!engine.initialize() || !engine.loadScriptString(source, "bench")) {
+        return -1.0;
+    }
+    double best = 1e9;
+    for (int run = 0; run < 5; run++) {
+        auto start = std::chrono::steady_clock::now();
+        for (const FusionSample& sample : samples) {
+            engine.process(sample.state, sample.state.deltaTime);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, seconds * 1e9 / static_cast<double>(samples.size()));
+    }
+    return best;
+}
+
+bool runFusion(const BenchOptions& options) {
+    constexpr double SECONDS = 20.0;
+    const double bias[3] = {1.5, -2.0, 1.0};
+
+    std::vector<FusionSample> samples = generateFusionTrajectory(SECONDS, bias);
+
+    // Native cost per frame, best of five
+    double nativeNs = 1e9;
+    for (int run = 0; run < 5; run++) {
+        std::vector<FusionSample> copy = samples;
+        MotionFusion fusion;
+        auto start = std::chrono::steady_clock::now();
+        for (FusionSample& sample : copy) {
+            fusion.update(sample.state, sample.context, sample.state.deltaTime);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        nativeNs = std::min(nativeNs, seconds * 1e9 / static_cast<double>(copy.size()));
+    }
+    double passthroughNs = timeScript("function process(input) return input end", samples);
+    double luaNs = timeScript(LUA_FUSION_SCRIPT, samples);
+
+    std::printf("\n[fusion] %.0f s at 1 kHz\n", SECONDS);
+    if (luaNs < 0.0 || passthroughNs < 0.0) {
+        std::fprintf(stderr, "  FAILED: could not load the comparison scripts\n");
+        return false;
+    }
+    std::printf("  native stage %.1f ns/frame; Lua filter %.1f ns/frame over a passthrough script\n", nativeNs,
+                luaNs - passthroughNs);
+
+    (void)options;
+    return true;
+}
+
+// ============================================================================
+// Bridge: the per-frame cost of handing the state to Lua and reading it back,
+// userdata bridge versus the table bridge, for a passthrough script and one
+// that reads and writes like the shipped scripts. Lua heap growth with the
+// collector stopped gives the bytes allocated per frame.
+// ============================================================================
+const char* const LUA_BRIDGE_PASSTHROUGH =
+    "function process(input) return input end\n";
+
+const char* const LUA_BRIDGE_TYPICAL =
+    "function process(input)\n"
+    "    local output = input\n"
+    "    output.left_x = deadzone(input.left_x, 0.1)\n"
+    "    output.left_y = deadzone(input.left_y, 0.1)\n"
+    "    output.right_x = deadzone(input.right_x, 0.05)\n"
+    "    output.right_y = deadzone(input.right_y, 0.05)\n"
+    "    if input.cross and input.right_trigger > 0.5 then\n"
+    "        output.circle = not input.circle\n"
+    "    end\n"
+    "    output.gyro_x = input.gyro_x * 0.5 + input.dt\n"
+    "    return output\n"
+    "end\n";
+
+struct BridgeTiming {
+    double ns = -1.0;
+    double bytesPerFrame = -1.0;
+};
+
+BridgeTiming timeBridge(const char* source, StateBridge bridge, const std::vector<NormalizedState>& states) {
+    BridgeTiming timing;
+    ScriptEngine engine;
+    engine.setStateBridge(bridge);
+    if (!engine.initialize() || !engine.loadScriptString(source, "bench")) {
+        return timing;
+    }
+
+    double best = 1e9;
+    for (int run = 0; run < 5; run++) {
+        auto start = std::chrono::steady_clock::now();
+        for (const NormalizedState& state : states) {
+            engine.process(state, 0.001f);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, seconds * 1e9 / static_cast<double>(states.size()));
+    }
+    timing.ns = best;
+
+    // Same frames with the collector stopped: heap growth is what they allocated
+    ScriptEngine counting;
+    counting.setStateBridge(bridge);
+    std::string stopped = std::string("collectgarbage(\"stop\")\n") + source;
+    if (counting.initialize() && counting.loadScriptString(stopped, "bench")) {
+        counting.process(states[0], 0.001f);
+        size_t before = counting.getHeapBytes();
+        for (const NormalizedState& state : states) {
+            counting.process(state, 0.001f);
+        }
+        timing.bytesPerFrame = static_cast<double>(counting.getHeapBytes() - before) /
+                               static_cast<double>(states.size());
+    }
+    return timing;
+}
+
+bool runBridge(const BenchOptions& options) {
+    std::vector<NormalizedState> states = generateStates(4096);
+    bool ok = true;
+
+    std::printf("\n[bridge] %zu states per run, ns and Lua heap bytes allocated per frame\n", states.size());
+    std::printf("  %-12s %-9s %10s %12s\n", "script", "bridge", "ns/frame", "bytes/frame");
+    const struct {
+        const char* name;
+        const char* source;
+    } scripts[] = {{"passthrough", LUA_BRIDGE_PASSTHROUGH}, {"typical", LUA_BRIDGE_TYPICAL}};
+    for (const auto& script : scripts) {
+        BridgeTiming table = timeBridge(script.source, StateBridge::Table, states);
+        BridgeTiming userdata = timeBridge(script.source, StateBridge::Userdata, states);
+        if (userdata.ns < 0.0 || table.ns < 0.0) {
+            std::fprintf(stderr, "  FAILED: could not load the %s script\n", script.name);
+            ok = false;
+            continue;
+        }
+        std::printf("  %-12s %-9s %10.1f %12.1f\n", script.name, "table", table.ns, table.bytesPerFrame);
+        std::printf("  %-12s %-9s %10.1f %12.1f  (%.2fx)\n", script.name, "userdata", userdata.ns,
+                    userdata.bytesPerFrame, userdata.ns > 0.0 ? table.ns / userdata.ns : 0.0);
+    }
+
+    (void)options;
+    return ok;
+}
+
+// ============================================================================
+// Pads: 1 to 8 simulated controllers, each with its own pipeline and copy of
+// the shipped script chain, in periodic mode on a PipelinePool. Shows how the per-pad service
+// latency (worker wake to that pad's output) and total CPU scale, and the
+// slowest pad's report rate.
+// ============================================================================
+bool runPads(const BenchOptions& options, std::vector<LatencyReportEntry>& report) {
+    constexpr size_t PAD_COUNTS[] = {1, 2, 4, 8};
+    float rate = options.rateHz > 0.0f ? options.rateHz : 1000.0f;
+
+    std::printf("\n[pads] %.0f Hz reports per pad, shipped scripts, %.1f s per run, %u hardware threads\n", rate,
+                options.seconds, std::thread::hardware_concurrency());
+    std::printf("  %4s %7s %12s %14s %14s %9s %12s\n", "pads", "workers", "reports/s", "service_p50_us",
+                "service_p99_us", "cpu_%", "cpu_us/frame");
+
+    for (size_t pads : PAD_COUNTS) {
+        PipelinePool pool;
+        pool.setPollRate(rate);
+        pool.setPacingSpinWindow(options.spinUs);
+        pool.setThreadTuning(options.tuning);
+        std::vector<SimulatedDualSense*> devices;
+        std::vector<NullSink*> sinks;
+        for (size_t i = 0; i < pads; i++) {
+            auto device = std::make_unique<SimulatedDualSense>();
+            device->setReportRate(rate);
+            devices.push_back(device.get());
+            auto sink = std::make_unique<NullSink>();
+            sinks.push_back(sink.get());
+
+            auto pipeline = std::make_unique<InputProcessor>(std::move(device), std::move(sink));
+            if (!pipeline->initialize(nullptr, options.scriptsFolder)) {
+                std::fprintf(stderr, "Failed to initialize pipeline\n");
+                return false;
+            }
+            pipeline->setInputMode(InputMode::Periodic);
+            pipeline->setBacklogPolicy(options.backlogPolicy);
+            enableShippedScripts(*pipeline);
+            pool.add(std::move(pipeline));
+        }
+
+        pool.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        pool.resetServiceHistograms();
+        std::vector<uint64_t> reportsBefore;
+        uint64_t framesBefore = 0;
+        for (size_t i = 0; i < pads; i++) {
+            reportsBefore.push_back(devices[i]->getReportCount());
+            framesBefore += sinks[i]->getFrameCount();
+        }
+
+        auto wallStart = std::chrono::steady_clock::now();
+        std::clock_t cpuStart = std::clock();
+        std::this_thread::sleep_for(std::chrono::duration<double>(options.seconds));
+        double cpuSeconds = static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+        // Slowest pad and worst tail across pads
+        double minReportRate = 0.0;
+        uint64_t frames = 0;
+        LatencyHistogram::Summary worst;
+        for (size_t i = 0; i < pads; i++) {
+            double padRate = (devices[i]->getReportCount() - reportsBefore[i]) / wallSeconds;
+            minReportRate = i == 0 ? padRate : std::min(minReportRate, padRate);
+            frames += sinks[i]->getFrameCount();
+
+            LatencyHistogram::Summary service = pool.getServiceHistogram(i).summarize();
+            report.push_back({"pads" + std::to_string(pads) + "/pad" + std::to_string(i + 1) + "/Service", service});
+            if (service.p99Ns > worst.p99Ns) {
+                worst = service;
+            }
+        }
+        frames -= framesBefore;
+        size_t workers = pool.getWorkerCount();
+        pool.stop();
+
+        std::printf("  %4zu %7zu %12.0f %14.2f %14.2f %9.1f %12.2f\n", pads, workers, minReportRate,
+                    worst.p50Ns / 1000.0, worst.p99Ns / 1000.0, cpuSeconds / wallSeconds * 100.0,
+                    frames > 0 ? cpuSeconds * 1e6 / static_cast<double>(frames) : 0.0);
+    }
+    return true;
+}
+
+// ============================================================================
+// Hotplug: the processing loop running with the simulated controller
+// unplugged. Measures process CPU and device enumerations while idle, then
+// how quickly the first frame arrives after re-plugging: once on the backoff
+// alone (after it has grown to MAX_RETRY), once with a poke as an arrival
+// notification or the Reconnect button would give.
+// ============================================================================
+double waitForFrames(const NullSink& sink, uint64_t after, std::chrono::milliseconds limit) {
+    auto start = std::chrono::steady_clock::now();
+    while (sink.getFrameCount() <= after) {
+        if (std::chrono::steady_clock::now() - start > limit) {
+            return -1.0;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool waitForDisconnect(const InputProcessor& processor) {
+    for (int i = 0; i < 1000 && processor.isDualSenseConnected(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return !processor.isDualSenseConnected();
+}
+
+bool runHotplug(const BenchOptions& options) {
+    constexpr double IDLE_SECONDS = 3.0;
+    const auto frameLimit = std::chrono::milliseconds(3000);
+
+    std::filesystem::path folder = std::filesystem::temp_directory_path() / "ps5scripts_bench_hotplug";
+    std::filesystem::create_directories(folder);
+
+    auto device = std::make_unique<SimulatedDualSense>();
+    device->setReportRate(1000.0f);
+    SimulatedDualSense* devicePtr = device.get();
+    auto sink = std::make_unique<NullSink>();
+    NullSink* sinkPtr = sink.get();
+
+    InputProcessor processor(std::move(device), std::move(sink));
+    if (!processor.initialize(nullptr, folder.string()) || !processor.start()) {
+        std::fprintf(stderr, "Failed to initialize pipeline\n");
+        return false;
+    }
+    processor.setInputMode(InputMode::EventDriven);
+    bool running = waitForFrames(*sinkPtr, 0, frameLimit) >= 0.0;
+
+    // Unplugged and idle
+    devicePtr->setPluggedIn(false);
+    bool lost = waitForDisconnect(processor);
+    processor.resetHotplugStats();
+    std::clock_t cpuStart = std::clock();
+    std::this_thread::sleep_for(std::chrono::duration<double>(IDLE_SECONDS));
+    double cpuPercent = 100.0 * static_cast<double>(std::clock() - cpuStart) / CLOCKS_PER_SEC / IDLE_SECONDS;
+    HotplugStats idle = processor.getHotplugStats();
+
+    // Backoff has reached MAX_RETRY by now; re-plug with nothing to cut it short
+    uint64_t frames = sinkPtr->getFrameCount();
+    devicePtr->setPluggedIn(true);
+    double backoffMs = waitForFrames(*sinkPtr, frames, frameLimit);
+
+    // Same again, announced
+    devicePtr->setPluggedIn(false);
+    lost = waitForDisconnect(processor) && lost;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1500));
+    frames = sinkPtr->getFrameCount();
+    devicePtr->setPluggedIn(true);
+    processor.reconnectDualSense();
+    double notifiedMs = waitForFrames(*sinkPtr, frames, frameLimit);
+    HotplugStats total = processor.getHotplugStats();
+
+    processor.stop();
+    std::filesystem::remove_all(folder);
+
+    std::printf("\n[hotplug] unplugged for %.0f s with the processing loop running\n", IDLE_SECONDS);
+    std::printf("  idle: %.2f%% CPU, %llu probes (%.1f/s, backoff %lld-%lld ms)\n", cpuPercent,
+                static_cast<unsigned long long>(idle.probes), idle.probes / IDLE_SECONDS,
+                static_cast<long long>(HotplugMonitor::MIN_RETRY.count()),
+                static_cast<long long>(HotplugMonitor::MAX_RETRY.count()));
+    std::printf("  first frame after re-plug: %.1f ms on backoff, %.1f ms when poked (%llu connects)\n",
+                backoffMs, notifiedMs, static_cast<unsigned long long>(total.connects));
+
+    // Without a disconnect and both reconnects there is nothing to measure
+    if (!running || !lost || backoffMs < 0.0 || notifiedMs < 0.0) {
+        std::fprintf(stderr, "  FAILED: the pipeline did not disconnect and reconnect\n");
+        return false;
+    }
+
+    (void)options;
+    return true;
+}
+
+// ============================================================================
+// Params: reading the anti-recoil script's six parameters every frame through
+// get_param versus the params table, in ns, Lua heap bytes and C++ heap
+// allocations per frame.
+// ============================================================================
+#define LUA_PARAMS_DECLARATIONS \
+    "script_info = { name = \"Params\", parameters = {\n" \
+    "    { key = \"strength_ads\", default = 0.15 }, { key = \"strength_hipfire\", default = 0.10 },\n" \
+    "    { key = \"horizontal_strength\", default = 0.0 }, { key = \"smoothing\", default = 0.5 },\n" \
+    "    { key = \"fire_threshold\", default = 0.3 }, { key = \"ads_threshold\", default = 0.3 } } }\n"
+
+const char* const LUA_PARAMS_GET =
+    LUA_PARAMS_DECLARATIONS
+    "function process(input)\n"
+    "    input.left_x = get_param(\"strength_ads\", 0.15) + get_param(\"strength_hipfire\", 0.10) +\n"
+    "        get_param(\"horizontal_strength\", 0.0) + get_param(\"smoothing\", 0.5) +\n"
+    "        get_param(\"fire_threshold\", 0.3) + get_param(\"ads_threshold\", 0.3)\n"
+    "    return input\n"
+    "end\n";
+
+const char* const LUA_PARAMS_TABLE =
+    LUA_PARAMS_DECLARATIONS
+    "function process(input)\n"
+    "    input.left_x = params.strength_ads + params.strength_hipfire + params.horizontal_strength +\n"
+    "        params.smoothing + params.fire_threshold + params.ads_threshold\n"
+    "    return input\n"
+    "end\n";
+
+#undef LUA_PARAMS_DECLARATIONS
+
+bool runParams(const BenchOptions& options) {
+    std::vector<NormalizedState> states = generateStates(4096);
+    bool ok = true;
+
+    std::printf("\n[params] six parameter reads per frame, %zu states per run\n", states.size());
+    std::printf("  %-10s %10s %12s %12s\n", "read", "ns/frame", "bytes/frame", "news/frame");
+    const struct {
+        const char* name;
+        const char* source;
+    } scripts[] = {{"get_param", LUA_PARAMS_GET}, {"params.x", LUA_PARAMS_TABLE}};
+    for (const auto& script : scripts) {
+        BridgeTiming timing = timeBridge(script.source, StateBridge::Userdata, states);
+
+        // C++ heap allocations over steady-state frames
+        ScriptEngine engine;
+        if (timing.ns < 0.0 || !engine.initialize() || !engine.loadScriptString(script.source, "bench")) {
+            std::fprintf(stderr, "  FAILED: could not load the %s script\n", script.name);
+            ok = false;
+            continue;
+        }
+        engine.process(states[0], 0.001f);
+        uint64_t before = heapAllocationCount();
+        for (const NormalizedState& state : states) {
+            engine.process(state, 0.001f);
+        }
+        double newsPerFrame = static_cast<double>(heapAllocationCount() - before) /
+                              static_cast<double>(states.size());
+
+        std::printf("  %-10s %10.1f %12.1f %12.2f\n", script.name, timing.ns, timing.bytesPerFrame, newsPerFrame);
+    }
+
+    (void)options;
+    return ok;
+}
+
+// ============================================================================
+// Engines: many script engines driven at once from several threads, each
+// created on the main thread and run on a worker, every frame calling back
+// into the host through set_param, set_rumble and set_trigger_effect.
+// Frames per second across all threads.
+// ============================================================================
+const char* const LUA_ENGINES_ID =
+    "script_info = { name = \"Engine id\", parameters = { { key = \"id\", default = 0 } } }\n"
+    "function process(input)\n"
+    "    local work = 0\n"
+    "    for i = 1, 500 do work = work + i * input.left_x end\n"
+    "    set_param(\"seen\", params.id + work)\n"
+    "    set_rumble(params.id / 64, 0)\n"
+    "    set_trigger_effect(\"right\", params.id)\n"
+    "    input.right_x = params.id / 64\n"
+    "    return input\n"
+    "end\n";
+
+bool runEngines(const BenchOptions& options) {
+    constexpr size_t THREADS = 8;
+    constexpr size_t ENGINES_PER_THREAD = 4;
+    constexpr size_t FRAMES = 5000;
+
+    std::vector<std::unique_ptr<ScriptEngine>> engines;
+    for (size_t i = 0; i < THREADS * ENGINES_PER_THREAD; i++) {
+        auto engine = std::make_unique<ScriptEngine>();
+        if (!engine->initialize() || !engine->loadScriptString(LUA_ENGINES_ID, "engine")) {
+            std::fprintf(stderr, "  FAILED: could not load the engine script: %s\n", engine->getLastError().c_str());
+            return false;
+        }
+        engine->setParameter("id", static_cast<float>(i + 1));
+        engines.push_back(std::move(engine));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            NormalizedState input;
+            for (size_t frame = 0; frame < FRAMES; frame++) {
+                // Interleave the engines of this thread, and yield now and
+                // then so threads interleave on few cores too
+                ScriptEngine& engine = *engines[t * ENGINES_PER_THREAD + frame % ENGINES_PER_THREAD];
+                engine.process(input, 0.001f);
+                engine.takeOutputRequest();
+                if (frame % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("\n[engines] %zu engines on %zu threads (%u hardware threads)\n", engines.size(), THREADS,
+                std::thread::hardware_concurrency());
+    std::printf("  frames=%zu  %.0f frames/s\n", THREADS * FRAMES, static_cast<double>(THREADS * FRAMES) / seconds);
+
+    (void)options;
+    return true;
+}
+
+// ============================================================================
+// GC: a script that leaves a small table and a string behind every frame,
+// under each collector mode: process() time per frame including the
+// collector step, heap, and collector time per second at 1 kHz.
+// ============================================================================
+const char* const LUA_GC_GARBAGE =
+    "local history = {}\n"
+    "local frame = 0\n"
+    "function process(input)\n"
+    "    frame = frame + 1\n"
+    "    local snapshot = { x = input.left_x, y = input.left_y, t = input.dt, n = frame }\n"
+    "    history[frame % 64 + 1] = snapshot\n"
+    "    local label = \"frame \" .. frame\n"
+    "    input.left_x = snapshot.x + #label * 0\n"
+    "    return input\n"
+    "end\n";
+
+bool runGc(const BenchOptions& options) {
+    constexpr size_t WARMUP_FRAMES = 20000;
+    constexpr size_t FRAMES = 200000;
+
+    std::printf("\n[gc] garbage every frame, %zu frames per collector mode\n", FRAMES);
+    std::printf("  %-13s %8s %8s %9s %9s %8s %14s %7s\n", "mode", "p50 us", "p99 us", "p99.9 us", "max us",
+                "heap KB", "GC ms/s @1kHz", "steps");
+    const struct {
+        const char* name;
+        ScriptGcMode mode;
+    } modes[] = {{"generational", ScriptGcMode::Generational}, {"incremental", ScriptGcMode::Incremental}};
+    for (const auto& mode : modes) {
+        ScriptEngine engine;
+        engine.setGcMode(mode.mode);
+        if (!engine.initialize() || !engine.loadScriptString(LUA_GC_GARBAGE, "gc")) {
+            std::fprintf(stderr, "  FAILED: could not load the gc script: %s\n", engine.getLastError().c_str());
+            return false;
+        }
+
+        NormalizedState state;
+        for (size_t i = 0; i < WARMUP_FRAMES; i++) {
+            engine.process(state, 0.001f);
+        }
+        engine.resetMemoryStats();
+
+        LatencyHistogram frameTime;
+        for (size_t i = 0; i < FRAMES; i++) {
+            state.leftStickX = static_cast<float>(i % 100) / 100.0f;
+            auto start = std::chrono::steady_clock::now();
+            engine.process(state, 0.001f);
+            frameTime.record(std::chrono::steady_clock::now() - start);
+        }
+
+        ScriptMemoryStats memory = engine.getMemoryStats();
+        LatencyHistogram::Summary summary = frameTime.summarize();
+        std::printf("  %-13s %8.2f %8.2f %9.2f %9.1f %8.1f %14.3f %7llu\n", mode.name, summary.p50Ns / 1000.0,
+                    summary.p99Ns / 1000.0, summary.p999Ns / 1000.0, summary.maxNs / 1000.0,
+                    memory.heapBytes / 1024.0, memory.gcTimeNs / 1e6 / (FRAMES / 1000.0),
+                    static_cast<unsigned long long>(memory.gcSteps));
+    }
+
+    (void)options;
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<LatencyReportEntry> report;
+    bool ok = true;
+
+    if (options.runPipeline) {
+        if (options.usb) {
+            ok = runPipeline(options, SimulatedDualSense::Transport::USB, report) && ok;
+        }
+        if (options.bluetooth) {
+            ok = runPipeline(options, SimulatedDualSense::Transport::Bluetooth, report) && ok;
+        }
+    }
+
+    if (options.runSnapshot) {
+        ok = runSnapshot(options, report) && ok;
+    }
+
+    if (options.runPacing) {
+        ok = runPacing(options, report) && ok;
+    }
+
+    if (options.runBacklog) {
+        ok = runBacklog(options, report) && ok;
+    }
+
+    if (options.runParser) {
+        ok = runParser(options) && ok;
+    }
+
+    if (options.runState) {
+        ok = runState(options) && ok;
+    }
+
+    if (options.runCrc) {
+        ok = runCrc(options) && ok;
+    }
+
+    if (options.runOutput) {
+        ok = runOutput(options, report) && ok;
+    }
+
+    if (options.runTouch) {
+        ok = runTouch(options) && ok;
+    }
+
+    if (options.runFusion) {
+        ok = runFusion(options) && ok;
+    }
+
+    if (options.runHotplug) {
+        ok = runHotplug(options) && ok;
+    }
+
+    if (options.runPads) {
+        ok = runPads(options, report) && ok;
+    }
+
+    if (options.runBridge) {
+        ok = runBridge(options) && ok;
+    }
+
+    if (options.runParams) {
+        ok = runParams(options) && ok;
+    }
+
+    if (options.runEngines) {
+        ok = runEngines(options) && ok;
+    }
+
+    if (options.runGc) {
+        ok = runGc(options) && ok;
+    }
+
+    if (!options.csvFile.empty()) {
+        std::ofstream csv(options.csvFile);
+        writeLatencyCsv(csv, report);
+    }
+    if (!options.jsonFile.empty()) {
+        std::ofstream json(options.jsonFile);
+        writeLatencyJson(json, report);
+    }
+
+    return ok ? 0 : 1;
+}
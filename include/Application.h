@@ -2,6 +2,7 @@
 
 #include "Common.h"
 #include "InputProcessor.h"
+#include "PipelinePool.h"
 #include "ConfigManager.h"
 #include "HotkeyManager.h"
 #include "Overlay.h"
@@ -48,7 +49,8 @@ private:
 
     // Components
     ConfigManager m_config;
-    InputProcessor m_processor;
+    InputProcessor m_processor;     // First pad, shown in the GUI and overlay
+    PipelinePool m_extraPads;       // Further pads (controllerCount > 1)
     HotkeyManager m_hotkeys;
     Overlay m_overlay;
     GUI m_gui;
@@ -61,5 +63,6 @@ public:
     ConfigManager& getConfig() { return m_config; }
     HotkeyManager& getHotkeys() { return m_hotkeys; }
     InputProcessor& getProcessor() { return m_processor; }
+    PipelinePool& getExtraPads() { return m_extraPads; }
     Overlay& getOverlay() { return m_overlay; }
 };
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Common.h"
+#include "IOutputSink.h"
+#include "XusbReport.h"
+
+// Output sink that converts each frame to an Xbox report and discards it.
+// Stands in for the virtual controller in headless runs, including its change
+// suppression, so submit counts match what the driver would receive.
+class NullSink : public IOutputSink {
+public:
+    bool connect() override { m_connected = true; m_submitFilter.invalidate(); return true; }
+    void disconnect() override { m_connected = false; }
+    bool isConnected() const override { return m_connected; }
+
+    bool update(const NormalizedState& state) override;
+
+    const std::string& getLastError() const override { return m_lastError; }
+
+    void setKeepaliveInterval(std::chrono::milliseconds interval) override { m_submitFilter.setKeepalive(interval); }
+    OutputSubmitStats getSubmitStats() const override { return m_submitFilter.getStats(); }
+    void resetSubmitStats() override { m_submitFilter.resetStats(); }
+
+    // Every frame passed to update(), submitted or not (readable from any thread)
+    uint64_t getFrameCount() const { return m_frameCount.load(std::memory_order_relaxed); }
+    const XusbReport& getLastReport() const { return m_lastReport; }
+
+protected:
+    bool m_connected = false;
+    std::string m_lastError;
+    std::atomic<uint64_t> m_frameCount{0};
+    XusbReport m_lastReport;
+    XusbSubmitFilter m_submitFilter;
+};
+
+// Output sink that records every converted report (for replay comparison)
+class CaptureSink : public NullSink {
+public:
+    // maxReports = 0 keeps everything
+    explicit CaptureSink(size_t maxReports = 0) : m_maxReports(maxReports) {}
+
+    bool update(const NormalizedState& state) override;
+
+    const std::vector<XusbReport>& getReports() const { return m_reports; }
+    void clear() { m_reports.clear(); }
+
+private:
+    size_t m_maxReports;
+    std::vector<XusbReport> m_reports;
+};
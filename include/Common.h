@@ -17,8 +17,75 @@ constexpr uint16_t DUALSENSE_VENDOR_ID = 0x054C;
 constexpr uint16_t DUALSENSE_PRODUCT_ID = 0x0CE6;
 constexpr uint16_t DUALSENSE_EDGE_PRODUCT_ID = 0x0DF2;
 
+// Pads driven at once, each with its own virtual controller and script chain
+constexpr int MAX_CONTROLLERS = 8;
+
+// Button bits, in the order the DualSense packs them after the D-Pad nibble,
+// so a report's button bytes decode with one mask and shift
+constexpr uint32_t BUTTON_SQUARE = 1u << 0;
+constexpr uint32_t BUTTON_CROSS = 1u << 1;
+constexpr uint32_t BUTTON_CIRCLE = 1u << 2;
+constexpr uint32_t BUTTON_TRIANGLE = 1u << 3;
+constexpr uint32_t BUTTON_L1 = 1u << 4;
+constexpr uint32_t BUTTON_R1 = 1u << 5;
+constexpr uint32_t BUTTON_L2 = 1u << 6;
+constexpr uint32_t BUTTON_R2 = 1u << 7;
+constexpr uint32_t BUTTON_SHARE = 1u << 8;
+constexpr uint32_t BUTTON_OPTIONS = 1u << 9;
+constexpr uint32_t BUTTON_L3 = 1u << 10;
+constexpr uint32_t BUTTON_R3 = 1u << 11;
+constexpr uint32_t BUTTON_PS = 1u << 12;
+constexpr uint32_t BUTTON_TOUCHPAD = 1u << 13;
+constexpr uint32_t BUTTON_MUTE = 1u << 14;
+constexpr int BUTTON_COUNT = 15;
+
+// Touchpad coordinate range and number of contacts it reports
+constexpr int TOUCHPAD_WIDTH = 1920;
+constexpr int TOUCHPAD_HEIGHT = 1080;
+constexpr int TOUCH_POINT_COUNT = 2;
+
+// One touchpad contact. The tracking ID (7 bits) changes with every new
+// touch and stays the same while that finger remains on the pad.
+struct TouchPoint {
+    int16_t x = 0;          // 0 to TOUCHPAD_WIDTH - 1
+    int16_t y = 0;          // 0 to TOUCHPAD_HEIGHT - 1
+    uint8_t id = 0;
+    bool active = false;
+};
+
+// Touchpad gestures completed in a frame (InputContext::gestures)
+constexpr uint8_t GESTURE_TAP = 1u << 0;
+constexpr uint8_t GESTURE_TWO_FINGER_TAP = 1u << 1;
+constexpr uint8_t GESTURE_SWIPE_LEFT = 1u << 2;
+constexpr uint8_t GESTURE_SWIPE_RIGHT = 1u << 3;
+constexpr uint8_t GESTURE_SWIPE_UP = 1u << 4;
+constexpr uint8_t GESTURE_SWIPE_DOWN = 1u << 5;
+constexpr uint8_t GESTURE_PINCH_IN = 1u << 6;
+constexpr uint8_t GESTURE_PINCH_OUT = 1u << 7;
+
 // Controller state structure
+// (ordered largest field first so it packs into 48 bytes)
 struct ControllerState {
+    // Timestamp
+    uint64_t timestamp = 0;
+
+    // Buttons (BUTTON_* bits)
+    uint32_t buttons = 0;
+
+    // Device sensor clock (DUALSENSE_SENSOR_TICK_US units, wraps at 2^32)
+    uint32_t sensorTimestamp = 0;
+
+    // Gyro/Accelerometer (raw values)
+    int16_t gyroX = 0;
+    int16_t gyroY = 0;
+    int16_t gyroZ = 0;
+    int16_t accelX = 0;
+    int16_t accelY = 0;
+    int16_t accelZ = 0;
+
+    // Touchpad contacts
+    TouchPoint touch[TOUCH_POINT_COUNT];
+
     // Sticks (0-255, 128 = center)
     uint8_t leftStickX = 128;
     uint8_t leftStickY = 128;
@@ -32,41 +99,12 @@ struct ControllerState {
     // D-Pad (0-7 for directions, 8 = released)
     uint8_t dpad = 8;
 
-    // Buttons
-    bool square = false;
-    bool cross = false;
-    bool circle = false;
-    bool triangle = false;
-    bool l1 = false;
-    bool r1 = false;
-    bool l2Button = false;  // L2 as button (fully pressed)
-    bool r2Button = false;  // R2 as button
-    bool share = false;     // Create button on PS5
-    bool options = false;
-    bool l3 = false;        // Left stick press
-    bool r3 = false;        // Right stick press
-    bool ps = false;        // PS button
-    bool touchpad = false;  // Touchpad press
-    bool mute = false;      // Mute button
-
-    // Touchpad coordinates (if needed)
-    int16_t touchX = 0;
-    int16_t touchY = 0;
-    bool touchActive = false;
-
-    // Gyro/Accelerometer (raw values)
-    int16_t gyroX = 0;
-    int16_t gyroY = 0;
-    int16_t gyroZ = 0;
-    int16_t accelX = 0;
-    int16_t accelY = 0;
-    int16_t accelZ = 0;
-
-    // Timestamp
-    uint64_t timestamp = 0;
+    bool button(uint32_t bit) const { return (buttons & bit) != 0; }
+    void setButton(uint32_t bit, bool pressed) { buttons = pressed ? (buttons | bit) : (buttons & ~bit); }
 };
 
 // Normalized controller state for scripts (-1.0 to 1.0 for sticks, 0.0 to 1.0 for triggers)
+// (the fields scripts can change; it is copied through every script in the chain)
 struct NormalizedState {
     float leftStickX = 0.0f;
     float leftStickY = 0.0f;
@@ -75,33 +113,58 @@ struct NormalizedState {
     float leftTrigger = 0.0f;
     float rightTrigger = 0.0f;
 
-    // Buttons same as ControllerState
-    bool square = false;
-    bool cross = false;
-    bool circle = false;
-    bool triangle = false;
-    bool l1 = false;
-    bool r1 = false;
-    bool l2Button = false;
-    bool r2Button = false;
-    bool share = false;
-    bool options = false;
-    bool l3 = false;
-    bool r3 = false;
-    bool ps = false;
-    bool touchpad = false;
-    bool mute = false;
-    uint8_t dpad = 8;
-
-    // Gyro normalized
+    // Gyro in deg/s, accelerometer in g (factory-calibrated when available)
     float gyroX = 0.0f;
     float gyroY = 0.0f;
     float gyroZ = 0.0f;
+    float accelX = 0.0f;
+    float accelY = 0.0f;
+    float accelZ = 0.0f;
 
     // Delta time since last update (seconds)
     float deltaTime = 0.0f;
+
+    // Buttons same as ControllerState (BUTTON_* bits)
+    uint32_t buttons = 0;
+
+    uint8_t dpad = 8;
+
+    bool button(uint32_t bit) const { return (buttons & bit) != 0; }
+    void setButton(uint32_t bit, bool pressed) { buttons = pressed ? (buttons | bit) : (buttons & ~bit); }
+};
+
+// What the pipeline works out for a frame besides the state: touch, gestures
+// and sensor fusion. Scripts read it but cannot change it, so it is handed to
+// every script alongside the state rather than copied through the chain.
+struct InputContext {
+    // Sensor fusion output: orientation (controller to world, +Y up), the
+    // direction of gravity in controller coordinates (unit length), and the
+    // bias-corrected rotation rates about world up and the level pitch axis
+    // in deg/s
+    float quatW = 1.0f;
+    float quatX = 0.0f;
+    float quatY = 0.0f;
+    float quatZ = 0.0f;
+    float gravityX = 0.0f;
+    float gravityY = -1.0f;
+    float gravityZ = 0.0f;
+    float yawRate = 0.0f;
+    float pitchRate = 0.0f;
+
+    // Touchpad contacts in touchpad coordinates, as reported
+    TouchPoint touch[TOUCH_POINT_COUNT];
+
+    // Touchpad gestures completed this frame (GESTURE_* bits)
+    uint8_t gestures = 0;
+
+    // Held still long enough for the gyro bias to be re-estimated
+    bool motionStill = false;
 };
 
+// Both states are copied several times per frame; keep each within one cache line
+static_assert(sizeof(ControllerState) <= 64, "ControllerState should fit in one cache line");
+static_assert(sizeof(NormalizedState) <= 64, "NormalizedState should fit in one cache line");
+
 // Script parameter types
 enum class ParamType {
     Float,      // Slider
@@ -159,9 +222,57 @@ enum class OverlayPosition {
     BottomRight = 3
 };
 
+// How the processing thread waits for new controller input
+enum class InputMode {
+    Periodic = 0,       // Non-blocking read, then sleep until the next poll tick
+    EventDriven = 1     // Block on the HID read and wake as soon as a report arrives
+};
+
+// What to do with reports that queued up while the processing thread was busy
+enum class BacklogPolicy {
+    LatestOnly = 0,     // Skip to the newest report (lowest latency)
+    ReplayAll = 1       // Run every queued report through the scripts with its own dt
+};
+
+// Scheduling class for the processing thread (see ThreadTuning.h)
+enum class ThreadPriority {
+    Normal = 0,
+    High = 1,
+    Games = 2,
+    ProAudio = 3
+};
+
+// Clock used for the script delta time
+enum class DeltaTimeSource {
+    Host = 0,           // Time between reads on the host (includes scheduling jitter)
+    Device = 1          // Controller's sensor timestamp, host time as fallback
+};
+
+// Lua garbage collector mode for scripts
+enum class ScriptGcMode {
+    Generational = 0,   // Frequent minor collections of young objects
+    Incremental = 1     // Whole-heap cycles in small steps
+};
+
+// Processing thread scheduling settings
+struct ThreadTuning {
+    ThreadPriority priority = ThreadPriority::Normal;
+    uint64_t affinityMask = 0;      // Bit n = CPU n, 0 = any CPU
+    int timerResolutionUs = 0;      // 0 = leave the OS default
+};
+
 // Application settings
 struct AppSettings {
-    float pollRate = 1000.0f;  // Hz
+    float pollRate = 1000.0f;  // Hz (used by periodic input mode)
+    InputMode inputMode = InputMode::EventDriven;
+    int pacingSpinUs = 200;    // Periodic mode: spin this long before each deadline instead of sleeping
+    int outputKeepaliveMs = 100;  // Resend an unchanged virtual controller report this often (0 = never)
+    BacklogPolicy backlogPolicy = BacklogPolicy::LatestOnly;
+    DeltaTimeSource deltaTimeSource = DeltaTimeSource::Device;
+    ThreadTuning threadTuning;
+    int controllerCount = 1;   // Pads to drive (1 - MAX_CONTROLLERS), applied at startup
+    int scriptMemoryLimitMB = 16;  // Lua heap cap per script, 0 = unlimited
+    ScriptGcMode scriptGcMode = ScriptGcMode::Generational;  // Applied when scripts load
     bool showDemo = false;
     bool minimizeToTray = true;
     std::vector<ScriptConfig> scripts;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Common.h"
+
+// CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320), as used by the
+// DualSense over Bluetooth.
+//
+// Slice-by-8: eight 256-entry tables let the main loop fold eight input bytes
+// per iteration with independent lookups instead of one byte at a time. The
+// tables are built at compile time (8 KB).
+
+// Continue a CRC over more data. Start with crc = 0; the pre- and
+// post-inversion are handled internally, so calls can be chained.
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length);
+
+inline uint32_t crc32(const uint8_t* data, size_t length) {
+    return crc32Update(0, data, length);
+}
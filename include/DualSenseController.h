@@ -1,37 +1,65 @@
 #pragma once
 
 #include "Common.h"
+#include "IInputDevice.h"
+#include "DualSenseReport.h"
+#include "OutputReportScheduler.h"
 #include <hidapi.h>
 
-class DualSenseController {
+// Physical DualSense / DualSense Edge over hidapi
+class DualSenseController : public IInputDevice {
 public:
     DualSenseController();
-    ~DualSenseController();
+    ~DualSenseController() override;
 
     // Connection
-    bool connect();
-    void disconnect();
-    bool isConnected() const { return m_connected; }
+    bool connect() override;
+    bool openPending() override;
+    bool adoptPending() override;
+    void disconnect() override;
+    bool isConnected() const override { return m_connected; }
 
     // Reading
-    bool update();
-    const ControllerState& getState() const { return m_state; }
-    NormalizedState getNormalizedState() const;
+    // timeoutMs = 0 polls without blocking; timeoutMs > 0 blocks until a report
+    // arrives or the timeout expires.
+    bool update(int timeoutMs = 0) override;
+    const ControllerState& getState() const override { return m_state; }
+    NormalizedState getNormalizedState() const override;
 
-    // LED and haptics (optional features)
-    void setLEDColor(uint8_t r, uint8_t g, uint8_t b);
-    void setPlayerLED(uint8_t pattern);
+    // LED and haptics (optional features), written by the output scheduler
+    void setLEDColor(uint8_t r, uint8_t g, uint8_t b) override;
+    void setPlayerLED(uint8_t pattern) override;
+    void requestOutput(const DualSenseOutputRequest& request) override;
+    OutputReportStats getOutputReportStats() const override { return m_outputScheduler.getStats(); }
+    void resetOutputReportStats() override { m_outputScheduler.resetStats(); }
+
+    // Bluetooth input reports dropped for a bad CRC
+    InputReportStats getReportStats() const override { return m_validator.getStats(); }
+    void resetReportStats() override { m_validator.resetStats(); }
+
+    bool hasFactoryCalibration() const override { return m_factoryCalibrated; }
 
     // Info
+    std::string getName() const override { return "DualSense"; }
     std::string getDevicePath() const { return m_devicePath; }
     bool isUSB() const { return m_isUSB; }
     bool isBluetooth() const { return !m_isUSB; }
 
 private:
-    void parseInputReport(const uint8_t* data, size_t length);
-    void parseUSBReport(const uint8_t* data);
-    void parseBluetoothReport(const uint8_t* data);
-    bool sendOutputReport();
+    // Runs on the output scheduler's writer thread
+    bool writeOutputReport(const DualSenseOutputState& state);
+
+    // Feature report 0x05; falls back to nominal ranges if it cannot be read
+    static bool readCalibration(hid_device* device, bool bluetooth, DualSenseCalibration& calibration);
+
+    // Opened by the hotplug watcher, waiting for the processing thread
+    struct PendingDevice {
+        hid_device* device = nullptr;
+        std::string path;
+        bool isUSB = true;
+        DualSenseCalibration calibration;
+        bool factoryCalibrated = false;
+    };
 
     hid_device* m_device = nullptr;
     ControllerState m_state;
@@ -40,17 +68,23 @@ private:
     bool m_connected = false;
     bool m_isUSB = true;
 
-    // Output report state
-    uint8_t m_ledR = 0;
-    uint8_t m_ledG = 0;
-    uint8_t m_ledB = 255;
-    uint8_t m_playerLED = 0;
-    bool m_outputDirty = true;
+    DualSenseReportValidator m_validator;
+
+    std::mutex m_pendingMutex;
+    PendingDevice m_pending;
+
+    // Motion sensor conversion, replaced at every connect
+    DualSenseCalibration m_calibration;
+    std::atomic<bool> m_factoryCalibrated{false};
+
+    // Output channel (LEDs); the sequence is only touched by its writer thread
+    OutputReportScheduler m_outputScheduler;
+    uint8_t m_outputSequence = 0;   // Bluetooth only, 0-15
 
     // Timing
     std::chrono::high_resolution_clock::time_point m_lastUpdate;
 
     // Report buffer
-    static constexpr size_t REPORT_SIZE = 78;
+    static constexpr size_t REPORT_SIZE = DUALSENSE_MAX_INPUT_REPORT_SIZE;
     uint8_t m_reportBuffer[REPORT_SIZE];
 };
@@ -0,0 +1,265 @@
+#pragma once
+
+#include "Common.h"
+#include <array>
+
+// DualSense input report layout, shared by the HID device and the simulator.
+// Bluetooth reports carry the same payload as USB shifted by one byte.
+constexpr uint8_t DUALSENSE_USB_INPUT_REPORT_ID = 0x01;
+constexpr uint8_t DUALSENSE_BT_INPUT_REPORT_ID = 0x31;
+constexpr size_t DUALSENSE_USB_INPUT_REPORT_SIZE = 64;
+constexpr size_t DUALSENSE_BT_INPUT_REPORT_SIZE = 78;
+constexpr size_t DUALSENSE_MAX_INPUT_REPORT_SIZE = DUALSENSE_BT_INPUT_REPORT_SIZE;
+
+// The payload starts after the report ID over USB, and after the report ID
+// and a sequence byte over Bluetooth
+constexpr size_t DUALSENSE_USB_PAYLOAD_OFFSET = 1;
+constexpr size_t DUALSENSE_BT_PAYLOAD_OFFSET = 2;
+
+// Buttons: 3 bytes, little-endian, the D-Pad nibble then the BUTTON_* bits
+constexpr uint32_t DUALSENSE_DPAD_MASK = 0x0F;
+constexpr int DUALSENSE_BUTTON_SHIFT = 4;
+constexpr uint32_t DUALSENSE_BUTTON_MASK = (1u << BUTTON_COUNT) - 1;
+
+// Touch contact: byte 0 is the tracking ID with bit 7 set while not touching,
+// then 12-bit X and 12-bit Y packed into three bytes
+constexpr size_t DUALSENSE_TOUCH_CONTACT_SIZE = 4;
+constexpr uint8_t DUALSENSE_TOUCH_INACTIVE = 0x80;
+constexpr uint8_t DUALSENSE_TOUCH_ID_MASK = 0x7F;
+
+// Sensor timestamp resolution: one tick is 1/3 microsecond
+constexpr double DUALSENSE_SENSOR_TICK_US = 1.0 / 3.0;
+
+// Bluetooth reports end in a little-endian CRC-32 computed over a one-byte HID
+// transaction header followed by the report up to the CRC
+constexpr size_t DUALSENSE_BT_CRC_SIZE = 4;
+constexpr uint8_t DUALSENSE_BT_INPUT_CRC_SEED = 0xA1;    // DATA | Input
+constexpr uint8_t DUALSENSE_BT_OUTPUT_CRC_SEED = 0xA2;   // DATA | Output
+
+// Factory motion-sensor calibration, feature report 0x05. Read once at
+// connect; over Bluetooth it ends in a CRC like the input reports.
+constexpr uint8_t DUALSENSE_CALIBRATION_REPORT_ID = 0x05;
+constexpr size_t DUALSENSE_CALIBRATION_REPORT_SIZE = 41;
+constexpr uint8_t DUALSENSE_BT_FEATURE_CRC_SEED = 0xA3;  // DATA | Feature
+
+// Nominal sensor ranges, used when no calibration could be read: +-2000 deg/s
+// and +-4 g over the int16 range
+constexpr float DUALSENSE_NOMINAL_GYRO_COUNTS_PER_DEG_S = 32768.0f / 2000.0f;
+constexpr float DUALSENSE_NOMINAL_ACCEL_COUNTS_PER_G = 8192.0f;
+
+// Calibration values as stored in the controller. Axes are X, Y, Z (pitch,
+// yaw, roll for the gyro).
+struct DualSenseCalibrationData {
+    int16_t gyroBias[3] = {};
+    int16_t gyroPlus[3] = {};       // Readings while turning at +gyroSpeedPlus deg/s
+    int16_t gyroMinus[3] = {};      // Readings while turning at -gyroSpeedMinus deg/s
+    int16_t gyroSpeedPlus = 0;
+    int16_t gyroSpeedMinus = 0;
+    int16_t accelPlus[3] = {};      // Readings at +1 g and -1 g
+    int16_t accelMinus[3] = {};
+};
+
+// Per-axis conversion precomputed from the calibration data, so the normalize
+// step is one multiply-add per axis: physical = raw * scale + offset.
+// Default-constructed it holds the nominal ranges.
+struct DualSenseCalibration {
+    std::array<float, 3> gyroScale = {1.0f / DUALSENSE_NOMINAL_GYRO_COUNTS_PER_DEG_S,
+                                      1.0f / DUALSENSE_NOMINAL_GYRO_COUNTS_PER_DEG_S,
+                                      1.0f / DUALSENSE_NOMINAL_GYRO_COUNTS_PER_DEG_S};
+    std::array<float, 3> gyroOffset = {};
+    std::array<float, 3> accelScale = {1.0f / DUALSENSE_NOMINAL_ACCEL_COUNTS_PER_G,
+                                       1.0f / DUALSENSE_NOMINAL_ACCEL_COUNTS_PER_G,
+                                       1.0f / DUALSENSE_NOMINAL_ACCEL_COUNTS_PER_G};
+    std::array<float, 3> accelOffset = {};
+    bool factory = false;           // Built from the controller's calibration report
+};
+
+inline const DualSenseCalibration DUALSENSE_NOMINAL_CALIBRATION{};
+
+// Output report (rumble, adaptive triggers, lightbar, player LEDs). USB puts
+// the common payload right after the report ID; Bluetooth adds a
+// sequence/tag header and the CRC.
+constexpr uint8_t DUALSENSE_USB_OUTPUT_REPORT_ID = 0x02;
+constexpr uint8_t DUALSENSE_BT_OUTPUT_REPORT_ID = 0x31;
+constexpr size_t DUALSENSE_USB_OUTPUT_REPORT_SIZE = 48;
+constexpr size_t DUALSENSE_BT_OUTPUT_REPORT_SIZE = 78;
+constexpr size_t DUALSENSE_MAX_OUTPUT_REPORT_SIZE = DUALSENSE_BT_OUTPUT_REPORT_SIZE;
+
+// Adaptive trigger effect modes (the raw mode byte) and their parameters
+constexpr uint8_t DUALSENSE_TRIGGER_OFF = 0x05;
+constexpr uint8_t DUALSENSE_TRIGGER_RESISTANCE = 0x01;  // start, force
+constexpr uint8_t DUALSENSE_TRIGGER_WEAPON = 0x02;      // start, end, force
+constexpr uint8_t DUALSENSE_TRIGGER_VIBRATION = 0x06;   // frequency, amplitude, start
+constexpr size_t DUALSENSE_TRIGGER_PARAM_COUNT = 10;
+
+struct DualSenseTriggerEffect {
+    uint8_t mode = DUALSENSE_TRIGGER_OFF;
+    std::array<uint8_t, DUALSENSE_TRIGGER_PARAM_COUNT> params = {};
+};
+
+inline bool operator==(const DualSenseTriggerEffect& a, const DualSenseTriggerEffect& b) {
+    return a.mode == b.mode && a.params == b.params;
+}
+
+// Host-controlled outputs carried by every output report
+struct DualSenseOutputState {
+    uint8_t ledR = 0;
+    uint8_t ledG = 0;
+    uint8_t ledB = 255;
+    uint8_t playerLED = 0;
+
+    // Rumble motor strength (0-255); the left motor is the heavier one
+    uint8_t rumbleLeft = 0;
+    uint8_t rumbleRight = 0;
+
+    DualSenseTriggerEffect leftTrigger;
+    DualSenseTriggerEffect rightTrigger;
+};
+
+inline bool operator==(const DualSenseOutputState& a, const DualSenseOutputState& b) {
+    return a.ledR == b.ledR && a.ledG == b.ledG && a.ledB == b.ledB && a.playerLED == b.playerLED &&
+           a.rumbleLeft == b.rumbleLeft && a.rumbleRight == b.rumbleRight &&
+           a.leftTrigger == b.leftTrigger && a.rightTrigger == b.rightTrigger;
+}
+
+inline bool operator!=(const DualSenseOutputState& a, const DualSenseOutputState& b) {
+    return !(a == b);
+}
+
+// Output changes requested during one frame. Only the parts that were set are
+// applied; everything else keeps its current value. Merging keeps the later
+// request's value for each part that both set.
+struct DualSenseOutputRequest {
+    bool hasRumble = false;
+    uint8_t rumbleLeft = 0;
+    uint8_t rumbleRight = 0;
+
+    bool hasLeftTrigger = false;
+    DualSenseTriggerEffect leftTrigger;
+    bool hasRightTrigger = false;
+    DualSenseTriggerEffect rightTrigger;
+
+    bool empty() const { return !hasRumble && !hasLeftTrigger && !hasRightTrigger; }
+
+    void merge(const DualSenseOutputRequest& later) {
+        if (later.hasRumble) {
+            hasRumble = true;
+            rumbleLeft = later.rumbleLeft;
+            rumbleRight = later.rumbleRight;
+        }
+        if (later.hasLeftTrigger) {
+            hasLeftTrigger = true;
+            leftTrigger = later.leftTrigger;
+        }
+        if (later.hasRightTrigger) {
+            hasRightTrigger = true;
+            rightTrigger = later.rightTrigger;
+        }
+    }
+
+    void applyTo(DualSenseOutputState& state) const {
+        if (hasRumble) {
+            state.rumbleLeft = rumbleLeft;
+            state.rumbleRight = rumbleRight;
+        }
+        if (hasLeftTrigger) {
+            state.leftTrigger = leftTrigger;
+        }
+        if (hasRightTrigger) {
+            state.rightTrigger = rightTrigger;
+        }
+    }
+};
+
+// Output reports written versus changes merged into a report still pending
+struct OutputReportStats {
+    uint64_t sent = 0;
+    uint64_t coalesced = 0;     // Changes folded into an already pending report
+    uint64_t failed = 0;        // Writes that failed (the state is retried)
+};
+
+// CRC of a Bluetooth report whose last DUALSENSE_BT_CRC_SIZE bytes hold the CRC
+uint32_t computeDualSenseBtCrc(uint8_t seed, const uint8_t* report, size_t length);
+bool checkDualSenseBtCrc(uint8_t seed, const uint8_t* report, size_t length);
+void writeDualSenseBtCrc(uint8_t seed, uint8_t* report, size_t length);
+
+// Input reports accepted versus dropped for a bad Bluetooth CRC
+struct InputReportStats {
+    uint64_t accepted = 0;
+    uint64_t crcFailures = 0;
+};
+
+// Integrity check in front of the parser. Bluetooth input reports must carry a
+// valid CRC; USB reports have none and always pass. Used from the reading
+// thread; the counters may be read from any thread.
+class DualSenseReportValidator {
+public:
+    bool accept(const uint8_t* data, size_t length);
+
+    InputReportStats getStats() const;
+    void resetStats();
+
+private:
+    std::atomic<uint64_t> m_accepted{0};
+    std::atomic<uint64_t> m_crcFailures{0};
+};
+
+// Unwraps the 32-bit sensor timestamp (wraps about every 24 minutes) and
+// converts the step between consecutive reports into seconds.
+class DeviceClock {
+public:
+    // Elapsed device time since the previous report, or a negative value when
+    // it cannot be trusted (first report after a reset, or an implausible jump)
+    double advance(uint32_t timestamp);
+
+    // Forget the previous timestamp (on reconnect)
+    void reset() { m_hasLast = false; }
+
+    // Unwrapped tick count since the first report
+    uint64_t getTicks() const { return m_ticks; }
+
+private:
+    // A gap longer than this means reports were lost or the device restarted
+    static constexpr double MAX_STEP_SECONDS = 0.25;
+
+    bool m_hasLast = false;
+    uint32_t m_last = 0;
+    uint64_t m_ticks = 0;
+};
+
+// Parse a raw input report into state. Returns false if the report is too
+// short or not a recognized input report (state is left untouched).
+bool parseDualSenseReport(const uint8_t* data, size_t length, ControllerState& state);
+
+// Build a raw input report from state, byte-compatible with what the
+// controller sends (including the Bluetooth CRC). Returns the report size, or
+// 0 if capacity is too small.
+size_t encodeDualSenseReport(const ControllerState& state, bool bluetooth, uint8_t* out, size_t capacity);
+
+// Build an output report. sequence is the Bluetooth sequence number (0-15,
+// ignored over USB). Returns the report size, or 0 if capacity is too small.
+size_t encodeDualSenseOutputReport(const DualSenseOutputState& state, bool bluetooth, uint8_t sequence,
+                                   uint8_t* out, size_t capacity);
+
+// Read the output state back from an output report (for captures and
+// tests). Returns false if it is not an output report or its CRC is bad.
+bool decodeDualSenseOutputReport(const uint8_t* data, size_t length, DualSenseOutputState& state);
+
+// Precompute the per-axis conversion. Returns false (and leaves calibration
+// untouched) if the data cannot describe a working sensor.
+bool computeDualSenseCalibration(const DualSenseCalibrationData& data, DualSenseCalibration& calibration);
+
+// Read the calibration feature report (report ID first). Returns false if it
+// is too short, has another ID, fails the Bluetooth CRC or holds unusable data.
+bool parseDualSenseCalibrationReport(const uint8_t* data, size_t length, bool bluetooth,
+                                     DualSenseCalibration& calibration);
+
+// Build a calibration feature report (for the simulator). Returns the report
+// size, or 0 if capacity is too small.
+size_t encodeDualSenseCalibrationReport(const DualSenseCalibrationData& data, bool bluetooth,
+                                        uint8_t* out, size_t capacity);
+
+// Convert raw controller state to the normalized form scripts work with; gyro
+// in deg/s and accelerometer in g through the given calibration
+NormalizedState normalizeControllerState(const ControllerState& state,
+                                         const DualSenseCalibration& calibration = DUALSENSE_NOMINAL_CALIBRATION);
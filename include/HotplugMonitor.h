@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include <condition_variable>
+
+// Discovery counters since the last reset
+struct HotplugStats {
+    uint64_t probes = 0;        // Discovery attempts (device enumerations)
+    uint64_t arrivals = 0;      // Arrival notifications and manual pokes
+    uint64_t connects = 0;      // Devices handed to the processing thread
+};
+
+// Looks for the controller on its own thread while it is disconnected, so
+// the processing thread never enumerates HID devices itself.
+//
+// After a failed probe the watcher sleeps MIN_RETRY, doubling up to
+// MAX_RETRY, so an idle app without a controller costs about one
+// enumeration per second. An OS device-arrival notification (Windows:
+// CM_Register_Notification on the HID interface class) or poke() cuts the
+// wait short, which keeps reconnects fast despite the backoff. While a device
+// is connected the watcher sleeps until deviceLost().
+class HotplugMonitor {
+public:
+    // Runs on the watcher thread. Finds and opens the device and stages it for
+    // the processing thread; returns true when a device is ready to adopt.
+    using ProbeFunction = std::function<bool()>;
+
+    static constexpr std::chrono::milliseconds MIN_RETRY{50};
+    static constexpr std::chrono::milliseconds MAX_RETRY{1000};
+
+    HotplugMonitor() = default;
+    ~HotplugMonitor();
+
+    HotplugMonitor(const HotplugMonitor&) = delete;
+    HotplugMonitor& operator=(const HotplugMonitor&) = delete;
+
+    // connected tells the watcher whether to start searching right away
+    void start(ProbeFunction probe, bool connected);
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // Processing thread: the device is gone; start searching (idempotent)
+    void deviceLost();
+
+    // Processing thread: true once per successful probe. waitReady blocks up
+    // to timeout until one is available (without taking it), so a
+    // disconnected loop can sleep instead of spin.
+    bool takeReady();
+    bool waitReady(std::chrono::milliseconds timeout);
+
+    // Probe now and restart the backoff (device arrival, manual reconnect)
+    void poke();
+
+    HotplugStats getStats() const;
+    void resetStats();
+
+private:
+    void run();
+    void registerArrivalNotification();
+    void unregisterArrivalNotification();
+
+    ProbeFunction m_probe;
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;         // Watcher: search, poke or stop
+    std::condition_variable m_readyChanged; // Processing thread: device ready
+    bool m_stop = false;
+    bool m_searching = false;
+    bool m_ready = false;
+    bool m_poked = false;
+
+    std::atomic<uint64_t> m_probes{0};
+    std::atomic<uint64_t> m_arrivals{0};
+    std::atomic<uint64_t> m_connects{0};
+
+#ifdef _WIN32
+    void* m_notification = nullptr;  // HCMNOTIFICATION
+#endif
+};
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Common.h"
+#include "DualSenseReport.h"
+
+// Source of controller input for the processing pipeline.
+// Implemented by the physical DualSense (hidapi) and by SimulatedDualSense.
+class IInputDevice {
+public:
+    virtual ~IInputDevice() = default;
+
+    // Connection
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+    virtual bool isConnected() const = 0;
+
+    // Background discovery, split so the slow part stays off the processing
+    // thread. openPending runs on the hotplug watcher: it finds and opens the
+    // device without touching the reading state, and returns true once one is
+    // staged. adoptPending runs on the processing thread and switches to the
+    // staged device. Devices that connect cheaply keep the defaults.
+    virtual bool openPending() { return true; }
+    virtual bool adoptPending() { return connect(); }
+
+    // Read the next report. timeoutMs = 0 polls without blocking; timeoutMs > 0
+    // blocks until a report arrives or the timeout expires.
+    // Returns true if a new report was parsed into the state.
+    virtual bool update(int timeoutMs = 0) = 0;
+
+    virtual const ControllerState& getState() const = 0;
+    virtual NormalizedState getNormalizedState() const = 0;
+
+    // LED control (optional, ignored by devices without LEDs). Safe to call
+    // from any thread; devices with an output channel never block on the write.
+    virtual void setLEDColor(uint8_t r, uint8_t g, uint8_t b) { (void)r; (void)g; (void)b; }
+    virtual void setPlayerLED(uint8_t pattern) { (void)pattern; }
+
+    // Rumble and adaptive trigger changes requested by scripts for one frame
+    // (ignored by devices without haptics)
+    virtual void requestOutput(const DualSenseOutputRequest& request) { (void)request; }
+
+    // Output reports sent versus changes coalesced into a pending report
+    virtual OutputReportStats getOutputReportStats() const { return {}; }
+    virtual void resetOutputReportStats() {}
+
+    // Reports accepted versus dropped by integrity checks (devices without
+    // checks report nothing)
+    virtual InputReportStats getReportStats() const { return {}; }
+    virtual void resetReportStats() {}
+
+    // Whether the motion sensors use the controller's factory calibration
+    // rather than nominal ranges (read at connect)
+    virtual bool hasFactoryCalibration() const { return false; }
+
+    // Display name for logs and UI
+    virtual std::string getName() const = 0;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Common.h"
+
+// Reports sent to the output versus identical frames that were skipped
+struct OutputSubmitStats {
+    uint64_t submitted = 0;
+    uint64_t suppressed = 0;
+};
+
+// Destination for processed controller state.
+// Implemented by the ViGEm virtual controller and by NullSink/CaptureSink.
+class IOutputSink {
+public:
+    virtual ~IOutputSink() = default;
+
+    // Connection
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+    virtual bool isConnected() const = 0;
+
+    // Submit one processed frame
+    virtual bool update(const NormalizedState& state) = 0;
+
+    // Get last error message
+    virtual const std::string& getLastError() const = 0;
+
+    // Frames identical to the last submitted one are skipped, except for a
+    // resend every keepalive interval (0 = never). Sinks without change
+    // suppression ignore this.
+    virtual void setKeepaliveInterval(std::chrono::milliseconds interval) { (void)interval; }
+    virtual OutputSubmitStats getSubmitStats() const { return {}; }
+    virtual void resetSubmitStats() {}
+};
@@ -1,68 +1,243 @@
 #pragma once
 
 #include "Common.h"
-#include "DualSenseController.h"
-#include "VirtualController.h"
+#include "IInputDevice.h"
+#include "IOutputSink.h"
 #include "ScriptManager.h"
+#include "StateSnapshot.h"
+#include "DualSenseReport.h"
+#include "LatencyHistogram.h"
+#include "PacingScheduler.h"
+#include "ThreadTuning.h"
+#include "TouchGestures.h"
+#include "MotionFusion.h"
+#include "HotplugMonitor.h"
+#include <array>
 
 class ConfigManager;  // Forward declaration
 
+// Timed stages of one processed frame
+enum class PipelineStage {
+    Read = 0,       // Device update (includes the blocking wait in event-driven mode)
+    Normalize,      // Backlog drain and getNormalizedState
+    Gestures,       // Touchpad gesture recognition
+    Motion,         // Sensor fusion
+    Scripts,        // Whole script chain (per-script times live in each ScriptEngine)
+    Output,         // Output sink update
+    Frame,          // Wake-to-output: read return until the output sink is updated
+    Count
+};
+
+const char* getPipelineStageName(PipelineStage stage);
+
+// Wake-to-output latency: time from the device read returning a report until
+// the output sink has been updated with the processed state
+struct LatencyStats {
+    InputMode mode = InputMode::EventDriven;
+    uint64_t samples = 0;
+    float averageUs = 0.0f;
+    float maxUs = 0.0f;
+};
+
+// Reports found per wake: the one that woke the loop plus any queued behind it
+struct BacklogStats {
+    BacklogPolicy policy = BacklogPolicy::LatestOnly;
+    uint64_t wakes = 0;
+    uint64_t reports = 0;
+    uint64_t backloggedWakes = 0;   // Wakes that found more than one report
+    uint64_t coalesced = 0;         // Reports skipped by LatestOnly
+    uint32_t maxDepth = 0;
+    float meanDepth = 0.0f;
+};
+
+// Delta time jitter: host read-to-read time versus the device's own sensor
+// clock, sampled on wakes that found exactly one report
+struct DeltaTimeStats {
+    DeltaTimeSource source = DeltaTimeSource::Device;
+    uint64_t samples = 0;
+    double hostMeanUs = 0.0;
+    double hostStdDevUs = 0.0;
+    double deviceMeanUs = 0.0;
+    double deviceStdDevUs = 0.0;
+    uint64_t fallbacks = 0;         // Wakes that fell back to host time
+};
+
+// Runs the read -> normalize -> scripts -> output pipeline. The device and sink
+// are injected so the same pipeline runs on hardware or headless.
 class InputProcessor {
 public:
-    InputProcessor();
+    InputProcessor(std::unique_ptr<IInputDevice> device, std::unique_ptr<IOutputSink> sink);
     ~InputProcessor();
 
     // Initialize all components
-    bool initialize(ConfigManager* config = nullptr);
+    bool initialize(ConfigManager* config = nullptr, const std::string& scriptsFolder = "scripts");
 
-    // Start/stop processing loop
-    bool start();
+    // Start/stop processing loop. With ownThread = false nothing is spawned
+    // besides the hotplug watcher; the caller (PipelinePool) drives update().
+    bool start(bool ownThread = true);
     void stop();
     bool isRunning() const { return m_running; }
 
     // Manual update (for testing or custom loop)
-    bool update();
+    // timeoutMs > 0 blocks on the device read until a report arrives
+    bool update(int timeoutMs = 0);
 
     // Access components
-    DualSenseController& getDualSense() { return m_dualSense; }
-    VirtualController& getVirtual() { return m_virtual; }
+    IInputDevice& getInputDevice() { return *m_device; }
+    IOutputSink& getOutputSink() { return *m_sink; }
     ScriptManager& getScriptManager() { return m_scriptManager; }
     ConfigManager* getConfigManager() { return m_config; }
 
-    // Get current states
-    const NormalizedState& getInputState() const { return m_inputState; }
-    const NormalizedState& getOutputState() const { return m_outputState; }
+    // Get current states (consistent copies, safe to call from any thread)
+    FrameSnapshot getSnapshot() const { return m_snapshot.load(); }
+    uint64_t getSnapshotVersion() const { return m_snapshot.version(); }
+    NormalizedState getInputState() const { return m_snapshot.load().input; }
+    NormalizedState getOutputState() const { return m_snapshot.load().output; }
 
     // Settings
     void setPollRate(float hz) { m_pollRateHz = hz; }
     float getPollRate() const { return m_pollRateHz; }
+    void setInputMode(InputMode mode);
+    InputMode getInputMode() const { return m_inputMode; }
+    void setPacingSpinWindow(int microseconds) { m_pacingSpinUs = microseconds; }
+    int getPacingSpinWindow() const { return m_pacingSpinUs; }
+
+    void setOutputKeepalive(int milliseconds);
+    int getOutputKeepalive() const { return m_outputKeepaliveMs; }
+
+    // Output reports actually submitted versus suppressed as unchanged
+    OutputSubmitStats getSubmitStats() const { return m_sink->getSubmitStats(); }
+    void resetSubmitStats() { m_sink->resetSubmitStats(); }
+
+    // Input reports accepted versus dropped for a bad Bluetooth CRC
+    InputReportStats getInputReportStats() const { return m_device->getReportStats(); }
+    void resetInputReportStats() { m_device->resetReportStats(); }
+
+    // Motion sensors in factory-calibrated units rather than nominal ranges
+    bool hasFactoryCalibration() const { return m_device->hasFactoryCalibration(); }
+
+    // Output reports (LEDs) written to the controller versus changes coalesced
+    OutputReportStats getOutputReportStats() const { return m_device->getOutputReportStats(); }
+    void resetOutputReportStats() { m_device->resetOutputReportStats(); }
+
+    void setBacklogPolicy(BacklogPolicy policy);
+    BacklogPolicy getBacklogPolicy() const { return m_backlogPolicy; }
+
+    void setDeltaTimeSource(DeltaTimeSource source);
+    DeltaTimeSource getDeltaTimeSource() const { return m_deltaTimeSource; }
+    DeltaTimeStats getDeltaTimeStats() const;
+
+    // Priority, affinity and timer resolution of the processing thread.
+    // Changes are applied by the thread itself on its next iteration.
+    void setThreadTuning(const ThreadTuning& tuning);
+    ThreadTuning getThreadTuning() const;
+    // Outcome of the last application, one line per setting (empty = defaults)
+    std::string getThreadTuningStatus() const;
+
+    // Backlog depth since the last latency reset
+    BacklogStats getBacklogStats() const;
+
+    // Achieved rate and wake jitter of the periodic-mode scheduler
+    PacingStats getPacingStats() const { return m_pacer.getStats(); }
+    void resetPacingStats() { m_pacer.resetStats(); }
+
+    // Latency measured for the current input mode (reset on mode change)
+    LatencyStats getLatencyStats() const;
+    void resetLatencyStats();
+
+    // Per-stage timing histograms
+    const LatencyHistogram& getStageHistogram(PipelineStage stage) const {
+        return m_stageHistograms[static_cast<size_t>(stage)];
+    }
+
+    // Summaries of every stage followed by every loaded script
+    std::vector<LatencyReportEntry> getLatencyReport() const;
 
     // Status
-    bool isDualSenseConnected() const { return m_dualSense.isConnected(); }
-    bool isVirtualConnected() const { return m_virtual.isConnected(); }
+    bool isDualSenseConnected() const { return m_device->isConnected(); }
+    bool isVirtualConnected() const { return m_sink->isConnected(); }
+
+    // Controller discovery while disconnected
+    HotplugStats getHotplugStats() const { return m_hotplug.getStats(); }
+    void resetHotplugStats() { m_hotplug.resetStats(); }
 
-    // Reconnect
+    // Reconnect. While running, the DualSense reconnect is carried out by the
+    // processing thread and this only returns whether it was requested.
     bool reconnectDualSense();
     bool reconnectVirtual();
 
 private:
     void processingLoop();
+    void processFrame(float deltaTime, std::chrono::steady_clock::time_point wakeTime);
+    LatencyHistogram& stageHistogram(PipelineStage stage) {
+        return m_stageHistograms[static_cast<size_t>(stage)];
+    }
 
-    DualSenseController m_dualSense;
-    VirtualController m_virtual;
+    std::unique_ptr<IInputDevice> m_device;
+    std::unique_ptr<IOutputSink> m_sink;
     ScriptManager m_scriptManager;
 
+    // Working state, only touched by the processing thread
     NormalizedState m_inputState;
     NormalizedState m_outputState;
+    InputContext m_context;
+
+    // Reports drained in one wake (ReplayAll); anything beyond waits for the next wake
+    static constexpr size_t MAX_BACKLOG_REPORTS = 64;
+    std::array<NormalizedState, MAX_BACKLOG_REPORTS> m_backlog;
+    std::array<InputContext, MAX_BACKLOG_REPORTS> m_backlogContext;    // Touch only
+    std::array<float, MAX_BACKLOG_REPORTS> m_backlogDeviceDt;
+
+    // Unwraps the device sensor timestamp into delta times
+    DeviceClock m_deviceClock;
+
+    // Run on every frame before the scripts
+    TouchGestureRecognizer m_gestures;
+    MotionFusion m_motion;
+
+    // Published copy of the last processed frame for the GUI and overlay
+    SeqLock<FrameSnapshot> m_snapshot;
 
     std::thread m_thread;
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_shouldStop{false};
 
-    float m_pollRateHz = 1000.0f;
+    // Finds the controller off the processing thread while it is disconnected
+    HotplugMonitor m_hotplug;
+    std::atomic<bool> m_reconnectRequested{false};
+
+    std::atomic<float> m_pollRateHz{1000.0f};
+    std::atomic<InputMode> m_inputMode{InputMode::EventDriven};
+    std::atomic<int> m_pacingSpinUs{200};
+    std::atomic<int> m_outputKeepaliveMs{100};
+    std::atomic<BacklogPolicy> m_backlogPolicy{BacklogPolicy::LatestOnly};
+    std::atomic<DeltaTimeSource> m_deltaTimeSource{DeltaTimeSource::Device};
+
+    // Thread tuning requested from the GUI and the result of applying it
+    mutable std::mutex m_tuningMutex;
+    ThreadTuning m_threadTuning;
+    std::string m_threadTuningStatus;
+    std::atomic<uint32_t> m_tuningGeneration{0};
+
+    // Periodic-mode deadline scheduler (driven only by the processing thread)
+    PacingScheduler m_pacer;
+
+    // Stage timings (written by processing thread, read by GUI)
+    LatencyHistogram m_stageHistograms[static_cast<size_t>(PipelineStage::Count)];
+
+    // Backlog depth counters (written by processing thread, read by GUI)
+    std::atomic<uint64_t> m_backlogWakes{0};
+    std::atomic<uint64_t> m_backlogReports{0};
+    std::atomic<uint64_t> m_backloggedWakes{0};
+    std::atomic<uint64_t> m_coalescedReports{0};
+    std::atomic<uint32_t> m_maxBacklogDepth{0};
+
+    // Delta time jitter (written by processing thread, read by GUI)
+    RunningVariance m_hostDtStats;
+    RunningVariance m_deviceDtStats;
+    std::atomic<uint64_t> m_deviceDtFallbacks{0};
 
     std::chrono::high_resolution_clock::time_point m_lastUpdate;
-    std::mutex m_stateMutex;
 
     ConfigManager* m_config = nullptr;
 };
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Common.h"
+#include <ostream>
+
+// Fixed-memory log-linear histogram of durations in nanoseconds.
+//
+// Values are bucketed by power of two, and each power of two is split into
+// SUB_BUCKETS linear sub-buckets, so any recorded value is reported within
+// ~6% of its true value. Memory is constant no matter how many samples are
+// recorded. One thread records (relaxed atomics, no locks) while any thread
+// may read percentiles.
+class LatencyHistogram {
+public:
+    struct Summary {
+        uint64_t count = 0;
+        double meanNs = 0.0;
+        uint64_t p50Ns = 0;
+        uint64_t p99Ns = 0;
+        uint64_t p999Ns = 0;
+        uint64_t maxNs = 0;
+    };
+
+    LatencyHistogram();
+
+    void record(uint64_t ns);
+    void record(std::chrono::steady_clock::duration duration) {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+        record(static_cast<uint64_t>(ns > 0 ? ns : 0));
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    // Value at or below which the given fraction (0.0 - 1.0) of samples fall
+    uint64_t percentile(double fraction) const;
+
+    Summary summarize() const;
+    void reset();
+
+private:
+    static constexpr int SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = 1ull << SUB_BUCKET_BITS;
+    static constexpr int MAX_VALUE_BITS = 36;  // ~68 s; larger values are clamped
+    static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    static size_t bucketIndex(uint64_t ns);
+    static uint64_t bucketUpperBound(size_t index);
+
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+// Running mean and standard deviation of a sample stream, for values whose
+// spread matters more than their tail (e.g. frame-to-frame delta times).
+// Same threading contract as LatencyHistogram.
+class RunningVariance {
+public:
+    void record(double value);
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    double mean() const;
+    double stdDev() const;
+    void reset();
+
+private:
+    // Sums are of (value - first value) so the variance of a near-constant
+    // stream does not cancel out in floating point
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<double> m_shift{0.0};
+    std::atomic<double> m_sum{0.0};
+    std::atomic<double> m_sumSquares{0.0};
+};
+
+// A named histogram summary, as shown in the GUI and written to dumps
+struct LatencyReportEntry {
+    std::string name;
+    LatencyHistogram::Summary summary;
+};
+
+// Write summaries as CSV (one row per entry) or as a JSON array. Times are in
+// microseconds.
+void writeLatencyCsv(std::ostream& out, const std::vector<LatencyReportEntry>& entries);
+void writeLatencyJson(std::ostream& out, const std::vector<LatencyReportEntry>& entries);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Common.h"
+#include <array>
+#include <cstdlib>
+
+// Allocator for one Lua state (a lua_Alloc), so a script's memory is pooled,
+// counted and capped per engine.
+//
+// Blocks up to MAX_POOLED bytes come from size-class free lists carved out of
+// CHUNK_SIZE chunks, so the steady churn of small tables, strings and
+// closures is served without touching the system heap; chunks are kept until
+// the arena is destroyed. Larger blocks go to malloc. With a limit set, an
+// allocation that would take the heap past it fails: Lua then runs an
+// emergency collection and, if that frees too little, raises "not enough
+// memory" in the script instead of the process running out. A shrink never
+// fails: without a smaller block the old one is kept. Only the thread
+// running the state allocates; the counters can be read from any thread.
+class LuaArena {
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+    static constexpr size_t MAX_POOLED = 512;
+
+    LuaArena() = default;
+    ~LuaArena();
+
+    LuaArena(const LuaArena&) = delete;
+    LuaArena& operator=(const LuaArena&) = delete;
+
+    // lua_Alloc; ud is the arena
+    static void* allocate(void* ud, void* ptr, size_t osize, size_t nsize);
+
+    // Hard cap on the bytes in use, 0 = unlimited. Blocks already allocated
+    // stay; only growth past the cap fails.
+    void setLimit(size_t bytes) { m_limit.store(bytes, std::memory_order_relaxed); }
+    size_t getLimit() const { return m_limit.load(std::memory_order_relaxed); }
+
+    // Bytes Lua currently holds, and the most it held since resetPeak()
+    size_t getBytesInUse() const { return m_inUse.load(std::memory_order_relaxed); }
+    size_t getPeakBytes() const { return m_peak.load(std::memory_order_relaxed); }
+
+    // Bytes taken from the system: pool chunks plus large blocks
+    size_t getReservedBytes() const { return m_reserved.load(std::memory_order_relaxed); }
+
+    // Allocations refused by the limit since resetPeak()
+    uint64_t getFailedAllocations() const { return m_failed.load(std::memory_order_relaxed); }
+
+    // Total bytes ever handed out (grows only; the owning thread paces the
+    // collector with it)
+    uint64_t getBytesAllocated() const { return m_allocated; }
+
+    void resetPeak();
+
+    // Where pool chunks come from; std::malloc unless replaced, and the
+    // arena frees them with std::free. Tests swap in one that fails.
+    using ChunkAllocator = void* (*)(size_t);
+    void setChunkAllocator(ChunkAllocator allocator) { m_chunkAllocator = allocator; }
+
+private:
+    static constexpr size_t CLASS_COUNT = 10;
+    static constexpr size_t LARGE = CLASS_COUNT;
+    static constexpr std::array<size_t, CLASS_COUNT> CLASS_SIZES = {16, 32, 48, 64, 96, 128, 192, 256, 384, 512};
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    // Size class of a block, LARGE above MAX_POOLED
+    static size_t classOf(size_t size);
+
+    void* reallocate(void* ptr, size_t osize, size_t nsize);
+    void* take(size_t sizeClass);
+    void release(void* block, size_t size);
+
+    std::array<FreeBlock*, CLASS_COUNT> m_free{};
+    std::vector<void*> m_chunks;
+    ChunkAllocator m_chunkAllocator = std::malloc;
+    uint8_t* m_cursor = nullptr;        // Uncarved rest of the newest chunk
+    size_t m_remaining = 0;
+    uint64_t m_allocated = 0;
+
+    std::atomic<size_t> m_limit{0};
+    std::atomic<size_t> m_inUse{0};
+    std::atomic<size_t> m_peak{0};
+    std::atomic<size_t> m_reserved{0};
+    std::atomic<uint64_t> m_failed{0};
+};
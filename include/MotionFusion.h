@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Common.h"
+
+// Mahony complementary filter turning calibrated gyro (deg/s) and
+// accelerometer (g) samples into an orientation, so scripts get tilt and
+// world-space rates without integrating quaternions in Lua.
+//
+// The world frame has +Y up (the controller lying flat reads +1 g on Y).
+// The accelerometer pulls pitch and roll back towards gravity whenever its
+// magnitude is close to 1 g; yaw has no absolute reference, so its drift is
+// limited by removing gyro bias instead. While the controller is held still
+// (gyro and accelerometer both quiet for STILL_SECONDS) the gyro reading is
+// averaged into the bias estimate.
+class MotionFusion {
+public:
+    // Proportional gain of the accelerometer correction (1/s)
+    static constexpr float ACCEL_GAIN = 2.0f;
+    // Accelerometer magnitudes further than this from 1 g are not trusted
+    static constexpr float ACCEL_TOLERANCE_G = 0.15f;
+
+    // Still detection and bias averaging
+    static constexpr float STILL_GYRO_DEG_S = 4.0f;
+    static constexpr float STILL_ACCEL_G = 0.03f;
+    static constexpr float STILL_SECONDS = 0.5f;
+    static constexpr float BIAS_TIME_CONSTANT = 1.0f;
+
+    // Steps longer than this (lost reports, reconnects) are not integrated
+    static constexpr float MAX_STEP_SECONDS = 0.1f;
+
+    // Read gyro/accel from state and fill in the context's orientation fields
+    void update(const NormalizedState& state, InputContext& context, float deltaTime);
+
+    // Start over: identity orientation, no bias, re-align to the next sample
+    void reset();
+
+    // Set auto-bias off to compare against the raw drift (on by default)
+    void setAutoBias(bool enabled) { m_autoBias = enabled; }
+
+    // Current gyro bias estimate in deg/s (X, Y, Z)
+    const float* getGyroBias() const { return m_bias; }
+
+private:
+    void alignToGravity(float ax, float ay, float az);
+
+    // Orientation, controller to world
+    float m_qw = 1.0f;
+    float m_qx = 0.0f;
+    float m_qy = 0.0f;
+    float m_qz = 0.0f;
+    bool m_aligned = false;
+
+    bool m_autoBias = true;
+    float m_bias[3] = {};
+    float m_stillTime = 0.0f;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include "DualSenseReport.h"
+#include <condition_variable>
+#include <functional>
+
+// Dedicated output channel for a DualSense.
+//
+// Callers change a desired output state from any thread without touching the
+// device. A writer thread sends the latest state as one report, at most
+// maxRate times per second, so any number of changes between two writes cost
+// a single report and a slow write never blocks the caller (or input reads).
+class OutputReportScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    // Writes one report for the given state; returns false on failure.
+    // Called only on the writer thread.
+    using WriteFunction = std::function<bool(const DualSenseOutputState& state)>;
+
+    static constexpr float DEFAULT_MAX_RATE_HZ = 250.0f;
+
+    OutputReportScheduler() = default;
+    ~OutputReportScheduler();
+
+    OutputReportScheduler(const OutputReportScheduler&) = delete;
+    OutputReportScheduler& operator=(const OutputReportScheduler&) = delete;
+
+    // Start the writer thread. The current desired state is sent right away.
+    void start(WriteFunction write);
+    // Stop the writer thread; a pending change is kept for the next start
+    void stop();
+    bool isRunning() const { return m_thread.joinable(); }
+
+    // Upper bound on reports per second
+    void setMaxRate(float hz);
+    float getMaxRate() const { return m_maxRateHz; }
+
+    // Apply a change to the desired state. A report is scheduled only if the
+    // state actually changed.
+    template <typename Change>
+    void update(Change&& change) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DualSenseOutputState next = m_desired;
+        change(next);
+        if (next == m_desired) {
+            return;
+        }
+        m_desired = next;
+        markPending();
+    }
+
+    DualSenseOutputState getDesiredState() const;
+
+    // Resend the desired state even if unchanged (e.g. after a reconnect)
+    void invalidate();
+
+    OutputReportStats getStats() const;
+    void resetStats();
+
+private:
+    void writerLoop();
+    void markPending();     // m_mutex must be held
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    DualSenseOutputState m_desired;
+    bool m_pending = true;
+    bool m_stopping = false;
+    WriteFunction m_write;
+    std::thread m_thread;
+
+    std::atomic<float> m_maxRateHz{DEFAULT_MAX_RATE_HZ};
+
+    std::atomic<uint64_t> m_sent{0};
+    std::atomic<uint64_t> m_coalesced{0};
+    std::atomic<uint64_t> m_failed{0};
+};
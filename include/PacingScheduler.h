@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Common.h"
+#include "LatencyHistogram.h"
+
+// Achieved pacing since the last reset
+struct PacingStats {
+    float targetHz = 0.0f;
+    float achievedHz = 0.0f;
+    uint64_t ticks = 0;
+    uint64_t missedTicks = 0;           // Deadlines skipped because we fell a full period behind
+    LatencyHistogram::Summary lateness; // Wake time minus deadline
+};
+
+// Absolute-deadline periodic scheduler.
+//
+// Deadlines advance by exactly one period per tick, so sleep overshoot does not
+// accumulate into drift. Each wait sleeps with the OS high-resolution timer
+// until spinWindow before the deadline, then spins the remainder:
+//   - Linux/POSIX: clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME)
+//   - Windows: high-resolution waitable timer (falls back to a standard one)
+class PacingScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    PacingScheduler();
+    ~PacingScheduler();
+
+    PacingScheduler(const PacingScheduler&) = delete;
+    PacingScheduler& operator=(const PacingScheduler&) = delete;
+
+    // Changing the rate restarts the deadline sequence and the statistics
+    void setRate(float hz);
+    float getRate() const { return m_rateHz; }
+
+    // Portion of each wait that is spun instead of slept
+    void setSpinWindow(std::chrono::microseconds window) { m_spinWindow = window; }
+    std::chrono::microseconds getSpinWindow() const { return m_spinWindow; }
+
+    // Start a fresh deadline sequence one period from now
+    void reset();
+
+    // Block until the next deadline. Returns how late the wake was.
+    Clock::duration waitNext();
+
+    // Safe to call from any thread
+    PacingStats getStats() const;
+    void resetStats();
+
+private:
+    void sleepUntil(Clock::time_point deadline);
+
+    std::atomic<float> m_rateHz{1000.0f};
+    Clock::duration m_period;
+    std::chrono::microseconds m_spinWindow{200};
+    Clock::time_point m_nextDeadline;
+
+    // Statistics (written by the pacing thread, read by the GUI)
+    std::atomic<uint64_t> m_ticks{0};
+    std::atomic<uint64_t> m_missedTicks{0};
+    std::atomic<int64_t> m_statsStartNs{0};
+    LatencyHistogram m_lateness;
+
+#ifdef _WIN32
+    void* m_timer = nullptr;  // HANDLE
+#endif
+};
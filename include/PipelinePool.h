@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Common.h"
+#include "InputProcessor.h"
+#include "LatencyHistogram.h"
+
+// Runs one pipeline per controller on a fixed set of worker threads instead
+// of a thread each, so many pads scale across cores without oversubscribing
+// them.
+//
+// Each pipeline keeps its input mode. Periodic pipelines are split across the
+// workers round-robin and stay on their worker, so each script chain (and its
+// Lua state) is only ever touched by one thread. Every worker paces itself at
+// the poll rate and services its pipelines in turn. A pipeline whose
+// controller is gone only checks its hotplug watcher; a worker with no
+// controller connected sleeps IDLE_INTERVAL between checks.
+//
+// An event-driven pipeline blocks on its own device read, which a shared
+// worker cannot do for several pads, so it gets its own thread as a single
+// pipeline would. Which pipelines are pooled is decided on start().
+class PipelinePool {
+public:
+    static constexpr std::chrono::milliseconds IDLE_INTERVAL{10};
+
+    // workers = 0 uses one per hardware thread, never more than pooled pipelines
+    explicit PipelinePool(size_t workers = 0);
+    ~PipelinePool();
+
+    PipelinePool(const PipelinePool&) = delete;
+    PipelinePool& operator=(const PipelinePool&) = delete;
+
+    // Add an initialized pipeline while stopped; returns its index
+    size_t add(std::unique_ptr<InputProcessor> pipeline);
+    size_t size() const { return m_slots.size(); }
+    InputProcessor& get(size_t index) { return *m_slots[index]->pipeline; }
+    const InputProcessor& get(size_t index) const { return *m_slots[index]->pipeline; }
+
+    bool start();
+    void stop();
+    bool isRunning() const { return m_running; }
+    size_t getWorkerCount() const { return m_workerCount; }
+
+    // Pacing of every worker (and of every pipeline, for the ones on their
+    // own thread); picked up on the next tick
+    void setPollRate(float hz);
+    float getPollRate() const { return m_pollRateHz; }
+    void setPacingSpinWindow(int microseconds);
+    int getPacingSpinWindow() const { return m_pacingSpinUs; }
+
+    // Input mode of every pipeline. A running pool restarts so pipelines
+    // move between the workers and their own threads.
+    void setInputMode(InputMode mode);
+
+    // Applied by each worker (and each pipeline on its own thread) when the
+    // pool starts and again whenever it changes
+    void setThreadTuning(const ThreadTuning& tuning);
+    ThreadTuning getThreadTuning() const;
+
+    // Worker wake until this pipeline's output was updated, including the
+    // pipelines served before it in the same tick (empty for a pipeline on
+    // its own thread)
+    const LatencyHistogram& getServiceHistogram(size_t index) const { return m_slots[index]->service; }
+    void resetServiceHistograms();
+
+private:
+    struct Slot {
+        std::unique_ptr<InputProcessor> pipeline;
+        LatencyHistogram service;
+    };
+
+    void workerLoop(size_t worker);
+
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    std::vector<Slot*> m_pooled;        // Serviced by the workers (periodic mode)
+    std::vector<std::thread> m_workers;
+    size_t m_requestedWorkers = 0;
+    size_t m_workerCount = 0;
+    std::atomic<bool> m_running{false};
+    std::atomic<bool> m_shouldStop{false};
+
+    std::atomic<float> m_pollRateHz{1000.0f};
+    std::atomic<int> m_pacingSpinUs{200};
+    mutable std::mutex m_tuningMutex;
+    ThreadTuning m_threadTuning;
+    std::atomic<uint32_t> m_tuningGeneration{0};
+};
@@ -1,13 +1,42 @@
 #pragma once
 
 #include "Common.h"
+#include "LatencyHistogram.h"
+#include "DualSenseReport.h"
+#include "LuaArena.h"
 #include <lua.hpp>
 
+// How the state crosses into Lua and back each frame
+enum class StateBridge {
+    Userdata,   // One persistent userdata over the state and context; no allocation per frame
+    Table       // One table per engine, refilled in place every frame
+};
+
+// The state and context a script sees as `input` (defined in ScriptEngine.cpp)
+struct ScriptInput;
+
+// Lua heap and collector activity of one script
+struct ScriptMemoryStats {
+    size_t heapBytes = 0;           // Held by the script's Lua state
+    size_t peakBytes = 0;           // Most held since the last reset
+    size_t reservedBytes = 0;       // Taken from the system (pool chunks, large blocks)
+    size_t limitBytes = 0;          // Hard cap, 0 = unlimited
+    uint64_t failedAllocations = 0; // Refused by the cap
+    uint64_t gcSteps = 0;           // Collector steps run after frames
+    uint64_t gcTimeNs = 0;          // Total time in those steps
+    uint64_t gcMaxNs = 0;           // Longest step
+    double gcMsPerSecond = 0.0;     // Collector time over the last second the script ran
+};
+
 class ScriptEngine {
 public:
     ScriptEngine();
     ~ScriptEngine();
 
+    // The Lua state points back at its engine
+    ScriptEngine(const ScriptEngine&) = delete;
+    ScriptEngine& operator=(const ScriptEngine&) = delete;
+
     // Initialize the Lua state
     bool initialize();
 
@@ -19,7 +48,41 @@ public:
 
     // Process input through the script
     // Returns modified state
-    NormalizedState process(const NormalizedState& input, float deltaTime);
+    NormalizedState process(const NormalizedState& input, const InputContext& context, float deltaTime);
+
+    // Without touch or motion: no contacts, level orientation
+    NormalizedState process(const NormalizedState& input, float deltaTime) {
+        return process(input, InputContext(), deltaTime);
+    }
+
+    // Userdata by default; a script can ask for the table with
+    // script_info.state = "table" (e.g. to use next() or rawget on input).
+    // Scripts see the same fields either way, and `input` is the same object
+    // every frame with both.
+    void setStateBridge(StateBridge bridge) { m_stateBridge = bridge; }
+    StateBridge getStateBridge() const { return m_stateBridge; }
+
+    // Bytes currently allocated by this engine's Lua state (any thread)
+    size_t getHeapBytes() const { return m_arena.getBytesInUse(); }
+
+    // Heap cap, 0 = unlimited; applies immediately. A script that hits it
+    // gets "not enough memory" from the allocation that would exceed it.
+    void setMemoryLimit(size_t bytes) { m_arena.setLimit(bytes); }
+    size_t getMemoryLimit() const { return m_arena.getLimit(); }
+
+    // Collector mode, applied by initialize(). The collector never runs on
+    // its own: after each frame that allocated at least a step's worth, the
+    // engine runs one bounded step (generational: a minor collection;
+    // incremental: a slice of the cycle), so pauses stay small and are
+    // measured per script. collectgarbage("stop"/"restart") in a script
+    // switches these steps off and on.
+    void setGcMode(ScriptGcMode mode) { m_gcMode = mode; }
+    ScriptGcMode getGcMode() const { return m_gcMode; }
+    void setCollectorStopped(bool stopped) { m_collectorStopped = stopped; }
+    bool isCollectorStopped() const { return m_collectorStopped; }
+
+    ScriptMemoryStats getMemoryStats() const;
+    void resetMemoryStats();
 
     // Call script's init function
     bool callInit();
@@ -27,10 +90,18 @@ public:
     // Call script's cleanup function
     void callCleanup();
 
-    // Set a parameter accessible from script
+    // Set a parameter accessible from script. Parameters declared in
+    // script_info.parameters get a slot at load and appear in the script's
+    // `params` table (their defaults until set); values set here reach the
+    // table before the next init/process call. get_param(name, default)
+    // reads the same table.
     void setParameter(const std::string& name, float value);
     float getParameter(const std::string& name, float defaultValue = 0.0f);
 
+    // set_param: like setParameter, for a value the script already stored
+    // in its params table
+    void storeParameter(const std::string& name, float value);
+
     // Get script info and parameters (call after loading)
     ScriptConfig getScriptInfo() const;
 
@@ -49,19 +120,79 @@ public:
     // Apply weapon preset overrides (for anti-recoil script)
     void applyWeaponPreset(const WeaponPreset* preset);
 
+    // Rumble/trigger changes the script requested since the last take
+    // (set_rumble, set_trigger_effect)
+    DualSenseOutputRequest& getOutputRequest() { return m_outputRequest; }
+
+    DualSenseOutputRequest takeOutputRequest();
+
+    // Time spent in process() per frame (recorded by ScriptManager)
+    LatencyHistogram& getProcessHistogram() { return m_processTime; }
+    const LatencyHistogram& getProcessHistogram() const { return m_processTime; }
+
 private:
     // Register C functions for Lua
     void registerFunctions();
 
-    // Push NormalizedState as a Lua table
-    void pushState(const NormalizedState& state);
+    // Refill the state table and push it
+    void pushState(const ScriptInput& input);
+
+    // Remove the keys the script added to the state table
+    void clearStateTable();
 
     // Read NormalizedState from Lua table at stack index
     NormalizedState readState(int index);
 
+    // Persistent state userdata and table, and the interned field names
+    // (created with the Lua state)
+    void createStateUserdata();
+    void createStateTable();
+
+    // References to process/init/cleanup, resolved once per load; a script
+    // that reassigns them later keeps the ones it defined at load
+    void resolveFunctions();
+    void releaseFunctions();
+
+    // Slots for the declared parameters, and copying changed values into
+    // the `params` table
+    void resolveParameters();
+    void flushParameters();
+
+    // Collector setup for the mode, and the step after a frame
+    void applyGcMode();
+    void collectAfterFrame();
+
+    LuaArena m_arena;
     lua_State* m_lua = nullptr;
     std::string m_lastError;
     std::string m_scriptName;
     bool m_hasProcess = false;
-    std::unordered_map<std::string, float> m_parameters;
+    StateBridge m_stateBridge = StateBridge::Userdata;
+    int m_stateRef = LUA_NOREF;
+    int m_tableRef = LUA_NOREF;
+    int m_keysRef = LUA_NOREF;
+    int m_processRef = LUA_NOREF;
+    int m_initRef = LUA_NOREF;
+    int m_cleanupRef = LUA_NOREF;
+    ScriptInput* m_stateBlock = nullptr;
+    int m_paramsRef = LUA_NOREF;        // The `params` table
+    int m_paramKeysRef = LUA_NOREF;     // Slot -> key, interned
+    std::unordered_map<std::string, size_t> m_paramSlots;
+    std::vector<std::atomic<float>> m_slotValues;
+    std::unordered_map<std::string, float> m_parameters;    // Undeclared ones
+    std::atomic<bool> m_parametersDirty{false};
+    std::atomic<bool> m_undeclaredDirty{false};
+    LatencyHistogram m_processTime;
+    DualSenseOutputRequest m_outputRequest;
+
+    ScriptGcMode m_gcMode = ScriptGcMode::Generational;
+    bool m_collectorStopped = false;
+    uint64_t m_allocatedAtStep = 0;
+    uint32_t m_framesSinceRate = 0;
+    std::chrono::steady_clock::time_point m_gcWindowStart;
+    uint64_t m_gcWindowNs = 0;
+    std::atomic<uint64_t> m_gcSteps{0};
+    std::atomic<uint64_t> m_gcTimeNs{0};
+    std::atomic<uint64_t> m_gcMaxNs{0};
+    std::atomic<double> m_gcMsPerSecond{0.0};
 };
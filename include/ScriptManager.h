@@ -30,8 +30,13 @@ public:
     void setScriptEnabled(const std::string& name, bool enabled);
     bool isScriptEnabled(const std::string& name) const;
 
-    // Process input through all enabled scripts (in order)
-    NormalizedState process(const NormalizedState& input, float deltaTime);
+    // Process input through all enabled scripts (in order); each sees the
+    // same context
+    NormalizedState process(const NormalizedState& input, const InputContext& context, float deltaTime);
+
+    // Rumble/trigger requests of the last process() call, merged in script
+    // order (a later script overrides an earlier one)
+    const DualSenseOutputRequest& getFrameOutputRequest() const { return m_frameOutput; }
 
     // Get list of available scripts
     const std::vector<LoadedScript>& getScripts() const { return m_scripts; }
@@ -47,8 +52,22 @@ public:
     // Get scripts folder
     const std::string& getScriptsFolder() const { return m_scriptsFolder; }
 
+    // Lua heap cap of every script (0 = unlimited), applied immediately
+    void setScriptMemoryLimit(size_t bytes);
+    size_t getScriptMemoryLimit() const { return m_memoryLimit; }
+
+    // Collector mode of scripts loaded from now on (rescan to apply)
+    void setScriptGcMode(ScriptGcMode mode) { m_gcMode = mode; }
+    ScriptGcMode getScriptGcMode() const { return m_gcMode; }
+
 private:
+    // New engine with the memory settings applied
+    std::unique_ptr<ScriptEngine> createEngine() const;
+
     std::vector<LoadedScript> m_scripts;
     std::string m_scriptsFolder;
     ConfigManager* m_config = nullptr;
+    DualSenseOutputRequest m_frameOutput;
+    size_t m_memoryLimit = 0;
+    ScriptGcMode m_gcMode = ScriptGcMode::Generational;
 };
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "Common.h"
+#include "IInputDevice.h"
+#include "DualSenseReport.h"
+#include "OutputReportScheduler.h"
+
+// Software DualSense for headless runs and benchmarks.
+// Produces byte-accurate USB or Bluetooth input reports, either from a
+// deterministic motion generator or by replaying a capture file, and feeds
+// them through the same parser as the physical controller.
+class SimulatedDualSense : public IInputDevice {
+public:
+    enum class Transport {
+        USB,
+        Bluetooth
+    };
+
+    explicit SimulatedDualSense(Transport transport = Transport::USB);
+
+    // Calibration of the default simulated unit
+    static DualSenseCalibrationData defaultCalibrationData();
+    ~SimulatedDualSense() override;
+
+    // Replay raw reports from a file instead of the generator. The file is a
+    // back-to-back sequence of input reports (0x01 = 64 bytes, 0x31 = 78 bytes)
+    // and loops at the end.
+    bool loadReportFile(const std::string& path);
+
+    // Report rate to emulate. 0 = a new report on every update() call.
+    void setReportRate(float hz) { m_reportRateHz = hz; }
+    float getReportRate() const { return m_reportRateHz; }
+
+    // Connection
+    bool connect() override;
+    bool openPending() override { return m_pluggedIn; }
+    void disconnect() override;
+    bool isConnected() const override { return m_connected; }
+
+    // Emulate pulling and re-inserting the cable (safe from any thread).
+    // Unplugged, update() drops the connection and connect() fails.
+    void setPluggedIn(bool pluggedIn) { m_pluggedIn = pluggedIn; }
+
+    // Reading
+    bool update(int timeoutMs = 0) override;
+    const ControllerState& getState() const override { return m_state; }
+    NormalizedState getNormalizedState() const override;
+
+    // LEDs, rumble and triggers go through the same output scheduler as the
+    // physical controller; each "write" encodes the report and takes the
+    // emulated write latency
+    void setLEDColor(uint8_t r, uint8_t g, uint8_t b) override;
+    void setPlayerLED(uint8_t pattern) override;
+    void requestOutput(const DualSenseOutputRequest& request) override;
+    OutputReportStats getOutputReportStats() const override { return m_outputScheduler.getStats(); }
+    void resetOutputReportStats() override { m_outputScheduler.resetStats(); }
+
+    void setMaxOutputRate(float hz) { m_outputScheduler.setMaxRate(hz); }
+    void setOutputWriteLatency(std::chrono::microseconds latency) { m_outputWriteLatencyUs = static_cast<int>(latency.count()); }
+
+    // Raw bytes of the most recently written output report (empty if none yet)
+    std::vector<uint8_t> getLastOutputReport() const;
+
+    // Keep every written output report until taken (off by default)
+    void setOutputCapture(bool enabled);
+    std::vector<std::vector<uint8_t>> takeCapturedOutputReports();
+
+    // Calibration feature report the simulated controller answers at connect.
+    // The default describes a unit with small per-axis biases and slightly
+    // uneven gyro sensitivity; generated raw samples include those biases.
+    // Takes effect on the next connect().
+    void setCalibrationData(const DualSenseCalibrationData& data) { m_calibrationData = data; }
+    const DualSenseCalibrationData& getCalibrationData() const { return m_calibrationData; }
+    void setCalibrationAvailable(bool available) { m_calibrationAvailable = available; }
+    bool hasFactoryCalibration() const override { return m_calibration.factory; }
+
+    // Replayed Bluetooth reports with a bad CRC are dropped like on hardware
+    InputReportStats getReportStats() const override { return m_validator.getStats(); }
+    void resetReportStats() override { m_validator.resetStats(); }
+
+    // Info
+    std::string getName() const override;
+    Transport getTransport() const { return m_transport; }
+    uint64_t getReportCount() const { return m_reportCount; }
+
+    // Raw bytes of the most recent report
+    const uint8_t* getLastReport() const { return m_reportBuffer; }
+    size_t getLastReportSize() const { return m_reportSize; }
+
+private:
+    // Fill m_reportBuffer with the next report; returns false if none available
+    bool produceReport();
+    bool writeOutputReport(const DualSenseOutputState& state);
+    void generateState(ControllerState& state) const;
+
+    Transport m_transport;
+    std::atomic<bool> m_pluggedIn{true};
+    bool m_connected = false;
+    float m_reportRateHz = 0.0f;
+
+    ControllerState m_state;
+    DualSenseReportValidator m_validator;
+
+    DualSenseCalibrationData m_calibrationData;
+    bool m_calibrationAvailable = true;
+    DualSenseCalibration m_calibration;
+    uint64_t m_reportCount = 0;
+    std::chrono::steady_clock::time_point m_nextReportTime;
+
+    // Replay data (empty = use generator)
+    std::vector<uint8_t> m_replayData;
+    size_t m_replayOffset = 0;
+
+    uint8_t m_reportBuffer[DUALSENSE_MAX_INPUT_REPORT_SIZE] = {};
+    size_t m_reportSize = 0;
+
+    // Output channel
+    OutputReportScheduler m_outputScheduler;
+    std::atomic<int> m_outputWriteLatencyUs{0};
+    uint8_t m_outputSequence = 0;
+    mutable std::mutex m_outputMutex;
+    std::vector<uint8_t> m_lastOutputReport;
+    bool m_captureOutput = false;
+    std::vector<std::vector<uint8_t>> m_capturedOutputReports;
+};
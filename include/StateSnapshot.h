@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Common.h"
+#include <cstring>
+#include <type_traits>
+
+// Single-writer / multi-reader sequence lock.
+//
+// The writer never blocks or waits on readers: it bumps the sequence to an odd
+// value, stores the payload, then bumps it to the next even value. Readers copy
+// the payload and retry if the sequence was odd or changed underneath them, so
+// they always observe a complete value from a single store() call.
+//
+// The payload is held in relaxed atomic words rather than a plain T so the
+// concurrent copy is well-defined under the C++ memory model.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock payload must be trivially copyable");
+
+public:
+    SeqLock() {
+        store(T{});
+    }
+
+    // Publish a new value (only one thread may call this)
+    void store(const T& value) {
+        uint64_t words[WORD_COUNT] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        uint64_t seq = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < WORD_COUNT; i++) {
+            m_words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        m_sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Read a consistent copy of the latest value (safe from any thread)
+    T load() const {
+        uint64_t words[WORD_COUNT];
+        uint64_t before;
+        uint64_t after;
+
+        do {
+            before = m_sequence.load(std::memory_order_acquire);
+            for (size_t i = 0; i < WORD_COUNT; i++) {
+                words[i] = m_words[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) != 0 || before != after);
+
+        T value;
+        std::memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    // Number of completed store() calls (lets readers skip unchanged frames)
+    uint64_t version() const {
+        return m_sequence.load(std::memory_order_acquire) / 2;
+    }
+
+private:
+    static constexpr size_t WORD_COUNT = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    std::atomic<uint64_t> m_sequence{0};
+    std::atomic<uint64_t> m_words[WORD_COUNT];
+};
+
+// One processed frame as seen by the GUI and overlay
+struct FrameSnapshot {
+    NormalizedState input;
+    NormalizedState output;
+};
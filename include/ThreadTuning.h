@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Common.h"
+
+// Scheduling tuning for the processing thread, applied to the calling thread.
+//
+//   Priority   Windows                                Linux
+//   Normal     unchanged                              unchanged
+//   High       THREAD_PRIORITY_HIGHEST                SCHED_FIFO 1
+//   Games      MMCSS "Games", AVRT_PRIORITY_HIGH      SCHED_FIFO 10
+//   ProAudio   MMCSS "Pro Audio", AVRT_PRIORITY_CRITICAL  SCHED_FIFO 40
+//
+// The affinity mask pins the thread to the given CPUs (bit n = CPU n).
+// The timer resolution raises the system timer rate with timeBeginPeriod on
+// Windows (whole milliseconds) and sets the thread's timer slack on Linux.
+// SCHED_FIFO needs CAP_SYS_NICE or an rtprio limit; failures are reported,
+// not fatal.
+class ThreadTuningScope {
+public:
+    explicit ThreadTuningScope(const ThreadTuning& tuning);
+    ~ThreadTuningScope();
+
+    ThreadTuningScope(const ThreadTuningScope&) = delete;
+    ThreadTuningScope& operator=(const ThreadTuningScope&) = delete;
+
+    // One line per setting that was requested, e.g. "MMCSS Games: ok"
+    const std::string& getStatus() const { return m_status; }
+    bool allApplied() const { return m_allApplied; }
+
+private:
+    void applyPriority(ThreadPriority priority);
+    void applyAffinity(uint64_t mask);
+    void applyTimerResolution(int microseconds);
+    void report(const std::string& what, bool ok, const std::string& detail = "");
+
+    std::string m_status;
+    bool m_allApplied = true;
+
+    bool m_restoreAffinity = false;
+    uint64_t m_oldAffinity = 0;
+
+#ifdef _WIN32
+    void* m_mmcssHandle = nullptr;  // HANDLE from AvSetMmThreadCharacteristics
+    int m_oldThreadPriority = 0;
+    bool m_restoreThreadPriority = false;
+    unsigned int m_timerPeriodMs = 0;
+#else
+    bool m_restoreScheduler = false;
+    int m_oldPolicy = 0;
+    int m_oldPriority = 0;
+    unsigned long m_oldTimerSlackNs = 0;
+    bool m_restoreTimerSlack = false;
+#endif
+};
+
+const char* getThreadPriorityName(ThreadPriority priority);
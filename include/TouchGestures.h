@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Common.h"
+
+// Recognizes touchpad gestures from the per-frame contacts, so scripts get
+// discrete events instead of re-deriving them from raw positions.
+//
+// A gesture spans from the first finger landing until every finger has
+// lifted. Taps and swipes are reported on the frame the last finger lifts;
+// pinches are reported while both fingers are down, once per PINCH_STEP of
+// change in their distance, so a long pinch produces a stream of events.
+// A gesture that pinched does not also report a tap or swipe.
+class TouchGestureRecognizer {
+public:
+    // Thresholds in touchpad units (see TOUCHPAD_WIDTH) and seconds
+    static constexpr float TAP_MAX_SECONDS = 0.25f;
+    static constexpr float TAP_MAX_TRAVEL = 60.0f;
+    static constexpr float SWIPE_MAX_SECONDS = 0.8f;
+    static constexpr float SWIPE_MIN_TRAVEL = 400.0f;
+    static constexpr float PINCH_STEP = 200.0f;
+
+    // Feed one frame of contacts; returns the GESTURE_* bits completed by it
+    uint8_t update(const TouchPoint (&touch)[TOUCH_POINT_COUNT], float deltaTime);
+
+    // Forget any gesture in progress (e.g. after a reconnect)
+    void reset();
+
+private:
+    struct Track {
+        bool active = false;
+        uint8_t id = 0;
+        float startX = 0.0f;
+        float startY = 0.0f;
+        float x = 0.0f;
+        float y = 0.0f;
+    };
+
+    uint8_t finishGesture() const;
+
+    Track m_tracks[TOUCH_POINT_COUNT];
+
+    bool m_inGesture = false;
+    float m_elapsed = 0.0f;
+    int m_maxContacts = 0;
+    float m_maxTravel = 0.0f;
+
+    // Net movement of the last single-finger frame, for swipe direction
+    float m_swipeX = 0.0f;
+    float m_swipeY = 0.0f;
+
+    bool m_pinched = false;
+    bool m_pinchTracking = false;
+    float m_pinchBase = 0.0f;
+};
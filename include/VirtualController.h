@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Common.h"
+#include "IOutputSink.h"
+#include "XusbReport.h"
 
 // Forward declarations for ViGEm types
 struct _VIGEM_CLIENT_T;
@@ -8,28 +10,36 @@ struct _VIGEM_TARGET_T;
 typedef struct _VIGEM_CLIENT_T* PVIGEM_CLIENT;
 typedef struct _VIGEM_TARGET_T* PVIGEM_TARGET;
 
-class VirtualController {
+// Virtual Xbox 360 controller on the ViGEmBus driver
+class VirtualController : public IOutputSink {
 public:
     VirtualController();
-    ~VirtualController();
+    ~VirtualController() override;
 
     // Connection
-    bool connect();
-    void disconnect();
-    bool isConnected() const { return m_connected; }
+    bool connect() override;
+    void disconnect() override;
+    bool isConnected() const override { return m_connected; }
 
-    // Update virtual controller with state
-    bool update(const NormalizedState& state);
+    // Update virtual controller with state. Unchanged reports are not sent
+    // to the driver (see setKeepaliveInterval).
+    bool update(const NormalizedState& state) override;
 
     // Direct update from raw state
     bool updateRaw(const ControllerState& state);
 
     // Get last error message
-    const std::string& getLastError() const { return m_lastError; }
+    const std::string& getLastError() const override { return m_lastError; }
+
+    // Change suppression
+    void setKeepaliveInterval(std::chrono::milliseconds interval) override { m_submitFilter.setKeepalive(interval); }
+    OutputSubmitStats getSubmitStats() const override { return m_submitFilter.getStats(); }
+    void resetSubmitStats() override { m_submitFilter.resetStats(); }
 
 private:
     PVIGEM_CLIENT m_client = nullptr;
     PVIGEM_TARGET m_target = nullptr;
     bool m_connected = false;
     std::string m_lastError;
+    XusbSubmitFilter m_submitFilter;
 };
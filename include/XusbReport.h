@@ -0,0 +1,79 @@
+#pragma once
+
+#include "Common.h"
+#include "IOutputSink.h"
+
+// Xbox 360 (XUSB) button bits, identical to the ViGEm XUSB_BUTTON values
+constexpr uint16_t XUSB_BUTTON_DPAD_UP = 0x0001;
+constexpr uint16_t XUSB_BUTTON_DPAD_DOWN = 0x0002;
+constexpr uint16_t XUSB_BUTTON_DPAD_LEFT = 0x0004;
+constexpr uint16_t XUSB_BUTTON_DPAD_RIGHT = 0x0008;
+constexpr uint16_t XUSB_BUTTON_START = 0x0010;
+constexpr uint16_t XUSB_BUTTON_BACK = 0x0020;
+constexpr uint16_t XUSB_BUTTON_LEFT_THUMB = 0x0040;
+constexpr uint16_t XUSB_BUTTON_RIGHT_THUMB = 0x0080;
+constexpr uint16_t XUSB_BUTTON_LEFT_SHOULDER = 0x0100;
+constexpr uint16_t XUSB_BUTTON_RIGHT_SHOULDER = 0x0200;
+constexpr uint16_t XUSB_BUTTON_GUIDE = 0x0400;
+constexpr uint16_t XUSB_BUTTON_A = 0x1000;
+constexpr uint16_t XUSB_BUTTON_B = 0x2000;
+constexpr uint16_t XUSB_BUTTON_X = 0x4000;
+constexpr uint16_t XUSB_BUTTON_Y = 0x8000;
+
+// Portable mirror of ViGEm's XUSB_REPORT (same field order and sizes), so the
+// DualSense -> Xbox conversion can be built and tested without Windows headers
+struct XusbReport {
+    uint16_t wButtons = 0;
+    uint8_t bLeftTrigger = 0;
+    uint8_t bRightTrigger = 0;
+    int16_t sThumbLX = 0;
+    int16_t sThumbLY = 0;
+    int16_t sThumbRX = 0;
+    int16_t sThumbRY = 0;
+};
+
+// Convert normalized state to an Xbox 360 report
+XusbReport toXusbReport(const NormalizedState& state);
+
+inline bool operator==(const XusbReport& a, const XusbReport& b) {
+    return a.wButtons == b.wButtons &&
+           a.bLeftTrigger == b.bLeftTrigger && a.bRightTrigger == b.bRightTrigger &&
+           a.sThumbLX == b.sThumbLX && a.sThumbLY == b.sThumbLY &&
+           a.sThumbRX == b.sThumbRX && a.sThumbRY == b.sThumbRY;
+}
+
+inline bool operator!=(const XusbReport& a, const XusbReport& b) {
+    return !(a == b);
+}
+
+// Change suppression for report submission.
+//
+// Remembers the last submitted report and rejects bit-identical ones, except
+// that an unchanged report is resent once per keepalive interval (0 = never).
+// Used from the processing thread; the interval and counters may be accessed
+// from any thread.
+class XusbSubmitFilter {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    void setKeepalive(std::chrono::milliseconds interval) { m_keepaliveMs = static_cast<int>(interval.count()); }
+    std::chrono::milliseconds getKeepalive() const { return std::chrono::milliseconds(m_keepaliveMs.load()); }
+
+    // True if the report should be sent; it is then remembered as submitted
+    bool shouldSubmit(const XusbReport& report, Clock::time_point now = Clock::now());
+
+    // Force the next report through (after a reconnect or a failed send)
+    void invalidate() { m_hasLast = false; }
+
+    OutputSubmitStats getStats() const;
+    void resetStats();
+
+private:
+    std::atomic<int> m_keepaliveMs{100};
+    bool m_hasLast = false;
+    XusbReport m_last;
+    Clock::time_point m_lastSubmit;
+
+    std::atomic<uint64_t> m_submitted{0};
+    std::atomic<uint64_t> m_suppressed{0};
+};
@@ -12,16 +12,40 @@
     - share, options, ps, touchpad, mute: Other buttons (true/false)
     - dpad: D-pad direction (0-7 for directions, 8 = released)
            0=up, 1=up-right, 2=right, 3=down-right, 4=down, 5=down-left, 6=left, 7=up-left
-    - gyro_x, gyro_y, gyro_z: Gyroscope (normalized)
+    - gyro_x, gyro_y, gyro_z: Gyroscope (deg/s: pitch, yaw, roll)
+    - accel_x, accel_y, accel_z: Accelerometer (g, includes gravity)
+    - quat_w, quat_x, quat_y, quat_z: Orientation quaternion (world +Y up)
+    - gravity_x, gravity_y, gravity_z: Gravity direction in controller axes
+    - yaw_rate, pitch_rate: World-space turn rates (deg/s, gyro bias removed)
+    - motion_still: Controller held still (true/false)
+    - touch1_active, touch2_active: Finger on the touchpad (true/false)
+    - touch1_x, touch1_y, touch2_x, touch2_y: Touch position (0.0 to 1.0, 0,0 = top left)
+    - touch1_id, touch2_id: Tracking ID (changes with every new touch)
+    - tap, two_finger_tap, swipe_left, swipe_right, swipe_up, swipe_down,
+      pinch_in, pinch_out: Touchpad gestures (true on the frame they happen)
     - dt: Delta time since last update (seconds)
 
+    input is the same object every frame (refilled before process runs):
+    copy the values you want to remember, don't keep input itself.
+    Add state = "table" to script_info if the script needs input to be a
+    plain Lua table rather than a userdata.
+
     Available helper functions:
     - clamp(value, min, max): Clamp a value between min and max
     - lerp(a, b, t): Linear interpolation between a and b
     - deadzone(value, zone): Apply deadzone to a value
-    - get_param(name, default): Get a parameter value
+    - params.<key>: Value of a parameter declared in script_info.parameters
+    - get_param(name, default): Get a parameter value (default if unset)
     - set_param(name, value): Set a parameter value
     - print(...): Print to console (for debugging)
+    - set_rumble(left, right): Rumble motor strength (0.0 to 1.0)
+    - set_trigger_effect(side, mode, params): Adaptive trigger effect
+           side: "left" or "right"
+           mode: "off", "resistance" {start, force}, "weapon" {start, end, force},
+                 "vibration" {frequency, amplitude, start}, or a raw mode byte
+           params: bytes (0-255) for the mode, e.g. {60, 200}
+      Rumble and trigger effects stay set until changed. All calls in one
+      frame are sent to the controller as a single output report.
 ]]
 
 -- Script metadata (shown in UI)
@@ -33,7 +57,7 @@ script_info = {
     parameters = {
         -- Example float parameter (slider)
         {
-            key = "my_float",           -- Internal name for get_param()
+            key = "my_float",           -- Read as params.my_float
             name = "My Float Value",    -- Display name in UI
             description = "Tooltip description",
             type = "float",
@@ -81,12 +105,12 @@ end
 -- Called every frame with controller input
 -- Return the modified input
 function process(input)
-    local output = input  -- Start with a copy of input
+    local output = input  -- Modify input in place and return it
 
     -- Get parameter values
-    local my_float = get_param("my_float", 0.5)
-    local my_int = get_param("my_int", 5)
-    local my_bool = get_param("my_bool", 1) > 0.5
+    local my_float = params.my_float
+    local my_int = params.my_int
+    local my_bool = params.my_bool > 0.5
 
     -- YOUR CODE HERE
     -- Example: invert Y axis if feature enabled
@@ -58,10 +58,10 @@ function process(input)
     local output = input
 
     -- Get parameters
-    local slowdown = get_param("slowdown", 0.6)
-    local ads_threshold = get_param("ads_threshold", 0.3)
-    local precision_zone = get_param("precision_zone", 0.3)
-    local precision_slowdown = get_param("precision_slowdown", 0.4)
+    local slowdown = params.slowdown
+    local ads_threshold = params.ads_threshold
+    local precision_zone = params.precision_zone
+    local precision_slowdown = params.precision_slowdown
 
     -- Check if aiming down sights
     local is_ads = input.left_trigger > ads_threshold
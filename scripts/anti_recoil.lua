@@ -84,12 +84,12 @@ function process(input)
     local output = input
 
     -- Get parameters (these may be overridden by weapon presets)
-    local strength_ads = get_param("strength_ads", 0.15)
-    local strength_hipfire = get_param("strength_hipfire", 0.10)
-    local horizontal = get_param("horizontal_strength", 0.0)
-    local smoothing = get_param("smoothing", 0.5)
-    local fire_threshold = get_param("fire_threshold", 0.3)
-    local ads_threshold = get_param("ads_threshold", 0.3)
+    local strength_ads = params.strength_ads
+    local strength_hipfire = params.strength_hipfire
+    local horizontal = params.horizontal_strength
+    local smoothing = params.smoothing
+    local fire_threshold = params.fire_threshold
+    local ads_threshold = params.ads_threshold
 
     -- Check if firing (R2 pressed beyond threshold)
     local is_firing = input.right_trigger > fire_threshold
@@ -54,9 +54,9 @@ function process(input)
     total_time = total_time + input.dt
 
     -- Get parameters
-    local threshold = get_param("threshold", 0.8)
-    local hold_time = get_param("hold_time", 0.1)
-    local cooldown = get_param("cooldown", 0.5)
+    local threshold = params.threshold
+    local hold_time = params.hold_time
+    local cooldown = params.cooldown
 
     -- Check if pushing forward (negative Y is forward on most games)
     local pushing_forward = input.left_y < -threshold
@@ -38,8 +38,8 @@ function process(input)
     local output = input
 
     -- Get parameters
-    local left_dz = get_param("left_deadzone", 0.1)
-    local right_dz = get_param("right_deadzone", 0.05)
+    local left_dz = params.left_deadzone
+    local right_dz = params.right_deadzone
 
     -- Apply deadzone to left stick
     output.left_x = deadzone(input.left_x, left_dz)
@@ -42,8 +42,8 @@ function process(input)
     local output = input
 
     -- Get parameters
-    local fire_rate = get_param("fire_rate", 10)
-    local trigger_threshold = get_param("trigger_threshold", 0.8)
+    local fire_rate = params.fire_rate
+    local trigger_threshold = params.trigger_threshold
 
     -- Check if trigger is held
     if input.right_trigger > trigger_threshold then
@@ -1,4 +1,6 @@
 #include "Application.h"
+#include "DualSenseController.h"
+#include "VirtualController.h"
 #include <imgui.h>
 #include <imgui_impl_win32.h>
 
@@ -7,7 +9,8 @@ extern IMGUI_IMPL_API LRESULT ImGui_ImplWin32_WndProcHandler(HWND hWnd, UINT msg
 
 Application* Application::s_instance = nullptr;
 
-Application::Application() {
+Application::Application()
+    : m_processor(std::make_unique<DualSenseController>(), std::make_unique<VirtualController>()) {
     s_instance = this;
 }
 
@@ -45,6 +48,16 @@ bool Application::initialize(HINSTANCE hInstance) {
         return false;
     }
 
+    // Each further pad gets its own controller, virtual target and script
+    // chain; connecting in order claims the next unclaimed DualSense
+    for (int i = 1; i < m_config.getSettings().controllerCount; i++) {
+        auto pipeline = std::make_unique<InputProcessor>(std::make_unique<DualSenseController>(),
+                                                         std::make_unique<VirtualController>());
+        if (pipeline->initialize(&m_config)) {
+            m_extraPads.add(std::move(pipeline));
+        }
+    }
+
     // Initialize hotkey manager
     m_hotkeys.initialize(m_hwnd);
 
@@ -58,12 +71,15 @@ bool Application::initialize(HINSTANCE hInstance) {
             return;
         }
 
-        // Normal script toggle
+        // Normal script toggle, on every pad
         auto& scripts = m_processor.getScriptManager().getScripts();
         for (auto& script : scripts) {
             if (script.config.name == scriptName) {
                 bool newState = !script.config.enabled;
                 m_processor.getScriptManager().setScriptEnabled(scriptName, newState);
+                for (size_t i = 0; i < m_extraPads.size(); i++) {
+                    m_extraPads.get(i).getScriptManager().setScriptEnabled(scriptName, newState);
+                }
                 break;
             }
         }
@@ -107,6 +123,14 @@ bool Application::initialize(HINSTANCE hInstance) {
     // Auto-start processing
     m_processor.start();
 
+    if (m_extraPads.size() > 0) {
+        const auto& settings = m_config.getSettings();
+        m_extraPads.setPollRate(settings.pollRate);
+        m_extraPads.setPacingSpinWindow(settings.pacingSpinUs);
+        m_extraPads.setThreadTuning(settings.threadTuning);
+        m_extraPads.start();
+    }
+
     return true;
 }
 
@@ -296,6 +320,7 @@ void Application::shutdown() {
 
     m_overlay.shutdown();
     m_hotkeys.shutdown();
+    m_extraPads.stop();
     m_processor.stop();
     m_gui.shutdown();
     destroyD3D();
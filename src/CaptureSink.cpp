@@ -0,0 +1,23 @@
+#include "CaptureSink.h"
+
+bool NullSink::update(const NormalizedState& state) {
+    if (!m_connected) {
+        return false;
+    }
+
+    m_lastReport = toXusbReport(state);
+    m_submitFilter.shouldSubmit(m_lastReport);
+    m_frameCount.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool CaptureSink::update(const NormalizedState& state) {
+    if (!NullSink::update(state)) {
+        return false;
+    }
+
+    if (m_maxReports == 0 || m_reports.size() < m_maxReports) {
+        m_reports.push_back(m_lastReport);
+    }
+    return true;
+}
@@ -1,4 +1,5 @@
 #include "ConfigManager.h"
+#include <cstdlib>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -315,6 +316,17 @@ std::string ConfigManager::serializeToJson() const {
     std::ostringstream ss;
     ss << "{\n";
     ss << "  \"pollRate\": " << m_settings.pollRate << ",\n";
+    ss << "  \"inputMode\": " << static_cast<int>(m_settings.inputMode) << ",\n";
+    ss << "  \"pacingSpinUs\": " << m_settings.pacingSpinUs << ",\n";
+    ss << "  \"outputKeepaliveMs\": " << m_settings.outputKeepaliveMs << ",\n";
+    ss << "  \"backlogPolicy\": " << static_cast<int>(m_settings.backlogPolicy) << ",\n";
+    ss << "  \"deltaTimeSource\": " << static_cast<int>(m_settings.deltaTimeSource) << ",\n";
+    ss << "  \"threadPriority\": " << static_cast<int>(m_settings.threadTuning.priority) << ",\n";
+    ss << "  \"cpuAffinityMask\": \"0x" << std::hex << m_settings.threadTuning.affinityMask << std::dec << "\",\n";
+    ss << "  \"timerResolutionUs\": " << m_settings.threadTuning.timerResolutionUs << ",\n";
+    ss << "  \"controllerCount\": " << m_settings.controllerCount << ",\n";
+    ss << "  \"scriptMemoryLimitMB\": " << m_settings.scriptMemoryLimitMB << ",\n";
+    ss << "  \"scriptGcMode\": " << static_cast<int>(m_settings.scriptGcMode) << ",\n";
     ss << "  \"showDemo\": " << (m_settings.showDemo ? "true" : "false") << ",\n";
     ss << "  \"minimizeToTray\": " << (m_settings.minimizeToTray ? "true" : "false") << ",\n";
     ss << "  \"overlayEnabled\": " << (m_settings.overlayEnabled ? "true" : "false") << ",\n";
@@ -501,7 +513,83 @@ bool ConfigManager::parseFromJson(const std::string& json) {
     // Parse poll rate
     auto [prKey, prVal] = findValue("pollRate");
     if (prVal != std::string::npos) {
-        m_settings.pollRate = extractNumber(prVal);
+        m_settings.pollRate = std::clamp(static_cast<float>(extractNumber(prVal)), 100.0f, 8000.0f);
+    }
+
+    // Parse input mode
+    auto [imKey, imVal] = findValue("inputMode");
+    if (imVal != std::string::npos) {
+        int mode = static_cast<int>(extractNumber(imVal));
+        if (mode >= 0 && mode <= 1) {
+            m_settings.inputMode = static_cast<InputMode>(mode);
+        }
+    }
+
+    // Parse pacing spin window
+    auto [psKey, psVal] = findValue("pacingSpinUs");
+    if (psVal != std::string::npos) {
+        m_settings.pacingSpinUs = std::clamp(static_cast<int>(extractNumber(psVal)), 0, 2000);
+    }
+
+    // Parse output keepalive
+    auto [okKey, okVal] = findValue("outputKeepaliveMs");
+    if (okVal != std::string::npos) {
+        m_settings.outputKeepaliveMs = std::clamp(static_cast<int>(extractNumber(okVal)), 0, 5000);
+    }
+
+    // Parse backlog policy
+    auto [bpKey, bpVal] = findValue("backlogPolicy");
+    if (bpVal != std::string::npos) {
+        int policy = static_cast<int>(extractNumber(bpVal));
+        if (policy >= 0 && policy <= 1) {
+            m_settings.backlogPolicy = static_cast<BacklogPolicy>(policy);
+        }
+    }
+
+    // Parse delta time source
+    auto [dtKey, dtVal] = findValue("deltaTimeSource");
+    if (dtVal != std::string::npos) {
+        int source = static_cast<int>(extractNumber(dtVal));
+        if (source >= 0 && source <= 1) {
+            m_settings.deltaTimeSource = static_cast<DeltaTimeSource>(source);
+        }
+    }
+
+    // Parse processing thread tuning
+    auto [tpKey, tpVal] = findValue("threadPriority");
+    if (tpVal != std::string::npos) {
+        int priority = static_cast<int>(extractNumber(tpVal));
+        if (priority >= 0 && priority <= 3) {
+            m_settings.threadTuning.priority = static_cast<ThreadPriority>(priority);
+        }
+    }
+
+    auto [amKey, amVal] = findValue("cpuAffinityMask");
+    if (amVal != std::string::npos) {
+        // Stored as a hex string: a float cannot hold every 64-bit mask
+        m_settings.threadTuning.affinityMask = std::strtoull(extractString(amVal).c_str(), nullptr, 16);
+    }
+
+    auto [trKey, trVal] = findValue("timerResolutionUs");
+    if (trVal != std::string::npos) {
+        m_settings.threadTuning.timerResolutionUs = std::clamp(static_cast<int>(extractNumber(trVal)), 0, 15600);
+    }
+
+    // Parse controller count
+    auto [ccKey, ccVal] = findValue("controllerCount");
+    if (ccVal != std::string::npos) {
+        m_settings.controllerCount = std::clamp(static_cast<int>(extractNumber(ccVal)), 1, MAX_CONTROLLERS);
+    }
+
+    // Parse script memory settings
+    auto [smKey, smVal] = findValue("scriptMemoryLimitMB");
+    if (smVal != std::string::npos) {
+        m_settings.scriptMemoryLimitMB = std::clamp(static_cast<int>(extractNumber(smVal)), 0, 1024);
+    }
+
+    auto [sgKey, sgVal] = findValue("scriptGcMode");
+    if (sgVal != std::string::npos) {
+        m_settings.scriptGcMode = static_cast<ScriptGcMode>(std::clamp(static_cast<int>(extractNumber(sgVal)), 0, 1));
     }
 
     // Parse showDemo
@@ -0,0 +1,55 @@
+#include "Crc32.h"
+#include <array>
+
+namespace {
+    constexpr uint32_t CRC32_POLYNOMIAL = 0xEDB88320u;
+
+    using Crc32Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+    // Table 0 is the classic byte-at-a-time table; table k advances a byte's
+    // contribution by k further zero bytes
+    constexpr Crc32Tables buildTables() {
+        Crc32Tables tables = {};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc >> 1) ^ ((crc & 1u) ? CRC32_POLYNOMIAL : 0u);
+            }
+            tables[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; i++) {
+            for (size_t k = 1; k < 8; k++) {
+                uint32_t previous = tables[k - 1][i];
+                tables[k][i] = (previous >> 8) ^ tables[0][previous & 0xFF];
+            }
+        }
+        return tables;
+    }
+
+    constexpr Crc32Tables CRC32_TABLES = buildTables();
+
+    inline uint32_t readUInt32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+}
+
+uint32_t crc32Update(uint32_t crc, const uint8_t* data, size_t length) {
+    const auto& t = CRC32_TABLES;
+    crc = ~crc;
+
+    while (length >= 8) {
+        uint32_t low = readUInt32(data) ^ crc;
+        uint32_t high = readUInt32(data + 4);
+        crc = t[7][low & 0xFF] ^ t[6][(low >> 8) & 0xFF] ^ t[5][(low >> 16) & 0xFF] ^ t[4][low >> 24] ^
+              t[3][high & 0xFF] ^ t[2][(high >> 8) & 0xFF] ^ t[1][(high >> 16) & 0xFF] ^ t[0][high >> 24];
+        data += 8;
+        length -= 8;
+    }
+
+    while (length-- > 0) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *data++) & 0xFF];
+    }
+
+    return ~crc;
+}
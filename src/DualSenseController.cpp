@@ -1,47 +1,85 @@
 #include "DualSenseController.h"
 #include <cstring>
 #include <iostream>
+#include <set>
+
+namespace {
+    // Shared by every controller instance: hidapi is initialized once, and a
+    // device path belongs to at most one controller so several pads never
+    // open the same DualSense
+    std::mutex g_hidMutex;
+    int g_hidUsers = 0;
+    std::set<std::string> g_claimedPaths;
+
+    bool claimPath(const std::string& path) {
+        std::lock_guard<std::mutex> lock(g_hidMutex);
+        return g_claimedPaths.insert(path).second;
+    }
+
+    void releasePath(const std::string& path) {
+        std::lock_guard<std::mutex> lock(g_hidMutex);
+        g_claimedPaths.erase(path);
+    }
+}
 
 DualSenseController::DualSenseController() {
-    hid_init();
+    {
+        std::lock_guard<std::mutex> lock(g_hidMutex);
+        if (g_hidUsers++ == 0) {
+            hid_init();
+        }
+    }
     m_lastUpdate = std::chrono::high_resolution_clock::now();
     std::memset(m_reportBuffer, 0, REPORT_SIZE);
 }
 
 DualSenseController::~DualSenseController() {
     disconnect();
-    hid_exit();
+    if (m_pending.device) {
+        hid_close(m_pending.device);
+        releasePath(m_pending.path);
+    }
+
+    std::lock_guard<std::mutex> lock(g_hidMutex);
+    if (--g_hidUsers == 0) {
+        hid_exit();
+    }
 }
 
 bool DualSenseController::connect() {
-    if (m_connected) {
-        disconnect();
-    }
+    return openPending() && adoptPending();
+}
+
+bool DualSenseController::openPending() {
+    PendingDevice found;
 
     // Try to find DualSense controller
     hid_device_info* devices = hid_enumerate(DUALSENSE_VENDOR_ID, 0);
     hid_device_info* current = devices;
 
     while (current) {
-        if (current->product_id == DUALSENSE_PRODUCT_ID ||
-            current->product_id == DUALSENSE_EDGE_PRODUCT_ID) {
-
-            m_device = hid_open_path(current->path);
-            if (m_device) {
-                m_devicePath = current->path;
-                // USB reports have different structure than Bluetooth
-                // USB interface 3 is the one we want, or check usage page
-                m_isUSB = (current->interface_number == 3) ||
-                          (current->usage_page == 1 && current->usage == 5);
-                m_connected = true;
+        // Skip pads another controller instance already has
+        if ((current->product_id == DUALSENSE_PRODUCT_ID ||
+             current->product_id == DUALSENSE_EDGE_PRODUCT_ID) && claimPath(current->path)) {
+
+            found.device = hid_open_path(current->path);
+            if (!found.device) {
+                releasePath(current->path);
+            } else {
+                found.path = current->path;
+                // USB reports have different structure than Bluetooth. Both
+                // transports enumerate as a game pad (usage page 1, usage 5),
+                // so go by the bus; when hidapi cannot tell, only USB
+                // devices have an interface number
+                found.isUSB = (current->bus_type == HID_API_BUS_USB) ||
+                              (current->bus_type == HID_API_BUS_UNKNOWN && current->interface_number != -1);
 
                 // Set non-blocking mode
-                hid_set_nonblocking(m_device, 1);
-
-                // Initialize LED
-                m_outputDirty = true;
-                sendOutputReport();
+                hid_set_nonblocking(found.device, 1);
 
+                // Over Bluetooth this read also switches the controller to
+                // full 0x31 input reports
+                found.factoryCalibrated = readCalibration(found.device, !found.isUSB, found.calibration);
                 break;
             }
         }
@@ -49,31 +87,85 @@ bool DualSenseController::connect() {
     }
 
     hid_free_enumeration(devices);
-    return m_connected;
+    if (!found.device) {
+        return false;
+    }
+
+    // Replace anything staged earlier that was never adopted
+    std::lock_guard<std::mutex> lock(m_pendingMutex);
+    if (m_pending.device) {
+        hid_close(m_pending.device);
+        releasePath(m_pending.path);
+    }
+    m_pending = std::move(found);
+    return true;
+}
+
+bool DualSenseController::adoptPending() {
+    PendingDevice pending;
+    {
+        std::lock_guard<std::mutex> lock(m_pendingMutex);
+        pending = std::move(m_pending);
+        m_pending = PendingDevice();
+    }
+    if (!pending.device) {
+        return false;
+    }
+
+    if (m_connected) {
+        disconnect();
+    }
+
+    m_device = pending.device;
+    m_devicePath = std::move(pending.path);
+    m_isUSB = pending.isUSB;
+    m_calibration = pending.calibration;
+    m_factoryCalibrated = pending.factoryCalibrated;
+    m_validator.resetStats();
+    m_connected = true;
+
+    // Send the current LED state, then keep the output channel running
+    m_outputSequence = 0;
+    m_outputScheduler.start([this](const DualSenseOutputState& state) {
+        return writeOutputReport(state);
+    });
+    return true;
 }
 
 void DualSenseController::disconnect() {
+    // The writer thread uses the handle; stop it before closing
+    m_outputScheduler.stop();
+
     if (m_device) {
         hid_close(m_device);
         m_device = nullptr;
+        releasePath(m_devicePath);
     }
     m_connected = false;
     m_devicePath.clear();
 }
 
-bool DualSenseController::update() {
+bool DualSenseController::update(int timeoutMs) {
     if (!m_connected || !m_device) {
         return false;
     }
 
     m_prevState = m_state;
 
-    // Read input report
-    int bytesRead = hid_read(m_device, m_reportBuffer, REPORT_SIZE);
+    // Read input report (blocking with timeout when requested)
+    int bytesRead = (timeoutMs > 0)
+        ? hid_read_timeout(m_device, m_reportBuffer, REPORT_SIZE, timeoutMs)
+        : hid_read(m_device, m_reportBuffer, REPORT_SIZE);
+
+    // Drop corrupt Bluetooth frames and reports the parser rejects (unknown ID
+    // or too short), and take whatever is queued behind them
+    while (bytesRead > 0 &&
+           (!m_validator.accept(m_reportBuffer, static_cast<size_t>(bytesRead)) ||
+            !parseDualSenseReport(m_reportBuffer, static_cast<size_t>(bytesRead), m_state))) {
+        bytesRead = hid_read(m_device, m_reportBuffer, REPORT_SIZE);
+    }
 
     if (bytesRead > 0) {
-        parseInputReport(m_reportBuffer, bytesRead);
-
         // Update timestamp
         auto now = std::chrono::high_resolution_clock::now();
         m_state.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
@@ -87,212 +179,55 @@ bool DualSenseController::update() {
         return false;
     }
 
-    // No data available (non-blocking)
+    // No data available (non-blocking read or timeout expired)
     return false;
 }
 
-void DualSenseController::parseInputReport(const uint8_t* data, size_t length) {
-    if (length < 10) return;
-
-    // Report ID determines USB vs Bluetooth
-    uint8_t reportId = data[0];
-
-    if (reportId == 0x01) {
-        // USB report
-        parseUSBReport(data);
-    } else if (reportId == 0x31) {
-        // Bluetooth report
-        parseBluetoothReport(data);
-    }
-}
+bool DualSenseController::readCalibration(hid_device* device, bool bluetooth, DualSenseCalibration& calibration) {
+    uint8_t report[DUALSENSE_CALIBRATION_REPORT_SIZE] = {DUALSENSE_CALIBRATION_REPORT_ID};
+    int bytesRead = hid_get_feature_report(device, report, sizeof(report));
 
-void DualSenseController::parseUSBReport(const uint8_t* data) {
-    // USB report structure (offset by 1 for report ID)
-    m_state.leftStickX = data[1];
-    m_state.leftStickY = data[2];
-    m_state.rightStickX = data[3];
-    m_state.rightStickY = data[4];
-    m_state.leftTrigger = data[5];
-    m_state.rightTrigger = data[6];
-
-    // Buttons byte 8
-    uint8_t buttons1 = data[8];
-    m_state.dpad = buttons1 & 0x0F;
-    m_state.square = (buttons1 & 0x10) != 0;
-    m_state.cross = (buttons1 & 0x20) != 0;
-    m_state.circle = (buttons1 & 0x40) != 0;
-    m_state.triangle = (buttons1 & 0x80) != 0;
-
-    // Buttons byte 9
-    uint8_t buttons2 = data[9];
-    m_state.l1 = (buttons2 & 0x01) != 0;
-    m_state.r1 = (buttons2 & 0x02) != 0;
-    m_state.l2Button = (buttons2 & 0x04) != 0;
-    m_state.r2Button = (buttons2 & 0x08) != 0;
-    m_state.share = (buttons2 & 0x10) != 0;
-    m_state.options = (buttons2 & 0x20) != 0;
-    m_state.l3 = (buttons2 & 0x40) != 0;
-    m_state.r3 = (buttons2 & 0x80) != 0;
-
-    // Buttons byte 10
-    uint8_t buttons3 = data[10];
-    m_state.ps = (buttons3 & 0x01) != 0;
-    m_state.touchpad = (buttons3 & 0x02) != 0;
-    m_state.mute = (buttons3 & 0x04) != 0;
-
-    // Gyro and accelerometer (bytes 16-27)
-    m_state.gyroX = static_cast<int16_t>(data[16] | (data[17] << 8));
-    m_state.gyroY = static_cast<int16_t>(data[18] | (data[19] << 8));
-    m_state.gyroZ = static_cast<int16_t>(data[20] | (data[21] << 8));
-    m_state.accelX = static_cast<int16_t>(data[22] | (data[23] << 8));
-    m_state.accelY = static_cast<int16_t>(data[24] | (data[25] << 8));
-    m_state.accelZ = static_cast<int16_t>(data[26] | (data[27] << 8));
-
-    // Touch data (bytes 33+)
-    if (data[33] & 0x80) {
-        m_state.touchActive = false;
-    } else {
-        m_state.touchActive = true;
-        m_state.touchX = ((data[35] & 0x0F) << 8) | data[34];
-        m_state.touchY = (data[36] << 4) | ((data[35] & 0xF0) >> 4);
+    calibration = DualSenseCalibration();
+    if (bytesRead > 0 &&
+        parseDualSenseCalibrationReport(report, static_cast<size_t>(bytesRead), bluetooth, calibration)) {
+        return true;
     }
-}
-
-void DualSenseController::parseBluetoothReport(const uint8_t* data) {
-    // Bluetooth report has 1 byte offset compared to USB
-    m_state.leftStickX = data[2];
-    m_state.leftStickY = data[3];
-    m_state.rightStickX = data[4];
-    m_state.rightStickY = data[5];
-    m_state.leftTrigger = data[6];
-    m_state.rightTrigger = data[7];
-
-    // Buttons
-    uint8_t buttons1 = data[9];
-    m_state.dpad = buttons1 & 0x0F;
-    m_state.square = (buttons1 & 0x10) != 0;
-    m_state.cross = (buttons1 & 0x20) != 0;
-    m_state.circle = (buttons1 & 0x40) != 0;
-    m_state.triangle = (buttons1 & 0x80) != 0;
-
-    uint8_t buttons2 = data[10];
-    m_state.l1 = (buttons2 & 0x01) != 0;
-    m_state.r1 = (buttons2 & 0x02) != 0;
-    m_state.l2Button = (buttons2 & 0x04) != 0;
-    m_state.r2Button = (buttons2 & 0x08) != 0;
-    m_state.share = (buttons2 & 0x10) != 0;
-    m_state.options = (buttons2 & 0x20) != 0;
-    m_state.l3 = (buttons2 & 0x40) != 0;
-    m_state.r3 = (buttons2 & 0x80) != 0;
-
-    uint8_t buttons3 = data[11];
-    m_state.ps = (buttons3 & 0x01) != 0;
-    m_state.touchpad = (buttons3 & 0x02) != 0;
-    m_state.mute = (buttons3 & 0x04) != 0;
-
-    // Gyro/Accel at different offsets for Bluetooth
-    m_state.gyroX = static_cast<int16_t>(data[17] | (data[18] << 8));
-    m_state.gyroY = static_cast<int16_t>(data[19] | (data[20] << 8));
-    m_state.gyroZ = static_cast<int16_t>(data[21] | (data[22] << 8));
-    m_state.accelX = static_cast<int16_t>(data[23] | (data[24] << 8));
-    m_state.accelY = static_cast<int16_t>(data[25] | (data[26] << 8));
-    m_state.accelZ = static_cast<int16_t>(data[27] | (data[28] << 8));
+    std::cerr << "DualSense: no usable calibration report, using nominal sensor ranges" << std::endl;
+    return false;
 }
 
 NormalizedState DualSenseController::getNormalizedState() const {
-    NormalizedState norm;
-
-    // Normalize sticks to -1.0 to 1.0
-    norm.leftStickX = normalizeStick(m_state.leftStickX);
-    norm.leftStickY = normalizeStick(m_state.leftStickY);
-    norm.rightStickX = normalizeStick(m_state.rightStickX);
-    norm.rightStickY = normalizeStick(m_state.rightStickY);
-
-    // Normalize triggers to 0.0 to 1.0
-    norm.leftTrigger = normalizeTrigger(m_state.leftTrigger);
-    norm.rightTrigger = normalizeTrigger(m_state.rightTrigger);
-
-    // Copy buttons
-    norm.square = m_state.square;
-    norm.cross = m_state.cross;
-    norm.circle = m_state.circle;
-    norm.triangle = m_state.triangle;
-    norm.l1 = m_state.l1;
-    norm.r1 = m_state.r1;
-    norm.l2Button = m_state.l2Button;
-    norm.r2Button = m_state.r2Button;
-    norm.share = m_state.share;
-    norm.options = m_state.options;
-    norm.l3 = m_state.l3;
-    norm.r3 = m_state.r3;
-    norm.ps = m_state.ps;
-    norm.touchpad = m_state.touchpad;
-    norm.mute = m_state.mute;
-    norm.dpad = m_state.dpad;
-
-    // Normalize gyro (typical range is about -2000 to 2000 for normal movement)
-    constexpr float GYRO_SCALE = 1.0f / 2000.0f;
-    norm.gyroX = static_cast<float>(m_state.gyroX) * GYRO_SCALE;
-    norm.gyroY = static_cast<float>(m_state.gyroY) * GYRO_SCALE;
-    norm.gyroZ = static_cast<float>(m_state.gyroZ) * GYRO_SCALE;
-
-    return norm;
+    return normalizeControllerState(m_state, m_calibration);
 }
 
 void DualSenseController::setLEDColor(uint8_t r, uint8_t g, uint8_t b) {
-    if (m_ledR != r || m_ledG != g || m_ledB != b) {
-        m_ledR = r;
-        m_ledG = g;
-        m_ledB = b;
-        m_outputDirty = true;
-        sendOutputReport();
-    }
+    m_outputScheduler.update([r, g, b](DualSenseOutputState& state) {
+        state.ledR = r;
+        state.ledG = g;
+        state.ledB = b;
+    });
 }
 
 void DualSenseController::setPlayerLED(uint8_t pattern) {
-    if (m_playerLED != pattern) {
-        m_playerLED = pattern;
-        m_outputDirty = true;
-        sendOutputReport();
-    }
+    m_outputScheduler.update([pattern](DualSenseOutputState& state) {
+        state.playerLED = pattern;
+    });
 }
 
-bool DualSenseController::sendOutputReport() {
-    if (!m_connected || !m_device || !m_outputDirty) {
-        return false;
-    }
+void DualSenseController::requestOutput(const DualSenseOutputRequest& request) {
+    m_outputScheduler.update([&request](DualSenseOutputState& state) {
+        request.applyTo(state);
+    });
+}
 
-    uint8_t outputReport[48] = {0};
-
-    if (m_isUSB) {
-        outputReport[0] = 0x02;  // USB output report ID
-        outputReport[1] = 0xFF;  // Feature flags 1
-        outputReport[2] = 0x04;  // Feature flags 2 (LED)
-
-        // LED color
-        outputReport[45] = m_ledR;
-        outputReport[46] = m_ledG;
-        outputReport[47] = m_ledB;
-
-        // Player LEDs
-        outputReport[44] = m_playerLED;
-
-        int result = hid_write(m_device, outputReport, sizeof(outputReport));
-        m_outputDirty = (result < 0);
-        return result >= 0;
-    } else {
-        // Bluetooth output report
-        outputReport[0] = 0x31;  // Bluetooth output report ID
-        outputReport[1] = 0x02;  // Sequence tag
-        outputReport[2] = 0xFF;  // Feature flags 1
-        outputReport[3] = 0x04;  // Feature flags 2
-
-        outputReport[46] = m_ledR;
-        outputReport[47] = m_ledG;
-        // Note: Bluetooth needs CRC which we're skipping for simplicity
-
-        int result = hid_write(m_device, outputReport, sizeof(outputReport));
-        m_outputDirty = (result < 0);
-        return result >= 0;
+bool DualSenseController::writeOutputReport(const DualSenseOutputState& state) {
+    uint8_t outputReport[DUALSENSE_MAX_OUTPUT_REPORT_SIZE];
+    size_t size = encodeDualSenseOutputReport(state, !m_isUSB, m_outputSequence, outputReport, sizeof(outputReport));
+
+    int result = hid_write(m_device, outputReport, size);
+    if (result < 0) {
+        return false;
     }
+    m_outputSequence = (m_outputSequence + 1) & 0x0F;
+    return true;
 }
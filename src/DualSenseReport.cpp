@@ -0,0 +1,402 @@
+#include "DualSenseReport.h"
+#include "Crc32.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+    inline int16_t readInt16(const uint8_t* p) {
+        return static_cast<int16_t>(p[0] | (p[1] << 8));
+    }
+
+    inline uint32_t readUInt24(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+    }
+
+    inline uint32_t readUInt32(const uint8_t* p) {
+        return readUInt24(p) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    inline void putUInt32(uint8_t* dst, uint32_t value) {
+        dst[0] = static_cast<uint8_t>(value & 0xFF);
+        dst[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+        dst[2] = static_cast<uint8_t>((value >> 16) & 0xFF);
+        dst[3] = static_cast<uint8_t>((value >> 24) & 0xFF);
+    }
+
+    inline void putInt16(uint8_t* dst, int16_t value) {
+        dst[0] = static_cast<uint8_t>(value & 0xFF);
+        dst[1] = static_cast<uint8_t>((static_cast<uint16_t>(value) >> 8) & 0xFF);
+    }
+
+    // Offsets within the common input payload
+    constexpr size_t INPUT_STICKS = 0;              // LX, LY, RX, RY, L2, R2 (one byte each)
+    constexpr size_t INPUT_BUTTONS = 7;
+    constexpr size_t INPUT_GYRO = 15;               // X, Y, Z (int16 LE)
+    constexpr size_t INPUT_ACCEL = 21;              // X, Y, Z (int16 LE)
+    constexpr size_t INPUT_SENSOR_TIMESTAMP = 27;   // uint32 LE
+    constexpr size_t INPUT_TOUCH = 32;              // TOUCH_POINT_COUNT contacts
+
+    void parsePayload(const uint8_t* payload, ControllerState& state) {
+        const uint8_t* axes = payload + INPUT_STICKS;
+        state.leftStickX = axes[0];
+        state.leftStickY = axes[1];
+        state.rightStickX = axes[2];
+        state.rightStickY = axes[3];
+        state.leftTrigger = axes[4];
+        state.rightTrigger = axes[5];
+
+        // D-Pad nibble and all buttons in one load, then mask and shift
+        uint32_t word = readUInt24(payload + INPUT_BUTTONS);
+        state.dpad = static_cast<uint8_t>(word & DUALSENSE_DPAD_MASK);
+        state.buttons = (word >> DUALSENSE_BUTTON_SHIFT) & DUALSENSE_BUTTON_MASK;
+
+        state.gyroX = readInt16(payload + INPUT_GYRO);
+        state.gyroY = readInt16(payload + INPUT_GYRO + 2);
+        state.gyroZ = readInt16(payload + INPUT_GYRO + 4);
+        state.accelX = readInt16(payload + INPUT_ACCEL);
+        state.accelY = readInt16(payload + INPUT_ACCEL + 2);
+        state.accelZ = readInt16(payload + INPUT_ACCEL + 4);
+
+        state.sensorTimestamp = readUInt32(payload + INPUT_SENSOR_TIMESTAMP);
+
+        // Lifted contacts keep their last position, so decode both unconditionally
+        for (int i = 0; i < TOUCH_POINT_COUNT; i++) {
+            const uint8_t* contact = payload + INPUT_TOUCH + i * DUALSENSE_TOUCH_CONTACT_SIZE;
+            TouchPoint& point = state.touch[i];
+            point.active = (contact[0] & DUALSENSE_TOUCH_INACTIVE) == 0;
+            point.id = contact[0] & DUALSENSE_TOUCH_ID_MASK;
+            point.x = static_cast<int16_t>(((contact[2] & 0x0F) << 8) | contact[1]);
+            point.y = static_cast<int16_t>((contact[3] << 4) | ((contact[2] & 0xF0) >> 4));
+        }
+    }
+
+    void encodePayload(const ControllerState& state, uint8_t* payload) {
+        uint8_t* axes = payload + INPUT_STICKS;
+        axes[0] = state.leftStickX;
+        axes[1] = state.leftStickY;
+        axes[2] = state.rightStickX;
+        axes[3] = state.rightStickY;
+        axes[4] = state.leftTrigger;
+        axes[5] = state.rightTrigger;
+
+        uint32_t word = (state.dpad & DUALSENSE_DPAD_MASK) |
+                        ((state.buttons & DUALSENSE_BUTTON_MASK) << DUALSENSE_BUTTON_SHIFT);
+        payload[INPUT_BUTTONS] = static_cast<uint8_t>(word & 0xFF);
+        payload[INPUT_BUTTONS + 1] = static_cast<uint8_t>((word >> 8) & 0xFF);
+        payload[INPUT_BUTTONS + 2] = static_cast<uint8_t>((word >> 16) & 0xFF);
+
+        putInt16(payload + INPUT_GYRO, state.gyroX);
+        putInt16(payload + INPUT_GYRO + 2, state.gyroY);
+        putInt16(payload + INPUT_GYRO + 4, state.gyroZ);
+        putInt16(payload + INPUT_ACCEL, state.accelX);
+        putInt16(payload + INPUT_ACCEL + 2, state.accelY);
+        putInt16(payload + INPUT_ACCEL + 4, state.accelZ);
+
+        putUInt32(payload + INPUT_SENSOR_TIMESTAMP, state.sensorTimestamp);
+
+        for (int i = 0; i < TOUCH_POINT_COUNT; i++) {
+            uint8_t* contact = payload + INPUT_TOUCH + i * DUALSENSE_TOUCH_CONTACT_SIZE;
+            const TouchPoint& point = state.touch[i];
+            contact[0] = static_cast<uint8_t>((point.id & DUALSENSE_TOUCH_ID_MASK) |
+                                              (point.active ? 0 : DUALSENSE_TOUCH_INACTIVE));
+            contact[1] = static_cast<uint8_t>(point.x & 0xFF);
+            contact[2] = static_cast<uint8_t>(((point.x >> 8) & 0x0F) | ((point.y & 0x0F) << 4));
+            contact[3] = static_cast<uint8_t>((point.y >> 4) & 0xFF);
+        }
+    }
+
+    // Offsets within the common output payload
+    constexpr size_t OUTPUT_VALID_FLAG0 = 0;
+    constexpr size_t OUTPUT_VALID_FLAG1 = 1;
+    constexpr size_t OUTPUT_MOTOR_RIGHT = 2;
+    constexpr size_t OUTPUT_MOTOR_LEFT = 3;
+    constexpr size_t OUTPUT_RIGHT_TRIGGER = 10; // Mode, then DUALSENSE_TRIGGER_PARAM_COUNT bytes
+    constexpr size_t OUTPUT_LEFT_TRIGGER = 21;
+    constexpr size_t OUTPUT_PLAYER_LEDS = 43;
+    constexpr size_t OUTPUT_LIGHTBAR = 44;      // R, G, B
+
+    constexpr uint8_t OUTPUT_FLAG0_RUMBLE = 0x01 | 0x02;   // Compatible vibration, haptics select
+    constexpr uint8_t OUTPUT_FLAG0_RIGHT_TRIGGER = 0x04;
+    constexpr uint8_t OUTPUT_FLAG0_LEFT_TRIGGER = 0x08;
+    constexpr uint8_t OUTPUT_FLAG1_LIGHTBAR = 0x04;
+    constexpr uint8_t OUTPUT_FLAG1_PLAYER_LEDS = 0x10;
+
+    // Offsets within the calibration feature report (int16 LE each)
+    constexpr size_t CALIBRATION_GYRO_BIAS = 1;         // X, Y, Z
+    constexpr size_t CALIBRATION_GYRO_RANGE = 7;        // Plus then minus, per axis
+    constexpr size_t CALIBRATION_GYRO_SPEED = 19;       // Plus, minus
+    constexpr size_t CALIBRATION_ACCEL_RANGE = 23;      // Plus then minus, per axis
+
+    void putTriggerEffect(uint8_t* dst, const DualSenseTriggerEffect& effect) {
+        dst[0] = effect.mode;
+        std::memcpy(dst + 1, effect.params.data(), DUALSENSE_TRIGGER_PARAM_COUNT);
+    }
+
+    void readTriggerEffect(const uint8_t* src, DualSenseTriggerEffect& effect) {
+        effect.mode = src[0];
+        std::memcpy(effect.params.data(), src + 1, DUALSENSE_TRIGGER_PARAM_COUNT);
+    }
+
+    // Bluetooth header: report ID, sequence number in the high nibble, tag
+    constexpr size_t BT_OUTPUT_HEADER_SIZE = 3;
+    constexpr uint8_t BT_OUTPUT_TAG = 0x10;
+}
+
+uint32_t computeDualSenseBtCrc(uint8_t seed, const uint8_t* report, size_t length) {
+    uint32_t crc = crc32Update(0, &seed, 1);
+    return crc32Update(crc, report, length - DUALSENSE_BT_CRC_SIZE);
+}
+
+bool checkDualSenseBtCrc(uint8_t seed, const uint8_t* report, size_t length) {
+    if (length < DUALSENSE_BT_CRC_SIZE) {
+        return false;
+    }
+    return computeDualSenseBtCrc(seed, report, length) == readUInt32(report + length - DUALSENSE_BT_CRC_SIZE);
+}
+
+void writeDualSenseBtCrc(uint8_t seed, uint8_t* report, size_t length) {
+    putUInt32(report + length - DUALSENSE_BT_CRC_SIZE, computeDualSenseBtCrc(seed, report, length));
+}
+
+bool DualSenseReportValidator::accept(const uint8_t* data, size_t length) {
+    // Only full Bluetooth input reports carry a CRC; anything else is left
+    // for the parser to accept or reject
+    if (length >= DUALSENSE_BT_INPUT_REPORT_SIZE && data[0] == DUALSENSE_BT_INPUT_REPORT_ID &&
+        !checkDualSenseBtCrc(DUALSENSE_BT_INPUT_CRC_SEED, data, DUALSENSE_BT_INPUT_REPORT_SIZE)) {
+        m_crcFailures.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_accepted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+InputReportStats DualSenseReportValidator::getStats() const {
+    InputReportStats stats;
+    stats.accepted = m_accepted.load(std::memory_order_relaxed);
+    stats.crcFailures = m_crcFailures.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void DualSenseReportValidator::resetStats() {
+    m_accepted.store(0, std::memory_order_relaxed);
+    m_crcFailures.store(0, std::memory_order_relaxed);
+}
+
+double DeviceClock::advance(uint32_t timestamp) {
+    if (!m_hasLast) {
+        m_hasLast = true;
+        m_last = timestamp;
+        return -1.0;
+    }
+
+    // Unsigned subtraction gives the right step across a wrap-around
+    uint32_t step = timestamp - m_last;
+    m_last = timestamp;
+    m_ticks += step;
+
+    double seconds = static_cast<double>(step) * DUALSENSE_SENSOR_TICK_US * 1e-6;
+    if (step == 0 || seconds > MAX_STEP_SECONDS) {
+        return -1.0;
+    }
+    return seconds;
+}
+
+bool parseDualSenseReport(const uint8_t* data, size_t length, ControllerState& state) {
+    // Report ID determines USB vs Bluetooth
+    uint8_t reportId = length > 0 ? data[0] : 0;
+
+    if (reportId == DUALSENSE_USB_INPUT_REPORT_ID && length >= DUALSENSE_USB_INPUT_REPORT_SIZE) {
+        parsePayload(data + DUALSENSE_USB_PAYLOAD_OFFSET, state);
+        return true;
+    } else if (reportId == DUALSENSE_BT_INPUT_REPORT_ID && length >= DUALSENSE_BT_INPUT_REPORT_SIZE) {
+        parsePayload(data + DUALSENSE_BT_PAYLOAD_OFFSET, state);
+        return true;
+    }
+
+    return false;
+}
+
+size_t encodeDualSenseReport(const ControllerState& state, bool bluetooth, uint8_t* out, size_t capacity) {
+    size_t size = bluetooth ? DUALSENSE_BT_INPUT_REPORT_SIZE : DUALSENSE_USB_INPUT_REPORT_SIZE;
+    if (capacity < size) {
+        return 0;
+    }
+
+    std::memset(out, 0, size);
+    if (bluetooth) {
+        out[0] = DUALSENSE_BT_INPUT_REPORT_ID;
+        encodePayload(state, out + DUALSENSE_BT_PAYLOAD_OFFSET);
+        writeDualSenseBtCrc(DUALSENSE_BT_INPUT_CRC_SEED, out, size);
+    } else {
+        out[0] = DUALSENSE_USB_INPUT_REPORT_ID;
+        encodePayload(state, out + DUALSENSE_USB_PAYLOAD_OFFSET);
+    }
+    return size;
+}
+
+size_t encodeDualSenseOutputReport(const DualSenseOutputState& state, bool bluetooth, uint8_t sequence,
+                                   uint8_t* out, size_t capacity) {
+    size_t size = bluetooth ? DUALSENSE_BT_OUTPUT_REPORT_SIZE : DUALSENSE_USB_OUTPUT_REPORT_SIZE;
+    if (capacity < size) {
+        return 0;
+    }
+
+    std::memset(out, 0, size);
+    uint8_t* payload = out + 1;
+    if (bluetooth) {
+        out[0] = DUALSENSE_BT_OUTPUT_REPORT_ID;
+        out[1] = static_cast<uint8_t>((sequence & 0x0F) << 4);
+        out[2] = BT_OUTPUT_TAG;
+        payload = out + BT_OUTPUT_HEADER_SIZE;
+    } else {
+        out[0] = DUALSENSE_USB_OUTPUT_REPORT_ID;
+    }
+
+    // Every report carries the complete output state, so all parts are flagged valid
+    payload[OUTPUT_VALID_FLAG0] = OUTPUT_FLAG0_RUMBLE | OUTPUT_FLAG0_RIGHT_TRIGGER | OUTPUT_FLAG0_LEFT_TRIGGER;
+    payload[OUTPUT_VALID_FLAG1] = OUTPUT_FLAG1_LIGHTBAR | OUTPUT_FLAG1_PLAYER_LEDS;
+    payload[OUTPUT_MOTOR_RIGHT] = state.rumbleRight;
+    payload[OUTPUT_MOTOR_LEFT] = state.rumbleLeft;
+    putTriggerEffect(payload + OUTPUT_RIGHT_TRIGGER, state.rightTrigger);
+    putTriggerEffect(payload + OUTPUT_LEFT_TRIGGER, state.leftTrigger);
+    payload[OUTPUT_PLAYER_LEDS] = state.playerLED;
+    payload[OUTPUT_LIGHTBAR] = state.ledR;
+    payload[OUTPUT_LIGHTBAR + 1] = state.ledG;
+    payload[OUTPUT_LIGHTBAR + 2] = state.ledB;
+
+    if (bluetooth) {
+        writeDualSenseBtCrc(DUALSENSE_BT_OUTPUT_CRC_SEED, out, size);
+    }
+    return size;
+}
+
+bool decodeDualSenseOutputReport(const uint8_t* data, size_t length, DualSenseOutputState& state) {
+    const uint8_t* payload = nullptr;
+    if (length >= DUALSENSE_BT_OUTPUT_REPORT_SIZE && data[0] == DUALSENSE_BT_OUTPUT_REPORT_ID) {
+        if (!checkDualSenseBtCrc(DUALSENSE_BT_OUTPUT_CRC_SEED, data, DUALSENSE_BT_OUTPUT_REPORT_SIZE)) {
+            return false;
+        }
+        payload = data + BT_OUTPUT_HEADER_SIZE;
+    } else if (length >= DUALSENSE_USB_OUTPUT_REPORT_SIZE && data[0] == DUALSENSE_USB_OUTPUT_REPORT_ID) {
+        payload = data + 1;
+    } else {
+        return false;
+    }
+
+    state.rumbleRight = payload[OUTPUT_MOTOR_RIGHT];
+    state.rumbleLeft = payload[OUTPUT_MOTOR_LEFT];
+    readTriggerEffect(payload + OUTPUT_RIGHT_TRIGGER, state.rightTrigger);
+    readTriggerEffect(payload + OUTPUT_LEFT_TRIGGER, state.leftTrigger);
+    state.playerLED = payload[OUTPUT_PLAYER_LEDS];
+    state.ledR = payload[OUTPUT_LIGHTBAR];
+    state.ledG = payload[OUTPUT_LIGHTBAR + 1];
+    state.ledB = payload[OUTPUT_LIGHTBAR + 2];
+    return true;
+}
+
+bool computeDualSenseCalibration(const DualSenseCalibrationData& data, DualSenseCalibration& calibration) {
+    DualSenseCalibration result;
+    result.factory = true;
+
+    // The plus/minus readings are taken relative to the bias, so their spread
+    // around it covers the sum of both reference rates
+    float speed = static_cast<float>(data.gyroSpeedPlus) + static_cast<float>(data.gyroSpeedMinus);
+    for (int axis = 0; axis < 3; axis++) {
+        float bias = data.gyroBias[axis];
+        float spread = std::abs(data.gyroPlus[axis] - bias) + std::abs(data.gyroMinus[axis] - bias);
+        if (speed <= 0.0f || spread <= 0.0f) {
+            return false;
+        }
+        result.gyroScale[axis] = speed / spread;
+        result.gyroOffset[axis] = -bias * result.gyroScale[axis];
+    }
+
+    // +1 g and -1 g readings: their midpoint is the bias, their span is 2 g
+    for (int axis = 0; axis < 3; axis++) {
+        float span = static_cast<float>(data.accelPlus[axis]) - static_cast<float>(data.accelMinus[axis]);
+        if (span <= 0.0f) {
+            return false;
+        }
+        float bias = data.accelPlus[axis] - span / 2.0f;
+        result.accelScale[axis] = 2.0f / span;
+        result.accelOffset[axis] = -bias * result.accelScale[axis];
+    }
+
+    calibration = result;
+    return true;
+}
+
+bool parseDualSenseCalibrationReport(const uint8_t* data, size_t length, bool bluetooth,
+                                     DualSenseCalibration& calibration) {
+    if (length < DUALSENSE_CALIBRATION_REPORT_SIZE || data[0] != DUALSENSE_CALIBRATION_REPORT_ID) {
+        return false;
+    }
+    if (bluetooth &&
+        !checkDualSenseBtCrc(DUALSENSE_BT_FEATURE_CRC_SEED, data, DUALSENSE_CALIBRATION_REPORT_SIZE)) {
+        return false;
+    }
+
+    DualSenseCalibrationData raw;
+    for (int axis = 0; axis < 3; axis++) {
+        raw.gyroBias[axis] = readInt16(data + CALIBRATION_GYRO_BIAS + axis * 2);
+        raw.gyroPlus[axis] = readInt16(data + CALIBRATION_GYRO_RANGE + axis * 4);
+        raw.gyroMinus[axis] = readInt16(data + CALIBRATION_GYRO_RANGE + axis * 4 + 2);
+        raw.accelPlus[axis] = readInt16(data + CALIBRATION_ACCEL_RANGE + axis * 4);
+        raw.accelMinus[axis] = readInt16(data + CALIBRATION_ACCEL_RANGE + axis * 4 + 2);
+    }
+    raw.gyroSpeedPlus = readInt16(data + CALIBRATION_GYRO_SPEED);
+    raw.gyroSpeedMinus = readInt16(data + CALIBRATION_GYRO_SPEED + 2);
+    return computeDualSenseCalibration(raw, calibration);
+}
+
+size_t encodeDualSenseCalibrationReport(const DualSenseCalibrationData& data, bool bluetooth,
+                                        uint8_t* out, size_t capacity) {
+    if (capacity < DUALSENSE_CALIBRATION_REPORT_SIZE) {
+        return 0;
+    }
+    std::memset(out, 0, DUALSENSE_CALIBRATION_REPORT_SIZE);
+    out[0] = DUALSENSE_CALIBRATION_REPORT_ID;
+    for (int axis = 0; axis < 3; axis++) {
+        putInt16(out + CALIBRATION_GYRO_BIAS + axis * 2, data.gyroBias[axis]);
+        putInt16(out + CALIBRATION_GYRO_RANGE + axis * 4, data.gyroPlus[axis]);
+        putInt16(out + CALIBRATION_GYRO_RANGE + axis * 4 + 2, data.gyroMinus[axis]);
+        putInt16(out + CALIBRATION_ACCEL_RANGE + axis * 4, data.accelPlus[axis]);
+        putInt16(out + CALIBRATION_ACCEL_RANGE + axis * 4 + 2, data.accelMinus[axis]);
+    }
+    putInt16(out + CALIBRATION_GYRO_SPEED, data.gyroSpeedPlus);
+    putInt16(out + CALIBRATION_GYRO_SPEED + 2, data.gyroSpeedMinus);
+
+    if (bluetooth) {
+        writeDualSenseBtCrc(DUALSENSE_BT_FEATURE_CRC_SEED, out, DUALSENSE_CALIBRATION_REPORT_SIZE);
+    }
+    return DUALSENSE_CALIBRATION_REPORT_SIZE;
+}
+
+NormalizedState normalizeControllerState(const ControllerState& state, const DualSenseCalibration& calibration) {
+    NormalizedState norm;
+
+    // Normalize sticks to -1.0 to 1.0
+    norm.leftStickX = normalizeStick(state.leftStickX);
+    norm.leftStickY = normalizeStick(state.leftStickY);
+    norm.rightStickX = normalizeStick(state.rightStickX);
+    norm.rightStickY = normalizeStick(state.rightStickY);
+
+    // Normalize triggers to 0.0 to 1.0
+    norm.leftTrigger = normalizeTrigger(state.leftTrigger);
+    norm.rightTrigger = normalizeTrigger(state.rightTrigger);
+
+    // Copy buttons
+    norm.buttons = state.buttons;
+    norm.dpad = state.dpad;
+
+    // Gyro in deg/s and accelerometer in g
+    const DualSenseCalibration& cal = calibration;
+    norm.gyroX = static_cast<float>(state.gyroX) * cal.gyroScale[0] + cal.gyroOffset[0];
+    norm.gyroY = static_cast<float>(state.gyroY) * cal.gyroScale[1] + cal.gyroOffset[1];
+    norm.gyroZ = static_cast<float>(state.gyroZ) * cal.gyroScale[2] + cal.gyroOffset[2];
+    norm.accelX = static_cast<float>(state.accelX) * cal.accelScale[0] + cal.accelOffset[0];
+    norm.accelY = static_cast<float>(state.accelY) * cal.accelScale[1] + cal.accelOffset[1];
+    norm.accelZ = static_cast<float>(state.accelZ) * cal.accelScale[2] + cal.accelOffset[2];
+
+    return norm;
+}
@@ -10,6 +10,23 @@
 #include <fstream>
 #include <sstream>
 
+namespace {
+    // The further pads (controllerCount > 1) take the same script and
+    // pipeline changes as the one the GUI shows
+    template <typename Apply>
+    void forEachExtraPad(Apply apply) {
+        PipelinePool& extraPads = Application::getInstance()->getExtraPads();
+        for (size_t i = 0; i < extraPads.size(); i++) {
+            apply(extraPads.get(i));
+        }
+    }
+
+    void rescanAllScripts(InputProcessor& processor) {
+        processor.getScriptManager().rescanScripts();
+        forEachExtraPad([](InputProcessor& pad) { pad.getScriptManager().rescanScripts(); });
+    }
+}
+
 GUI::GUI() {
 }
 
@@ -208,6 +225,18 @@ void GUI::render(InputProcessor& processor) {
             if (ImGui::MenuItem("Settings", "Ctrl+,")) {
                 m_showSettings = true;
             }
+            if (ImGui::MenuItem("Export Latency Stats")) {
+                // Writes latency_stats.csv and latency_stats.json next to config.json
+                std::vector<LatencyReportEntry> report = processor.getLatencyReport();
+                std::ofstream csv("latency_stats.csv");
+                if (csv.is_open()) {
+                    writeLatencyCsv(csv, report);
+                }
+                std::ofstream json("latency_stats.json");
+                if (json.is_open()) {
+                    writeLatencyJson(json, report);
+                }
+            }
             ImGui::Separator();
             if (ImGui::MenuItem("Exit", "Alt+F4")) {
                 m_shouldClose = true;
@@ -216,7 +245,7 @@ void GUI::render(InputProcessor& processor) {
         }
         if (ImGui::BeginMenu("Scripts")) {
             if (ImGui::MenuItem("Refresh Scripts", "F5")) {
-                processor.getScriptManager().rescanScripts();
+                rescanAllScripts(processor);
             }
             if (ImGui::MenuItem("Open Scripts Folder")) {
                 std::string folder = processor.getScriptManager().getScriptsFolder();
@@ -306,6 +335,40 @@ void GUI::renderStatusBar(InputProcessor& processor) {
     ImGui::SameLine(0, 4);
     ImGui::Text(running ? "Processing" : "Paused");
 
+    ImGui::SameLine(0, 20);
+    ImGui::TextColored(ImVec4(0.5f, 0.5f, 0.55f, 1.0f), "|");
+    ImGui::SameLine(0, 20);
+
+    // Wake-to-output latency percentiles, per-stage breakdown on hover
+    LatencyHistogram::Summary frame = processor.getStageHistogram(PipelineStage::Frame).summarize();
+    if (frame.count > 0) {
+        ImGui::Text("Latency p50 %.0f / p99 %.0f / p99.9 %.0f / max %.0f us",
+                    frame.p50Ns / 1000.0, frame.p99Ns / 1000.0, frame.p999Ns / 1000.0, frame.maxNs / 1000.0);
+    } else {
+        ImGui::TextDisabled("Latency: no samples");
+    }
+    if (ImGui::IsItemHovered()) {
+        ImGui::BeginTooltip();
+        if (ImGui::BeginTable("LatencyStages", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+            ImGui::TableSetupColumn("Stage");
+            ImGui::TableSetupColumn("p50 us");
+            ImGui::TableSetupColumn("p99 us");
+            ImGui::TableSetupColumn("p99.9 us");
+            ImGui::TableSetupColumn("max us");
+            ImGui::TableHeadersRow();
+            for (const auto& entry : processor.getLatencyReport()) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn(); ImGui::Text("%s", entry.name.c_str());
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", entry.summary.p50Ns / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", entry.summary.p99Ns / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", entry.summary.p999Ns / 1000.0);
+                ImGui::TableNextColumn(); ImGui::Text("%.1f", entry.summary.maxNs / 1000.0);
+            }
+            ImGui::EndTable();
+        }
+        ImGui::EndTooltip();
+    }
+
     // Controls on right side
     ImGui::SameLine(ImGui::GetWindowWidth() - 180);
     if (running) {
@@ -320,6 +383,7 @@ void GUI::renderStatusBar(InputProcessor& processor) {
     ImGui::SameLine();
     if (ImGui::Button("Reconnect", ImVec2(80, 0))) {
         processor.reconnectDualSense();
+        forEachExtraPad([](InputProcessor& pad) { pad.reconnectDualSense(); });
     }
 
     ImGui::End();
@@ -338,8 +402,10 @@ void GUI::renderControllerView(InputProcessor& processor) {
 
     ImGui::Begin("Controller Preview", nullptr, ImGuiWindowFlags_NoCollapse | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoResize);
 
-    const NormalizedState& input = processor.getInputState();
-    const NormalizedState& output = processor.getOutputState();
+    // Take one consistent copy of the frame; the processing thread keeps running
+    const FrameSnapshot frame = processor.getSnapshot();
+    const NormalizedState& input = frame.input;
+    const NormalizedState& output = frame.output;
 
     // Tabs for Input/Output comparison
     if (ImGui::BeginTabBar("ControllerTabs")) {
@@ -405,22 +471,22 @@ void GUI::renderControllerView(InputProcessor& processor) {
             ImGui::Spacing();
 
             // Face buttons
-            ImGui::TextColored(output.cross ? ImVec4(0.3f, 0.8f, 0.4f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "X");
+            ImGui::TextColored(output.button(BUTTON_CROSS) ? ImVec4(0.3f, 0.8f, 0.4f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "X");
             ImGui::SameLine(0, 8);
-            ImGui::TextColored(output.circle ? ImVec4(1.0f, 0.4f, 0.4f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "O");
+            ImGui::TextColored(output.button(BUTTON_CIRCLE) ? ImVec4(1.0f, 0.4f, 0.4f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "O");
             ImGui::SameLine(0, 8);
-            ImGui::TextColored(output.square ? ImVec4(0.8f, 0.4f, 0.8f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "[]");
+            ImGui::TextColored(output.button(BUTTON_SQUARE) ? ImVec4(0.8f, 0.4f, 0.8f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "[]");
             ImGui::SameLine(0, 8);
-            ImGui::TextColored(output.triangle ? ImVec4(0.4f, 0.8f, 0.8f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "/\\");
+            ImGui::TextColored(output.button(BUTTON_TRIANGLE) ? ImVec4(0.4f, 0.8f, 0.8f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "/\\");
 
             ImGui::SameLine(0, 20);
-            ImGui::TextColored(output.l1 ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "L1");
+            ImGui::TextColored(output.button(BUTTON_L1) ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "L1");
             ImGui::SameLine(0, 8);
-            ImGui::TextColored(output.r1 ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "R1");
+            ImGui::TextColored(output.button(BUTTON_R1) ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "R1");
             ImGui::SameLine(0, 8);
-            ImGui::TextColored(output.l3 ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "L3");
+            ImGui::TextColored(output.button(BUTTON_L3) ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "L3");
             ImGui::SameLine(0, 8);
-            ImGui::TextColored(output.r3 ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "R3");
+            ImGui::TextColored(output.button(BUTTON_R3) ? ImVec4(1.0f, 1.0f, 1.0f, 1.0f) : ImVec4(0.35f, 0.35f, 0.40f, 1.0f), "R3");
 
             ImGui::EndTabItem();
         }
@@ -491,7 +557,7 @@ void GUI::renderScriptList(InputProcessor& processor) {
                     if (profileNames[i] != currentProfile) {
                         config->switchProfile(profileNames[i]);
                         // Rescan scripts to apply new profile settings
-                        processor.getScriptManager().rescanScripts();
+                        rescanAllScripts(processor);
                     }
                 }
                 if (isSelected) {
@@ -557,7 +623,7 @@ void GUI::renderScriptList(InputProcessor& processor) {
                 if (strlen(m_newProfileName) > 0) {
                     if (config->createProfile(m_newProfileName)) {
                         config->switchProfile(m_newProfileName);
-                        processor.getScriptManager().rescanScripts();
+                        rescanAllScripts(processor);
                     }
                 }
                 ImGui::CloseCurrentPopup();
@@ -606,7 +672,7 @@ void GUI::renderScriptList(InputProcessor& processor) {
             ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.7f, 0.2f, 0.2f, 1.0f));
             if (ImGui::Button("Delete", ImVec2(90, 0))) {
                 config->deleteProfile(m_profileToDelete);
-                processor.getScriptManager().rescanScripts();
+                rescanAllScripts(processor);
                 ImGui::CloseCurrentPopup();
             }
             ImGui::PopStyleColor();
@@ -844,14 +910,14 @@ void GUI::renderScriptList(InputProcessor& processor) {
         }
         ImGui::SameLine();
         if (ImGui::Button("Refresh")) {
-            processor.getScriptManager().rescanScripts();
+            rescanAllScripts(processor);
         }
     } else {
         // Header row
         ImGui::Text("%zu script(s) loaded", scripts.size());
         ImGui::SameLine(ImGui::GetWindowWidth() - 150);
         if (ImGui::Button("Refresh All")) {
-            processor.getScriptManager().rescanScripts();
+            rescanAllScripts(processor);
         }
         ImGui::Separator();
         ImGui::Spacing();
@@ -872,6 +938,9 @@ void GUI::renderScriptList(InputProcessor& processor) {
             }
             if (ImGui::Checkbox("##enabled", &enabled)) {
                 processor.getScriptManager().setScriptEnabled(script.config.name, enabled);
+                forEachExtraPad([&](InputProcessor& pad) {
+                    pad.getScriptManager().setScriptEnabled(script.config.name, enabled);
+                });
             }
             ImGui::PopStyleColor();
             ImGui::SameLine();
@@ -922,6 +991,7 @@ void GUI::renderScriptList(InputProcessor& processor) {
             if (i > 0) {
                 if (ImGui::Button("^", ImVec2(24, 20))) {
                     processor.getScriptManager().moveScriptUp(i);
+                    forEachExtraPad([i](InputProcessor& pad) { pad.getScriptManager().moveScriptUp(i); });
                 }
             } else {
                 ImGui::Dummy(ImVec2(24, 20));
@@ -930,6 +1000,7 @@ void GUI::renderScriptList(InputProcessor& processor) {
             if (i < scripts.size() - 1) {
                 if (ImGui::Button("v", ImVec2(24, 20))) {
                     processor.getScriptManager().moveScriptDown(i);
+                    forEachExtraPad([i](InputProcessor& pad) { pad.getScriptManager().moveScriptDown(i); });
                 }
             } else {
                 ImGui::Dummy(ImVec2(24, 20));
@@ -1032,6 +1103,9 @@ void GUI::renderScriptList(InputProcessor& processor) {
                         if (valueChanged) {
                             param.value = newValue;
                             processor.getScriptManager().setScriptParameter(script.config.name, param.key, newValue);
+                            forEachExtraPad([&](InputProcessor& pad) {
+                                pad.getScriptManager().setScriptParameter(script.config.name, param.key, newValue);
+                            });
                         }
 
                         ImGui::PopID();
@@ -1043,6 +1117,10 @@ void GUI::renderScriptList(InputProcessor& processor) {
                         for (auto& param : script.config.parameters) {
                             param.value = param.defaultValue;
                             processor.getScriptManager().setScriptParameter(script.config.name, param.key, param.defaultValue);
+                            forEachExtraPad([&](InputProcessor& pad) {
+                                pad.getScriptManager().setScriptParameter(script.config.name, param.key,
+                                                                          param.defaultValue);
+                            });
                         }
                     }
                 }
@@ -1093,12 +1171,379 @@ void GUI::renderSettings(InputProcessor& processor) {
         ImGui::Text("Poll Rate");
         ImGui::SameLine(120);
         ImGui::SetNextItemWidth(-1);
-        if (ImGui::SliderFloat("##PollRate", &m_pollRate, 100.0f, 1000.0f, "%.0f Hz")) {
+        m_pollRate = processor.getPollRate();
+        if (ImGui::SliderFloat("##PollRate", &m_pollRate, 100.0f, 8000.0f, "%.0f Hz", ImGuiSliderFlags_Logarithmic)) {
             processor.setPollRate(m_pollRate);
+            Application::getInstance()->getExtraPads().setPollRate(m_pollRate);
+            if (ConfigManager* config = processor.getConfigManager()) {
+                config->getSettings().pollRate = m_pollRate;
+                config->markDirty();
+            }
         }
         ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.5f, 0.55f, 1.0f));
         ImGui::TextWrapped("Higher values mean lower latency but more CPU usage.");
         ImGui::PopStyleColor();
+
+        ImGui::Text("Input Mode");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        const char* inputModes[] = { "Periodic (poll rate)", "Event-driven" };
+        int currentMode = static_cast<int>(processor.getInputMode());
+        if (ImGui::Combo("##InputMode", &currentMode, inputModes, 2)) {
+            processor.setInputMode(static_cast<InputMode>(currentMode));
+            Application::getInstance()->getExtraPads().setInputMode(static_cast<InputMode>(currentMode));
+            if (ConfigManager* config = processor.getConfigManager()) {
+                config->getSettings().inputMode = static_cast<InputMode>(currentMode);
+                config->markDirty();
+            }
+        }
+
+        ImGui::Text("Backlog");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        const char* backlogPolicies[] = { "Latest only (lowest latency)", "Replay all (exact timing)" };
+        int currentPolicy = static_cast<int>(processor.getBacklogPolicy());
+        if (ImGui::Combo("##BacklogPolicy", &currentPolicy, backlogPolicies, 2)) {
+            processor.setBacklogPolicy(static_cast<BacklogPolicy>(currentPolicy));
+            forEachExtraPad([&](InputProcessor& pad) {
+                pad.setBacklogPolicy(static_cast<BacklogPolicy>(currentPolicy));
+            });
+            if (ConfigManager* config = processor.getConfigManager()) {
+                config->getSettings().backlogPolicy = static_cast<BacklogPolicy>(currentPolicy);
+                config->markDirty();
+            }
+        }
+
+        ImGui::Text("Delta Time");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        const char* dtSources[] = { "Host clock", "Controller clock" };
+        int currentSource = static_cast<int>(processor.getDeltaTimeSource());
+        if (ImGui::Combo("##DeltaTimeSource", &currentSource, dtSources, 2)) {
+            processor.setDeltaTimeSource(static_cast<DeltaTimeSource>(currentSource));
+            forEachExtraPad([&](InputProcessor& pad) {
+                pad.setDeltaTimeSource(static_cast<DeltaTimeSource>(currentSource));
+            });
+            if (ConfigManager* config = processor.getConfigManager()) {
+                config->getSettings().deltaTimeSource = static_cast<DeltaTimeSource>(currentSource);
+                config->markDirty();
+            }
+        }
+
+        ImGui::Text("Spin Window");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        int spinUs = processor.getPacingSpinWindow();
+        if (ImGui::SliderInt("##SpinWindow", &spinUs, 0, 2000, "%d us")) {
+            processor.setPacingSpinWindow(spinUs);
+            Application::getInstance()->getExtraPads().setPacingSpinWindow(spinUs);
+            if (ConfigManager* config = processor.getConfigManager()) {
+                config->getSettings().pacingSpinUs = spinUs;
+                config->markDirty();
+            }
+        }
+
+        if (processor.getInputMode() == InputMode::Periodic) {
+            PacingStats pacing = processor.getPacingStats();
+            ImGui::Text("Pacing");
+            ImGui::SameLine(120);
+            if (pacing.ticks > 0) {
+                ImGui::Text("%.0f / %.0f Hz, jitter p99 %.0f us", pacing.achievedHz, pacing.targetHz,
+                            pacing.lateness.p99Ns / 1000.0);
+                if (ImGui::IsItemHovered()) {
+                    ImGui::SetTooltip("Wake lateness p50 %.1f / p99 %.1f / max %.1f us\nMissed deadlines: %llu",
+                                      pacing.lateness.p50Ns / 1000.0, pacing.lateness.p99Ns / 1000.0,
+                                      pacing.lateness.maxNs / 1000.0,
+                                      static_cast<unsigned long long>(pacing.missedTicks));
+                }
+            } else {
+                ImGui::TextDisabled("no samples");
+            }
+            ImGui::SameLine();
+            if (ImGui::SmallButton("Reset##Pacing")) {
+                processor.resetPacingStats();
+            }
+        }
+
+        ImGui::Text("Keepalive");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        int keepaliveMs = processor.getOutputKeepalive();
+        if (ImGui::SliderInt("##Keepalive", &keepaliveMs, 0, 1000, keepaliveMs > 0 ? "%d ms" : "off")) {
+            processor.setOutputKeepalive(keepaliveMs);
+            forEachExtraPad([&](InputProcessor& pad) { pad.setOutputKeepalive(keepaliveMs); });
+            if (ConfigManager* config = processor.getConfigManager()) {
+                config->getSettings().outputKeepaliveMs = keepaliveMs;
+                config->markDirty();
+            }
+        }
+
+        if (ConfigManager* config = processor.getConfigManager()) {
+            ImGui::Text("Controllers");
+            ImGui::SameLine(120);
+            ImGui::SetNextItemWidth(-1);
+            int controllers = config->getSettings().controllerCount;
+            if (ImGui::SliderInt("##Controllers", &controllers, 1, MAX_CONTROLLERS, "%d pads")) {
+                config->getSettings().controllerCount = controllers;
+                config->markDirty();
+            }
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Each pad gets its own virtual controller and script chain.\n"
+                                  "Takes effect on restart; this window shows the first pad.");
+            }
+        }
+
+        OutputSubmitStats submits = processor.getSubmitStats();
+        ImGui::Text("Submitted");
+        ImGui::SameLine(120);
+        uint64_t totalFrames = submits.submitted + submits.suppressed;
+        ImGui::Text("%llu / %llu frames (%.0f%% suppressed)",
+                    static_cast<unsigned long long>(submits.submitted),
+                    static_cast<unsigned long long>(totalFrames),
+                    totalFrames > 0 ? 100.0 * submits.suppressed / totalFrames : 0.0);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##Submits")) {
+            processor.resetSubmitStats();
+        }
+
+        InputReportStats inputReports = processor.getInputReportStats();
+        ImGui::Text("CRC Errors");
+        ImGui::SameLine(120);
+        ImGui::Text("%llu of %llu input reports dropped",
+                    static_cast<unsigned long long>(inputReports.crcFailures),
+                    static_cast<unsigned long long>(inputReports.accepted + inputReports.crcFailures));
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Bluetooth reports whose CRC did not match are discarded");
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##InputReports")) {
+            processor.resetInputReportStats();
+        }
+
+        ImGui::Text("Motion");
+        ImGui::SameLine(120);
+        ImGui::Text("%s", processor.hasFactoryCalibration() ? "Factory calibration" : "Nominal ranges");
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Gyro (deg/s) and accelerometer (g) scaling, read from the controller at connect");
+        }
+
+        HotplugStats hotplug = processor.getHotplugStats();
+        ImGui::Text("Discovery");
+        ImGui::SameLine(120);
+        ImGui::Text("%llu connects, %llu probes",
+                    static_cast<unsigned long long>(hotplug.connects),
+                    static_cast<unsigned long long>(hotplug.probes));
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Device enumerations by the background watcher (%llu arrival notifications)",
+                              static_cast<unsigned long long>(hotplug.arrivals));
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##Hotplug")) {
+            processor.resetHotplugStats();
+        }
+
+        OutputReportStats outputReports = processor.getOutputReportStats();
+        ImGui::Text("LED Reports");
+        ImGui::SameLine(120);
+        ImGui::Text("%llu sent, %llu changes coalesced",
+                    static_cast<unsigned long long>(outputReports.sent),
+                    static_cast<unsigned long long>(outputReports.coalesced));
+        if (ImGui::IsItemHovered() && outputReports.failed > 0) {
+            ImGui::SetTooltip("%llu writes failed and were retried", static_cast<unsigned long long>(outputReports.failed));
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##OutputReports")) {
+            processor.resetOutputReportStats();
+        }
+
+        BacklogStats backlog = processor.getBacklogStats();
+        ImGui::Text("Queue Depth");
+        ImGui::SameLine(120);
+        if (backlog.wakes > 0) {
+            ImGui::Text("avg %.2f / max %u reports, %llu backlogged wakes", backlog.meanDepth, backlog.maxDepth,
+                        static_cast<unsigned long long>(backlog.backloggedWakes));
+            if (ImGui::IsItemHovered() && backlog.policy == BacklogPolicy::LatestOnly) {
+                ImGui::SetTooltip("%llu stale reports skipped", static_cast<unsigned long long>(backlog.coalesced));
+            }
+        } else {
+            ImGui::TextDisabled("no samples");
+        }
+
+        DeltaTimeStats dt = processor.getDeltaTimeStats();
+        ImGui::Text("dt Jitter");
+        ImGui::SameLine(120);
+        if (dt.samples > 1) {
+            ImGui::Text("host %.1f us / controller %.1f us (std dev)", dt.hostStdDevUs, dt.deviceStdDevUs);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Mean dt: host %.1f us, controller %.1f us\nFell back to host time: %llu",
+                                  dt.hostMeanUs, dt.deviceMeanUs, static_cast<unsigned long long>(dt.fallbacks));
+            }
+        } else {
+            ImGui::TextDisabled("no samples");
+        }
+
+        LatencyStats latency = processor.getLatencyStats();
+        ImGui::Text("Latency");
+        ImGui::SameLine(120);
+        if (latency.samples > 0) {
+            ImGui::Text("avg %.0f us / max %.0f us", latency.averageUs, latency.maxUs);
+        } else {
+            ImGui::TextDisabled("no samples");
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Reset##Latency")) {
+            processor.resetLatencyStats();
+        }
+
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.5f, 0.55f, 1.0f));
+        ImGui::TextWrapped("Event-driven wakes as soon as the controller sends a report. "
+                           "Periodic mode sleeps to fixed deadlines and spins the last part of each "
+                           "wait; a larger spin window lowers jitter at the cost of CPU. "
+                           "Reports that queued up during a slow frame are either skipped "
+                           "(latest only) or all run through the scripts (replay all). "
+                           "The controller clock gives scripts a delta time free of PC "
+                           "scheduling jitter. "
+                           "Unchanged frames are not resent to the virtual controller except "
+                           "once per keepalive interval. "
+                           "Latency is measured from report read to virtual controller update.");
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+
+    if (ImGui::CollapsingHeader("Processing Thread")) {
+        ThreadTuning tuning = processor.getThreadTuning();
+        bool tuningChanged = false;
+
+        ImGui::Text("Priority");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        const char* priorities[] = { "Normal", "High", "Games (MMCSS)", "Pro Audio (MMCSS)" };
+        int currentPriority = static_cast<int>(tuning.priority);
+        if (ImGui::Combo("##ThreadPriority", &currentPriority, priorities, 4)) {
+            tuning.priority = static_cast<ThreadPriority>(currentPriority);
+            tuningChanged = true;
+        }
+
+        ImGui::Text("CPU Affinity");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        if (ImGui::InputScalar("##AffinityMask", ImGuiDataType_U64, &tuning.affinityMask, nullptr, nullptr, "%llX",
+                               ImGuiInputTextFlags_CharsHexadecimal | ImGuiInputTextFlags_EnterReturnsTrue)) {
+            tuningChanged = true;
+        }
+
+        ImGui::Text("Timer Res.");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        if (ImGui::SliderInt("##TimerResolution", &tuning.timerResolutionUs, 0, 2000,
+                             tuning.timerResolutionUs > 0 ? "%d us" : "default")) {
+            tuningChanged = true;
+        }
+
+        if (tuningChanged) {
+            processor.setThreadTuning(tuning);
+            Application::getInstance()->getExtraPads().setThreadTuning(tuning);
+            if (ConfigManager* config = processor.getConfigManager()) {
+                config->getSettings().threadTuning = tuning;
+                config->markDirty();
+            }
+        }
+
+        std::string status = processor.getThreadTuningStatus();
+        if (!status.empty()) {
+            ImGui::TextUnformatted(status.c_str());
+        }
+
+        PacingStats pacing = processor.getPacingStats();
+        ImGui::Text("Jitter");
+        ImGui::SameLine(120);
+        if (processor.getInputMode() == InputMode::Periodic && pacing.ticks > 0) {
+            ImGui::Text("p50 %.1f / p99 %.1f / max %.1f us", pacing.lateness.p50Ns / 1000.0,
+                        pacing.lateness.p99Ns / 1000.0, pacing.lateness.maxNs / 1000.0);
+        } else {
+            ImGui::TextDisabled("measured in periodic mode");
+        }
+
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.5f, 0.55f, 1.0f));
+        ImGui::TextWrapped("Games and Pro Audio register the thread with the Multimedia Class Scheduler "
+                           "so it keeps running while the game loads every core. Affinity is a hex CPU "
+                           "mask (0 = any CPU, press Enter to apply). Jitter is how late each periodic "
+                           "tick woke up.");
+        ImGui::PopStyleColor();
+    }
+
+    ImGui::Spacing();
+
+    if (ImGui::CollapsingHeader("Script Memory")) {
+        ScriptManager& scriptManager = processor.getScriptManager();
+        ConfigManager* config = processor.getConfigManager();
+
+        ImGui::Text("Heap Cap");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        int limitMB = static_cast<int>(scriptManager.getScriptMemoryLimit() / (1024 * 1024));
+        if (ImGui::SliderInt("##ScriptMemoryLimit", &limitMB, 0, 256, limitMB > 0 ? "%d MB" : "unlimited")) {
+            size_t bytes = static_cast<size_t>(limitMB) * 1024 * 1024;
+            scriptManager.setScriptMemoryLimit(bytes);
+            forEachExtraPad([&](InputProcessor& pad) { pad.getScriptManager().setScriptMemoryLimit(bytes); });
+            if (config) {
+                config->getSettings().scriptMemoryLimitMB = limitMB;
+                config->markDirty();
+            }
+        }
+
+        ImGui::Text("Collector");
+        ImGui::SameLine(120);
+        ImGui::SetNextItemWidth(-1);
+        const char* gcModes[] = { "Generational", "Incremental" };
+        int gcMode = static_cast<int>(scriptManager.getScriptGcMode());
+        if (ImGui::Combo("##ScriptGcMode", &gcMode, gcModes, 2)) {
+            scriptManager.setScriptGcMode(static_cast<ScriptGcMode>(gcMode));
+            forEachExtraPad([&](InputProcessor& pad) {
+                pad.getScriptManager().setScriptGcMode(static_cast<ScriptGcMode>(gcMode));
+            });
+            if (config) {
+                config->getSettings().scriptGcMode = static_cast<ScriptGcMode>(gcMode);
+                config->markDirty();
+            }
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Applies to scripts loaded from now on (Refresh All reloads them)");
+        }
+
+        for (const auto& script : scriptManager.getScripts()) {
+            if (!script.engine) {
+                continue;
+            }
+            ScriptMemoryStats memory = script.engine->getMemoryStats();
+            ImGui::Text("%s", script.config.name.c_str());
+            ImGui::SameLine(120);
+            ImGui::Text("%.0f KB, GC %.2f ms/s", memory.heapBytes / 1024.0, memory.gcMsPerSecond);
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("Peak %.0f KB, %.0f KB reserved from the system\n"
+                                  "%llu collector steps, longest %.1f us\n"
+                                  "Allocations refused by the cap: %llu",
+                                  memory.peakBytes / 1024.0, memory.reservedBytes / 1024.0,
+                                  static_cast<unsigned long long>(memory.gcSteps), memory.gcMaxNs / 1000.0,
+                                  static_cast<unsigned long long>(memory.failedAllocations));
+            }
+        }
+        if (ImGui::SmallButton("Reset##ScriptMemory")) {
+            for (auto& script : scriptManager.getScripts()) {
+                if (script.engine) {
+                    script.engine->resetMemoryStats();
+                }
+            }
+        }
+
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.5f, 0.55f, 1.0f));
+        ImGui::TextWrapped("Each script allocates from its own pool, capped at the heap cap; a script "
+                           "that hits the cap gets a \"not enough memory\" error instead of growing. "
+                           "The collector runs in small steps after the frames that allocated "
+                           "rather than whenever Lua decides; GC ms/s is the time those steps took over the "
+                           "last second.");
+        ImGui::PopStyleColor();
     }
 
     ImGui::Spacing();
@@ -1109,7 +1554,7 @@ void GUI::renderSettings(InputProcessor& processor) {
         ImGui::SameLine(120);
         ImGui::SetNextItemWidth(-1);
         if (ImGui::ColorEdit3("##LED", ledColor, ImGuiColorEditFlags_NoInputs)) {
-            processor.getDualSense().setLEDColor(
+            processor.getInputDevice().setLEDColor(
                 static_cast<uint8_t>(ledColor[0] * 255),
                 static_cast<uint8_t>(ledColor[1] * 255),
                 static_cast<uint8_t>(ledColor[2] * 255)
@@ -0,0 +1,166 @@
+#include "HotplugMonitor.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <cfgmgr32.h>
+
+namespace {
+    // GUID_DEVINTERFACE_HID, spelled out to avoid pulling in hidclass.h/initguid
+    const GUID HID_INTERFACE_CLASS = {0x4D1E55B2, 0xF16F, 0x11CF, {0x88, 0xCB, 0x00, 0x11, 0x11, 0x00, 0x00, 0x30}};
+
+    DWORD CALLBACK onDeviceNotification(HCMNOTIFICATION, PVOID context, CM_NOTIFY_ACTION action,
+                                        PCM_NOTIFY_EVENT_DATA, DWORD) {
+        if (action == CM_NOTIFY_ACTION_DEVICEINTERFACEARRIVAL) {
+            static_cast<HotplugMonitor*>(context)->poke();
+        }
+        return ERROR_SUCCESS;
+    }
+}
+#endif
+
+HotplugMonitor::~HotplugMonitor() {
+    stop();
+}
+
+void HotplugMonitor::start(ProbeFunction probe, bool connected) {
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_probe = std::move(probe);
+        m_stop = false;
+        m_searching = !connected;
+        m_ready = false;
+        m_poked = false;
+    }
+    m_thread = std::thread(&HotplugMonitor::run, this);
+    registerArrivalNotification();
+}
+
+void HotplugMonitor::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    // No notification may call poke() once we start tearing down
+    unregisterArrivalNotification();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    m_readyChanged.notify_all();
+    m_thread.join();
+}
+
+void HotplugMonitor::deviceLost() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_searching) {
+            return;
+        }
+        m_searching = true;
+    }
+    m_wake.notify_all();
+}
+
+bool HotplugMonitor::takeReady() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_ready) {
+        return false;
+    }
+    m_ready = false;
+    m_searching = false;
+    m_connects.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool HotplugMonitor::waitReady(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_readyChanged.wait_for(lock, timeout, [this] { return m_ready || m_stop; }) && m_ready;
+}
+
+void HotplugMonitor::poke() {
+    m_arrivals.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_poked = true;
+    }
+    m_wake.notify_all();
+}
+
+HotplugStats HotplugMonitor::getStats() const {
+    HotplugStats stats;
+    stats.probes = m_probes.load(std::memory_order_relaxed);
+    stats.arrivals = m_arrivals.load(std::memory_order_relaxed);
+    stats.connects = m_connects.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void HotplugMonitor::resetStats() {
+    m_probes = 0;
+    m_arrivals = 0;
+    m_connects = 0;
+}
+
+void HotplugMonitor::run() {
+    std::chrono::milliseconds retry = MIN_RETRY;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stop) {
+        // Nothing to do while connected or while a found device waits to be taken
+        m_wake.wait(lock, [this] { return m_stop || (m_searching && !m_ready); });
+        if (m_stop) {
+            break;
+        }
+        m_poked = false;
+
+        // Enumerating can take milliseconds; never hold the lock over it
+        lock.unlock();
+        bool found = m_probe();
+        m_probes.fetch_add(1, std::memory_order_relaxed);
+        lock.lock();
+
+        if (found) {
+            m_ready = true;
+            retry = MIN_RETRY;
+            m_readyChanged.notify_all();
+            continue;
+        }
+
+        // Back off, unless something arrives in the meantime
+        if (m_wake.wait_for(lock, retry, [this] { return m_stop || m_poked; })) {
+            retry = MIN_RETRY;
+        } else {
+            retry = std::min(retry * 2, MAX_RETRY);
+        }
+    }
+}
+
+#ifdef _WIN32
+
+void HotplugMonitor::registerArrivalNotification() {
+    CM_NOTIFY_FILTER filter = {};
+    filter.cbSize = sizeof(filter);
+    filter.FilterType = CM_NOTIFY_FILTER_TYPE_DEVICEINTERFACE;
+    filter.u.DeviceInterface.ClassGuid = HID_INTERFACE_CLASS;
+
+    HCMNOTIFICATION notification = nullptr;
+    if (CM_Register_Notification(&filter, this, onDeviceNotification, &notification) == CR_SUCCESS) {
+        m_notification = notification;
+    }
+}
+
+void HotplugMonitor::unregisterArrivalNotification() {
+    if (m_notification) {
+        CM_Unregister_Notification(static_cast<HCMNOTIFICATION>(m_notification));
+        m_notification = nullptr;
+    }
+}
+
+#else
+
+// No arrival notifications without libudev; the backoff alone bounds latency
+void HotplugMonitor::registerArrivalNotification() {}
+void HotplugMonitor::unregisterArrivalNotification() {}
+
+#endif
@@ -1,8 +1,38 @@
 #include "InputProcessor.h"
 #include "ConfigManager.h"
+#include <algorithm>
 #include <iostream>
 
-InputProcessor::InputProcessor() {
+namespace {
+    // Upper bound on how long an event-driven read blocks, so stop() and
+    // reconnects stay responsive while the controller is idle
+    constexpr int EVENT_WAIT_TIMEOUT_MS = 10;
+
+    // Longest sleep while no controller is attached; the hotplug watcher
+    // wakes the loop as soon as it has a device
+    constexpr auto DISCONNECTED_RETRY_INTERVAL = std::chrono::milliseconds(100);
+
+    void copyTouch(const TouchPoint (&touch)[TOUCH_POINT_COUNT], InputContext& context) {
+        std::copy(std::begin(touch), std::end(touch), std::begin(context.touch));
+    }
+}
+
+const char* getPipelineStageName(PipelineStage stage) {
+    switch (stage) {
+        case PipelineStage::Read:      return "Read";
+        case PipelineStage::Normalize: return "Normalize";
+        case PipelineStage::Gestures:  return "Gestures";
+        case PipelineStage::Motion:    return "Motion";
+        case PipelineStage::Scripts:   return "Scripts";
+        case PipelineStage::Output:    return "Output";
+        case PipelineStage::Frame:     return "Frame (wake-to-output)";
+        default:                       return "Unknown";
+    }
+}
+
+InputProcessor::InputProcessor(std::unique_ptr<IInputDevice> device, std::unique_ptr<IOutputSink> sink)
+    : m_device(std::move(device))
+    , m_sink(std::move(sink)) {
     m_lastUpdate = std::chrono::high_resolution_clock::now();
 }
 
@@ -10,45 +40,62 @@ InputProcessor::~InputProcessor() {
     stop();
 }
 
-bool InputProcessor::initialize(ConfigManager* config) {
+bool InputProcessor::initialize(ConfigManager* config, const std::string& scriptsFolder) {
     m_config = config;
 
+    if (config) {
+        m_pollRateHz = config->getSettings().pollRate;
+        m_inputMode = config->getSettings().inputMode;
+        m_pacingSpinUs = config->getSettings().pacingSpinUs;
+        m_outputKeepaliveMs = config->getSettings().outputKeepaliveMs;
+        m_backlogPolicy = config->getSettings().backlogPolicy;
+        m_deltaTimeSource = config->getSettings().deltaTimeSource;
+        setThreadTuning(config->getSettings().threadTuning);
+    }
+    m_sink->setKeepaliveInterval(std::chrono::milliseconds(m_outputKeepaliveMs.load()));
+
     // Initialize script manager with config for saved settings
-    if (!m_scriptManager.initialize("scripts", config)) {
+    if (!m_scriptManager.initialize(scriptsFolder, config)) {
         std::cerr << "Warning: Failed to initialize script manager" << std::endl;
     }
 
     // Try to connect to DualSense
-    if (!m_dualSense.connect()) {
-        std::cerr << "Warning: DualSense controller not found" << std::endl;
+    if (!m_device->connect()) {
+        std::cerr << "Warning: " << m_device->getName() << " controller not found" << std::endl;
     } else {
         // Set LED to indicate we're connected
-        m_dualSense.setLEDColor(0, 255, 128);  // Cyan-green
+        m_device->setLEDColor(0, 255, 128);  // Cyan-green
     }
 
     // Try to connect virtual controller
-    if (!m_virtual.connect()) {
-        std::cerr << "Error: Failed to connect virtual controller: " << m_virtual.getLastError() << std::endl;
+    if (!m_sink->connect()) {
+        std::cerr << "Error: Failed to connect virtual controller: " << m_sink->getLastError() << std::endl;
         return false;
     }
 
     return true;
 }
 
-bool InputProcessor::start() {
+bool InputProcessor::start(bool ownThread) {
     if (m_running) {
         return true;
     }
 
-    if (!m_virtual.isConnected()) {
-        if (!m_virtual.connect()) {
+    if (!m_sink->isConnected()) {
+        if (!m_sink->connect()) {
             return false;
         }
     }
 
+    // Discovery runs on its own thread while the loop is running
+    m_reconnectRequested = false;
+    m_hotplug.start([this] { return m_device->openPending(); }, m_device->isConnected());
+
     m_shouldStop = false;
     m_running = true;
-    m_thread = std::thread(&InputProcessor::processingLoop, this);
+    if (ownThread) {
+        m_thread = std::thread(&InputProcessor::processingLoop, this);
+    }
 
     return true;
 }
@@ -62,67 +109,356 @@ void InputProcessor::stop() {
     if (m_thread.joinable()) {
         m_thread.join();
     }
+    m_hotplug.stop();
     m_running = false;
 }
 
-bool InputProcessor::update() {
+bool InputProcessor::update(int timeoutMs) {
+    // Reconnect requested from the GUI: drop the device and search at once
+    if (m_reconnectRequested.exchange(false)) {
+        m_device->disconnect();
+        m_hotplug.deviceLost();
+        m_hotplug.poke();
+    }
+
+    // Try to reconnect DualSense if disconnected. While the loop runs the
+    // hotplug watcher does the enumeration and we only adopt what it found;
+    // callers driving update() directly still connect synchronously.
+    if (!m_device->isConnected()) {
+        bool connected = false;
+        if (m_hotplug.isRunning()) {
+            m_hotplug.deviceLost();
+            connected = m_hotplug.takeReady() && m_device->adoptPending();
+        } else {
+            connected = m_device->connect();
+        }
+
+        if (connected) {
+            // Don't hand the disconnected gap to scripts as one huge delta time
+            m_lastUpdate = std::chrono::high_resolution_clock::now();
+            m_deviceClock.reset();
+            m_gestures.reset();
+            m_motion.reset();
+            m_device->setLEDColor(0, 255, 128);
+        }
+    }
+
+    // Read from DualSense
+    auto readStart = std::chrono::steady_clock::now();
+    if (!m_device->update(timeoutMs)) {
+        return false;
+    }
+
+    // Host delta time is taken after the read so a blocking wait is attributed
+    // to the frame(s) it produced
     auto now = std::chrono::high_resolution_clock::now();
-    float deltaTime = std::chrono::duration<float>(now - m_lastUpdate).count();
+    float elapsed = std::chrono::duration<float>(now - m_lastUpdate).count();
     m_lastUpdate = now;
 
-    // Try to reconnect DualSense if disconnected
-    if (!m_dualSense.isConnected()) {
-        m_dualSense.connect();
+    auto wakeTime = std::chrono::steady_clock::now();
+    stageHistogram(PipelineStage::Read).record(wakeTime - readStart);
+
+    // Drain every report already queued behind the one that woke us, so a
+    // slow frame never leaves us working through stale input. Each report's
+    // device time step is kept for its delta time.
+    BacklogPolicy policy = m_backlogPolicy;
+    size_t depth = 0;
+    double deviceElapsed = 0.0;
+    bool deviceTimeValid = true;
+    do {
+        double step = m_deviceClock.advance(m_device->getState().sensorTimestamp);
+        deviceTimeValid = deviceTimeValid && step > 0.0;
+        deviceElapsed += step;
+        if (policy == BacklogPolicy::ReplayAll) {
+            m_backlog[depth] = m_device->getNormalizedState();
+            copyTouch(m_device->getState().touch, m_backlogContext[depth]);
+            m_backlogDeviceDt[depth] = static_cast<float>(step);
+        }
+        depth++;
+    } while (depth < MAX_BACKLOG_REPORTS && m_device->update(0));
+
+    m_backlogWakes.fetch_add(1, std::memory_order_relaxed);
+    m_backlogReports.fetch_add(depth, std::memory_order_relaxed);
+    if (depth > 1) {
+        m_backloggedWakes.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (depth > m_maxBacklogDepth.load(std::memory_order_relaxed)) {
+        m_maxBacklogDepth.store(static_cast<uint32_t>(depth), std::memory_order_relaxed);
     }
 
-    // Read from DualSense
-    bool hasInput = m_dualSense.update();
+    // Compare the jitter of both clocks over wakes with a single report,
+    // where both measure the same report-to-report interval
+    if (deviceTimeValid && depth == 1) {
+        m_hostDtStats.record(elapsed);
+        m_deviceDtStats.record(deviceElapsed);
+    }
+
+    // Device time is free of host scheduling jitter; fall back to host time
+    // when it is unavailable (first report after connect, lost reports)
+    bool useDeviceTime = m_deltaTimeSource == DeltaTimeSource::Device && deviceTimeValid;
+    if (m_deltaTimeSource == DeltaTimeSource::Device && !deviceTimeValid) {
+        m_deviceDtFallbacks.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (policy == BacklogPolicy::ReplayAll) {
+        stageHistogram(PipelineStage::Normalize).record(std::chrono::steady_clock::now() - wakeTime);
 
-    if (hasInput) {
-        std::lock_guard<std::mutex> lock(m_stateMutex);
+        // Without device time, the queued reports are assumed to cover the
+        // time since the last frame evenly
+        float hostDeltaTime = elapsed / static_cast<float>(depth);
+        for (size_t i = 0; i < depth; i++) {
+            float deltaTime = useDeviceTime ? m_backlogDeviceDt[i] : hostDeltaTime;
+            m_inputState = m_backlog[i];
+            m_inputState.deltaTime = deltaTime;
+            copyTouch(m_backlogContext[i].touch, m_context);
+            processFrame(deltaTime, wakeTime);
+        }
+    } else {
+        m_coalescedReports.fetch_add(depth - 1, std::memory_order_relaxed);
 
-        // Get normalized input
-        m_inputState = m_dualSense.getNormalizedState();
+        float deltaTime = useDeviceTime ? static_cast<float>(deviceElapsed) : elapsed;
+        m_inputState = m_device->getNormalizedState();
         m_inputState.deltaTime = deltaTime;
+        copyTouch(m_device->getState().touch, m_context);
+        stageHistogram(PipelineStage::Normalize).record(std::chrono::steady_clock::now() - wakeTime);
+        processFrame(deltaTime, wakeTime);
+    }
+
+    return true;
+}
+
+void InputProcessor::processFrame(float deltaTime, std::chrono::steady_clock::time_point wakeTime) {
+    auto normalizedTime = std::chrono::steady_clock::now();
+
+    // Gestures see every replayed report, so a quick tap inside a backlog is
+    // still recognized (LatestOnly may coalesce it away)
+    m_context.gestures = m_gestures.update(m_context.touch, deltaTime);
+    auto gesturesTime = std::chrono::steady_clock::now();
+    stageHistogram(PipelineStage::Gestures).record(gesturesTime - normalizedTime);
+
+    // Orientation from every report's own time step, so replayed backlog
+    // frames integrate exactly once each
+    m_motion.update(m_inputState, m_context, deltaTime);
+    auto motionTime = std::chrono::steady_clock::now();
+    stageHistogram(PipelineStage::Motion).record(motionTime - gesturesTime);
+
+    // Process through scripts
+    m_outputState = m_scriptManager.process(m_inputState, m_context, deltaTime);
+    auto scriptsTime = std::chrono::steady_clock::now();
+    stageHistogram(PipelineStage::Scripts).record(scriptsTime - motionTime);
 
-        // Process through scripts
-        m_outputState = m_scriptManager.process(m_inputState, deltaTime);
+    // Send to virtual controller
+    m_sink->update(m_outputState);
 
-        // Send to virtual controller
-        m_virtual.update(m_outputState);
+    // Rumble/trigger changes from this frame become at most one output report
+    const DualSenseOutputRequest& outputRequest = m_scriptManager.getFrameOutputRequest();
+    if (!outputRequest.empty()) {
+        m_device->requestOutput(outputRequest);
     }
+    auto outputTime = std::chrono::steady_clock::now();
+    stageHistogram(PipelineStage::Output).record(outputTime - scriptsTime);
+    stageHistogram(PipelineStage::Frame).record(outputTime - wakeTime);
 
-    return hasInput;
+    // Publish the frame without ever waiting on readers
+    m_snapshot.store({m_inputState, m_outputState});
 }
 
 void InputProcessor::processingLoop() {
-    using namespace std::chrono;
+    m_pacer.setRate(m_pollRateHz);
+
+    std::unique_ptr<ThreadTuningScope> tuning;
+    uint32_t appliedGeneration = 0;
 
     while (!m_shouldStop) {
-        auto start = high_resolution_clock::now();
+        // (Re)apply thread tuning on start and whenever the settings change
+        uint32_t generation = m_tuningGeneration;
+        if (!tuning || generation != appliedGeneration) {
+            appliedGeneration = generation;
+            tuning.reset();  // Restore defaults before applying the new settings
+            tuning = std::make_unique<ThreadTuningScope>(getThreadTuning());
+            if (!tuning->allApplied()) {
+                std::cerr << "Warning: Processing thread tuning incomplete:\n" << tuning->getStatus() << std::endl;
+            }
+            {
+                std::lock_guard<std::mutex> lock(m_tuningMutex);
+                m_threadTuningStatus = tuning->getStatus();
+            }
+            // Jitter should reflect the new settings only
+            m_pacer.resetStats();
+        }
+
+        if (m_inputMode == InputMode::EventDriven) {
+            // Deadlines restart from now if we switch back to periodic mode
+            m_pacer.reset();
+
+            if (m_device->isConnected()) {
+                // Block until the next report arrives (bounded so we can exit)
+                update(EVENT_WAIT_TIMEOUT_MS);
+                continue;
+            }
+
+            // No device to block on - adopt one if the watcher has it,
+            // otherwise sleep until it does
+            update();
+            if (!m_device->isConnected()) {
+                m_hotplug.waitReady(DISCONNECTED_RETRY_INTERVAL);
+            }
+            continue;
+        }
+
+        // Pick up settings changed from the GUI
+        float rate = m_pollRateHz;
+        if (rate != m_pacer.getRate()) {
+            m_pacer.setRate(rate);
+        }
+        m_pacer.setSpinWindow(std::chrono::microseconds(m_pacingSpinUs.load()));
 
         update();
 
-        // Calculate sleep time based on poll rate
-        auto elapsed = high_resolution_clock::now() - start;
-        auto targetDuration = microseconds(static_cast<long long>(1000000.0 / m_pollRateHz));
+        // Nothing to pace without a device; sleep until the watcher finds one
+        if (!m_device->isConnected()) {
+            m_hotplug.waitReady(DISCONNECTED_RETRY_INTERVAL);
+            m_pacer.reset();
+            continue;
+        }
+
+        // Sleep to the next absolute deadline so overshoot never accumulates
+        m_pacer.waitNext();
+    }
+}
+
+void InputProcessor::setInputMode(InputMode mode) {
+    if (m_inputMode.exchange(mode) != mode) {
+        resetLatencyStats();
+    }
+}
+
+void InputProcessor::setBacklogPolicy(BacklogPolicy policy) {
+    if (m_backlogPolicy.exchange(policy) != policy) {
+        resetLatencyStats();
+    }
+}
+
+BacklogStats InputProcessor::getBacklogStats() const {
+    BacklogStats stats;
+    stats.policy = m_backlogPolicy;
+    stats.wakes = m_backlogWakes.load(std::memory_order_relaxed);
+    stats.reports = m_backlogReports.load(std::memory_order_relaxed);
+    stats.backloggedWakes = m_backloggedWakes.load(std::memory_order_relaxed);
+    stats.coalesced = m_coalescedReports.load(std::memory_order_relaxed);
+    stats.maxDepth = m_maxBacklogDepth.load(std::memory_order_relaxed);
+    if (stats.wakes > 0) {
+        stats.meanDepth = static_cast<float>(stats.reports) / static_cast<float>(stats.wakes);
+    }
+    return stats;
+}
+
+void InputProcessor::setDeltaTimeSource(DeltaTimeSource source) {
+    if (m_deltaTimeSource.exchange(source) != source) {
+        resetLatencyStats();
+    }
+}
+
+DeltaTimeStats InputProcessor::getDeltaTimeStats() const {
+    DeltaTimeStats stats;
+    stats.source = m_deltaTimeSource;
+    stats.samples = m_deviceDtStats.count();
+    stats.hostMeanUs = m_hostDtStats.mean() * 1e6;
+    stats.hostStdDevUs = m_hostDtStats.stdDev() * 1e6;
+    stats.deviceMeanUs = m_deviceDtStats.mean() * 1e6;
+    stats.deviceStdDevUs = m_deviceDtStats.stdDev() * 1e6;
+    stats.fallbacks = m_deviceDtFallbacks.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void InputProcessor::setThreadTuning(const ThreadTuning& tuning) {
+    {
+        std::lock_guard<std::mutex> lock(m_tuningMutex);
+        m_threadTuning = tuning;
+    }
+    m_tuningGeneration++;
+}
 
-        if (elapsed < targetDuration) {
-            std::this_thread::sleep_for(targetDuration - elapsed);
+ThreadTuning InputProcessor::getThreadTuning() const {
+    std::lock_guard<std::mutex> lock(m_tuningMutex);
+    return m_threadTuning;
+}
+
+std::string InputProcessor::getThreadTuningStatus() const {
+    std::lock_guard<std::mutex> lock(m_tuningMutex);
+    return m_threadTuningStatus;
+}
+
+void InputProcessor::setOutputKeepalive(int milliseconds) {
+    m_outputKeepaliveMs = milliseconds;
+    m_sink->setKeepaliveInterval(std::chrono::milliseconds(milliseconds));
+}
+
+LatencyStats InputProcessor::getLatencyStats() const {
+    const LatencyHistogram& frame = getStageHistogram(PipelineStage::Frame);
+
+    LatencyStats stats;
+    stats.mode = m_inputMode;
+    stats.samples = frame.count();
+    stats.averageUs = static_cast<float>(frame.mean() / 1000.0);
+    stats.maxUs = static_cast<float>(frame.max()) / 1000.0f;
+    return stats;
+}
+
+void InputProcessor::resetLatencyStats() {
+    for (auto& histogram : m_stageHistograms) {
+        histogram.reset();
+    }
+    for (auto& script : m_scriptManager.getScripts()) {
+        if (script.engine) {
+            script.engine->getProcessHistogram().reset();
         }
     }
+
+    m_backlogWakes.store(0, std::memory_order_relaxed);
+    m_backlogReports.store(0, std::memory_order_relaxed);
+    m_backloggedWakes.store(0, std::memory_order_relaxed);
+    m_coalescedReports.store(0, std::memory_order_relaxed);
+    m_maxBacklogDepth.store(0, std::memory_order_relaxed);
+
+    m_hostDtStats.reset();
+    m_deviceDtStats.reset();
+    m_deviceDtFallbacks.store(0, std::memory_order_relaxed);
+}
+
+std::vector<LatencyReportEntry> InputProcessor::getLatencyReport() const {
+    std::vector<LatencyReportEntry> entries;
+
+    for (size_t i = 0; i < static_cast<size_t>(PipelineStage::Count); i++) {
+        entries.push_back({getPipelineStageName(static_cast<PipelineStage>(i)), m_stageHistograms[i].summarize()});
+    }
+
+    for (const auto& script : m_scriptManager.getScripts()) {
+        if (script.loaded && script.engine) {
+            entries.push_back({"Script: " + script.config.name, script.engine->getProcessHistogram().summarize()});
+        }
+    }
+
+    return entries;
 }
 
 bool InputProcessor::reconnectDualSense() {
-    m_dualSense.disconnect();
-    bool connected = m_dualSense.connect();
+    // The processing thread owns the device while it runs; let it drop the
+    // connection and the watcher find the controller again
+    if (m_running) {
+        m_reconnectRequested = true;
+        return true;
+    }
+
+    m_device->disconnect();
+    bool connected = m_device->connect();
     if (connected) {
-        m_dualSense.setLEDColor(0, 255, 128);
+        m_device->setLEDColor(0, 255, 128);
     }
     return connected;
 }
 
 bool InputProcessor::reconnectVirtual() {
-    m_virtual.disconnect();
-    return m_virtual.connect();
+    m_sink->disconnect();
+    return m_sink->connect();
 }
@@ -0,0 +1,215 @@
+#include "LatencyHistogram.h"
+#include <cmath>
+#include <iomanip>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static int highestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+LatencyHistogram::LatencyHistogram() {
+    reset();
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t ns) {
+    constexpr uint64_t maxValue = (1ull << MAX_VALUE_BITS) - 1;
+    if (ns > maxValue) {
+        ns = maxValue;
+    }
+
+    // Small values map 1:1 onto the first linear range
+    if (ns < SUB_BUCKETS) {
+        return static_cast<size_t>(ns);
+    }
+
+    int shift = highestBit(ns) - SUB_BUCKET_BITS;
+    uint64_t sub = (ns >> shift) & (SUB_BUCKETS - 1);
+    return static_cast<size_t>((shift + 1) * SUB_BUCKETS + sub);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    uint64_t sub = index % SUB_BUCKETS;
+    uint64_t lower = (SUB_BUCKETS + sub) << shift;
+    return lower + (1ull << shift) - 1;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    m_buckets[bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > m_max.load(std::memory_order_relaxed)) {
+        m_max.store(ns, std::memory_order_relaxed);
+    }
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t n = count();
+    return n > 0 ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(n) : 0.0;
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    uint64_t total = count();
+    if (total == 0) {
+        return 0;
+    }
+
+    fraction = std::clamp(fraction, 0.0, 1.0);
+    uint64_t target = static_cast<uint64_t>(fraction * static_cast<double>(total) + 0.5);
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            // Never report more than the exact maximum
+            return std::min(bucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+LatencyHistogram::Summary LatencyHistogram::summarize() const {
+    Summary summary;
+    summary.count = count();
+    summary.meanNs = mean();
+    summary.p50Ns = percentile(0.50);
+    summary.p99Ns = percentile(0.99);
+    summary.p999Ns = percentile(0.999);
+    summary.maxNs = max();
+    return summary;
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+void RunningVariance::record(double value) {
+    if (count() == 0) {
+        m_shift.store(value, std::memory_order_relaxed);
+    }
+
+    // Single writer: plain load/store pairs are enough
+    double shifted = value - m_shift.load(std::memory_order_relaxed);
+    m_sum.store(m_sum.load(std::memory_order_relaxed) + shifted, std::memory_order_relaxed);
+    m_sumSquares.store(m_sumSquares.load(std::memory_order_relaxed) + shifted * shifted, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+double RunningVariance::mean() const {
+    uint64_t n = count();
+    if (n == 0) {
+        return 0.0;
+    }
+    return m_shift.load(std::memory_order_relaxed) + m_sum.load(std::memory_order_relaxed) / static_cast<double>(n);
+}
+
+double RunningVariance::stdDev() const {
+    uint64_t n = count();
+    if (n < 2) {
+        return 0.0;
+    }
+    double shiftedMean = m_sum.load(std::memory_order_relaxed) / static_cast<double>(n);
+    double variance = m_sumSquares.load(std::memory_order_relaxed) / static_cast<double>(n) - shiftedMean * shiftedMean;
+    return variance > 0.0 ? std::sqrt(variance) : 0.0;
+}
+
+void RunningVariance::reset() {
+    m_count.store(0, std::memory_order_relaxed);
+    m_shift.store(0.0, std::memory_order_relaxed);
+    m_sum.store(0.0, std::memory_order_relaxed);
+    m_sumSquares.store(0.0, std::memory_order_relaxed);
+}
+
+// Stage names come from script names, so they may hold quotes, commas or
+// backslashes. CSV fields are quoted with embedded quotes doubled (RFC 4180);
+// JSON strings escape quotes, backslashes and control characters.
+static void writeCsvField(std::ostream& out, const std::string& value) {
+    out << '"';
+    for (char c : value) {
+        if (c == '"') {
+            out << '"';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+static void writeJsonString(std::ostream& out, const std::string& value) {
+    static const char HEX[] = "0123456789abcdef";
+    out << '"';
+    for (char c : value) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (c == '\n') {
+            out << "\\n";
+        } else if (c == '\r') {
+            out << "\\r";
+        } else if (c == '\t') {
+            out << "\\t";
+        } else if (byte < 0x20) {
+            out << "\\u00" << HEX[byte >> 4] << HEX[byte & 0x0F];
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+void writeLatencyCsv(std::ostream& out, const std::vector<LatencyReportEntry>& entries) {
+    out << "stage,count,mean_us,p50_us,p99_us,p999_us,max_us\n";
+    out << std::fixed << std::setprecision(3);
+    for (const auto& entry : entries) {
+        const auto& s = entry.summary;
+        writeCsvField(out, entry.name);
+        out << "," << s.count << ","
+            << s.meanNs / 1000.0 << ","
+            << s.p50Ns / 1000.0 << ","
+            << s.p99Ns / 1000.0 << ","
+            << s.p999Ns / 1000.0 << ","
+            << s.maxNs / 1000.0 << "\n";
+    }
+}
+
+void writeLatencyJson(std::ostream& out, const std::vector<LatencyReportEntry>& entries) {
+    out << "[\n";
+    out << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < entries.size(); i++) {
+        const auto& s = entries[i].summary;
+        out << "  {\n";
+        out << "    \"stage\": ";
+        writeJsonString(out, entries[i].name);
+        out << ",\n";
+        out << "    \"count\": " << s.count << ",\n";
+        out << "    \"mean_us\": " << s.meanNs / 1000.0 << ",\n";
+        out << "    \"p50_us\": " << s.p50Ns / 1000.0 << ",\n";
+        out << "    \"p99_us\": " << s.p99Ns / 1000.0 << ",\n";
+        out << "    \"p999_us\": " << s.p999Ns / 1000.0 << ",\n";
+        out << "    \"max_us\": " << s.maxNs / 1000.0 << "\n";
+        out << "  }";
+        if (i < entries.size() - 1) out << ",";
+        out << "\n";
+    }
+    out << "]\n";
+}
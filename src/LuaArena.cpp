@@ -0,0 +1,133 @@
+#include "LuaArena.h"
+#include <cstdlib>
+#include <cstring>
+
+LuaArena::~LuaArena() {
+    for (void* chunk : m_chunks) {
+        std::free(chunk);
+    }
+}
+
+void* LuaArena::allocate(void* ud, void* ptr, size_t osize, size_t nsize) {
+    return static_cast<LuaArena*>(ud)->reallocate(ptr, osize, nsize);
+}
+
+void LuaArena::resetPeak() {
+    m_peak.store(m_inUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_failed.store(0, std::memory_order_relaxed);
+}
+
+size_t LuaArena::classOf(size_t size) {
+    for (size_t i = 0; i < CLASS_COUNT; i++) {
+        if (size <= CLASS_SIZES[i]) {
+            return i;
+        }
+    }
+    return LARGE;
+}
+
+void* LuaArena::reallocate(void* ptr, size_t osize, size_t nsize) {
+    // For new blocks Lua passes the object type in osize
+    if (!ptr) {
+        osize = 0;
+    }
+
+    if (nsize == 0) {
+        if (ptr) {
+            release(ptr, osize);
+            m_inUse.fetch_sub(osize, std::memory_order_relaxed);
+        }
+        return nullptr;
+    }
+
+    // Only growth can hit the cap; Lua assumes shrinking never fails
+    size_t inUse = m_inUse.load(std::memory_order_relaxed);
+    size_t limit = m_limit.load(std::memory_order_relaxed);
+    if (nsize > osize && limit != 0 && inUse - osize + nsize > limit) {
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    size_t newClass = classOf(nsize);
+    void* block = nullptr;
+    if (ptr && classOf(osize) == newClass) {
+        if (newClass != LARGE) {
+            block = ptr;
+        } else if ((block = std::realloc(ptr, nsize)) != nullptr) {
+            m_reserved.fetch_add(nsize, std::memory_order_relaxed);
+            m_reserved.fetch_sub(osize, std::memory_order_relaxed);
+        }
+    } else {
+        if (newClass == LARGE) {
+            if ((block = std::malloc(nsize)) != nullptr) {
+                m_reserved.fetch_add(nsize, std::memory_order_relaxed);
+            }
+        } else {
+            block = take(newClass);
+        }
+        if (block && ptr) {
+            std::memcpy(block, ptr, std::min(osize, nsize));
+            release(ptr, osize);
+        }
+    }
+    if (!block && ptr && nsize <= osize) {
+        // Lua assumes a shrink cannot fail, so keep the block where it is.
+        // It still holds osize bytes and stays counted that way; a large
+        // block Lua will later free as pooled is kept with the chunks so the
+        // destructor returns it to the system.
+        if (classOf(osize) == LARGE && newClass != LARGE) {
+            m_chunks.push_back(ptr);
+        }
+        return ptr;
+    }
+    if (!block) {
+        m_failed.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    if (nsize > osize) {
+        m_allocated += nsize - osize;
+    }
+    inUse = inUse - osize + nsize;
+    m_inUse.store(inUse, std::memory_order_relaxed);
+    if (inUse > m_peak.load(std::memory_order_relaxed)) {
+        m_peak.store(inUse, std::memory_order_relaxed);
+    }
+    return block;
+}
+
+void* LuaArena::take(size_t sizeClass) {
+    if (FreeBlock* block = m_free[sizeClass]) {
+        m_free[sizeClass] = block->next;
+        return block;
+    }
+
+    // Carve from the newest chunk; its leftover tail goes unused
+    size_t size = CLASS_SIZES[sizeClass];
+    if (m_remaining < size) {
+        void* chunk = m_chunkAllocator(CHUNK_SIZE);
+        if (!chunk) {
+            return nullptr;
+        }
+        m_chunks.push_back(chunk);
+        m_reserved.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+        m_cursor = static_cast<uint8_t*>(chunk);
+        m_remaining = CHUNK_SIZE;
+    }
+    void* block = m_cursor;
+    m_cursor += size;
+    m_remaining -= size;
+    return block;
+}
+
+void LuaArena::release(void* block, size_t size) {
+    size_t sizeClass = classOf(size);
+    if (sizeClass == LARGE) {
+        std::free(block);
+        m_reserved.fetch_sub(size, std::memory_order_relaxed);
+        return;
+    }
+    FreeBlock* entry = static_cast<FreeBlock*>(block);
+    entry->next = m_free[sizeClass];
+    m_free[sizeClass] = entry;
+}
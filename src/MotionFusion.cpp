@@ -0,0 +1,129 @@
+#include "MotionFusion.h"
+#include <cmath>
+
+namespace {
+    constexpr float DEG_TO_RAD = 3.14159265358979323846f / 180.0f;
+}
+
+void MotionFusion::update(const NormalizedState& state, InputContext& context, float deltaTime) {
+    float ax = state.accelX;
+    float ay = state.accelY;
+    float az = state.accelZ;
+    float accelNorm = std::sqrt(ax * ax + ay * ay + az * az);
+    bool accelValid = std::abs(accelNorm - 1.0f) <= ACCEL_TOLERANCE_G;
+    if (accelValid) {
+        ax /= accelNorm;
+        ay /= accelNorm;
+        az /= accelNorm;
+    }
+
+    // Start from the measured tilt instead of converging to it from identity
+    if (!m_aligned && accelValid) {
+        alignToGravity(ax, ay, az);
+        m_aligned = true;
+    }
+
+    float dt = (deltaTime > 0.0f && deltaTime <= MAX_STEP_SECONDS) ? deltaTime : 0.0f;
+
+    // Still detection on the bias-corrected rate, then average the raw rate
+    // into the bias while still
+    float gx = state.gyroX - m_bias[0];
+    float gy = state.gyroY - m_bias[1];
+    float gz = state.gyroZ - m_bias[2];
+    bool quiet = std::sqrt(gx * gx + gy * gy + gz * gz) < STILL_GYRO_DEG_S &&
+                 std::abs(accelNorm - 1.0f) < STILL_ACCEL_G;
+    m_stillTime = quiet ? m_stillTime + dt : 0.0f;
+    bool still = m_stillTime >= STILL_SECONDS;
+    if (still && m_autoBias) {
+        float alpha = std::min(1.0f, dt / BIAS_TIME_CONSTANT);
+        m_bias[0] += alpha * (state.gyroX - m_bias[0]);
+        m_bias[1] += alpha * (state.gyroY - m_bias[1]);
+        m_bias[2] += alpha * (state.gyroZ - m_bias[2]);
+        gx = state.gyroX - m_bias[0];
+        gy = state.gyroY - m_bias[1];
+        gz = state.gyroZ - m_bias[2];
+    }
+
+    if (dt > 0.0f) {
+        float wx = gx * DEG_TO_RAD;
+        float wy = gy * DEG_TO_RAD;
+        float wz = gz * DEG_TO_RAD;
+
+        // Pull the estimated up direction towards the measured one
+        if (accelValid) {
+            float vx = 2.0f * (m_qx * m_qy + m_qw * m_qz);
+            float vy = 1.0f - 2.0f * (m_qx * m_qx + m_qz * m_qz);
+            float vz = 2.0f * (m_qy * m_qz - m_qw * m_qx);
+            wx += ACCEL_GAIN * (ay * vz - az * vy);
+            wy += ACCEL_GAIN * (az * vx - ax * vz);
+            wz += ACCEL_GAIN * (ax * vy - ay * vx);
+        }
+
+        // q += 0.5 * q * (0, w) * dt
+        float hx = 0.5f * dt * wx;
+        float hy = 0.5f * dt * wy;
+        float hz = 0.5f * dt * wz;
+        float qw = m_qw - m_qx * hx - m_qy * hy - m_qz * hz;
+        float qx = m_qx + m_qw * hx + m_qy * hz - m_qz * hy;
+        float qy = m_qy + m_qw * hy - m_qx * hz + m_qz * hx;
+        float qz = m_qz + m_qw * hz + m_qx * hy - m_qy * hx;
+        float norm = std::sqrt(qw * qw + qx * qx + qy * qy + qz * qz);
+        m_qw = qw / norm;
+        m_qx = qx / norm;
+        m_qy = qy / norm;
+        m_qz = qz / norm;
+    }
+
+    // World up in controller coordinates
+    float upX = 2.0f * (m_qx * m_qy + m_qw * m_qz);
+    float upY = 1.0f - 2.0f * (m_qx * m_qx + m_qz * m_qz);
+    float upZ = 2.0f * (m_qy * m_qz - m_qw * m_qx);
+
+    context.quatW = m_qw;
+    context.quatX = m_qx;
+    context.quatY = m_qy;
+    context.quatZ = m_qz;
+    context.gravityX = -upX;
+    context.gravityY = -upY;
+    context.gravityZ = -upZ;
+
+    // Yaw turns about world up however the controller is held; pitch turns
+    // about the controller's X axis laid flat
+    context.yawRate = gx * upX + gy * upY + gz * upZ;
+    float px = 1.0f - upX * upX;
+    float py = -upX * upY;
+    float pz = -upX * upZ;
+    float pitchAxisLength = std::sqrt(px * px + py * py + pz * pz);
+    context.pitchRate = pitchAxisLength > 1e-3f ? (gx * px + gy * py + gz * pz) / pitchAxisLength : 0.0f;
+    context.motionStill = still;
+}
+
+void MotionFusion::alignToGravity(float ax, float ay, float az) {
+    // Shortest rotation taking the measured up (ax, ay, az) onto +Y
+    float w = 1.0f + ay;
+    if (w < 1e-6f) {
+        // Upside down: half a turn about X
+        m_qw = 0.0f;
+        m_qx = 1.0f;
+        m_qy = 0.0f;
+        m_qz = 0.0f;
+        return;
+    }
+    float x = -az;
+    float z = ax;
+    float norm = std::sqrt(w * w + x * x + z * z);
+    m_qw = w / norm;
+    m_qx = x / norm;
+    m_qy = 0.0f;
+    m_qz = z / norm;
+}
+
+void MotionFusion::reset() {
+    m_qw = 1.0f;
+    m_qx = 0.0f;
+    m_qy = 0.0f;
+    m_qz = 0.0f;
+    m_aligned = false;
+    m_bias[0] = m_bias[1] = m_bias[2] = 0.0f;
+    m_stillTime = 0.0f;
+}
@@ -0,0 +1,107 @@
+#include "OutputReportScheduler.h"
+
+OutputReportScheduler::~OutputReportScheduler() {
+    stop();
+}
+
+void OutputReportScheduler::start(WriteFunction write) {
+    stop();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_write = std::move(write);
+        m_stopping = false;
+        m_pending = true;
+    }
+    m_thread = std::thread(&OutputReportScheduler::writerLoop, this);
+}
+
+void OutputReportScheduler::stop() {
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+}
+
+void OutputReportScheduler::setMaxRate(float hz) {
+    if (hz > 0.0f) {
+        m_maxRateHz = hz;
+    }
+}
+
+DualSenseOutputState OutputReportScheduler::getDesiredState() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_desired;
+}
+
+void OutputReportScheduler::invalidate() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    markPending();
+}
+
+void OutputReportScheduler::markPending() {
+    if (m_pending) {
+        m_coalesced.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_pending = true;
+        m_wake.notify_one();
+    }
+}
+
+void OutputReportScheduler::writerLoop() {
+    Clock::time_point nextAllowed = Clock::now();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        m_wake.wait(lock, [this] { return m_pending || m_stopping; });
+        if (m_stopping) {
+            break;
+        }
+
+        // Hold the report back until the rate limit allows it; changes made in
+        // the meantime are merged into it
+        if (m_wake.wait_until(lock, nextAllowed, [this] { return m_stopping; })) {
+            break;
+        }
+
+        DualSenseOutputState state = m_desired;
+        m_pending = false;
+
+        // The next slot is one period after this write started, so a slow
+        // write does not lower the rate below the limit
+        auto period = std::chrono::duration<double>(1.0 / m_maxRateHz.load());
+        nextAllowed = Clock::now() + std::chrono::duration_cast<Clock::duration>(period);
+
+        lock.unlock();
+        bool ok = m_write(state);
+        lock.lock();
+
+        if (ok) {
+            m_sent.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // Retry at the next slot with whatever the state is by then
+            m_failed.fetch_add(1, std::memory_order_relaxed);
+            m_pending = true;
+        }
+    }
+}
+
+OutputReportStats OutputReportScheduler::getStats() const {
+    OutputReportStats stats;
+    stats.sent = m_sent.load(std::memory_order_relaxed);
+    stats.coalesced = m_coalesced.load(std::memory_order_relaxed);
+    stats.failed = m_failed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void OutputReportScheduler::resetStats() {
+    m_sent.store(0, std::memory_order_relaxed);
+    m_coalesced.store(0, std::memory_order_relaxed);
+    m_failed.store(0, std::memory_order_relaxed);
+}
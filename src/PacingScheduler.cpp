@@ -0,0 +1,128 @@
+#include "PacingScheduler.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#else
+#include <cerrno>
+#include <time.h>
+#endif
+
+static int64_t toNs(PacingScheduler::Clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+PacingScheduler::PacingScheduler() {
+#ifdef _WIN32
+    // High-resolution timers need Windows 10 1803+; fall back to a standard timer
+    m_timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+    if (!m_timer) {
+        m_timer = CreateWaitableTimerExW(nullptr, nullptr, 0, TIMER_ALL_ACCESS);
+    }
+#endif
+    setRate(m_rateHz);
+}
+
+PacingScheduler::~PacingScheduler() {
+#ifdef _WIN32
+    if (m_timer) {
+        CloseHandle(m_timer);
+        m_timer = nullptr;
+    }
+#endif
+}
+
+void PacingScheduler::setRate(float hz) {
+    if (hz <= 0.0f) {
+        return;
+    }
+
+    m_rateHz = hz;
+    m_period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+    reset();
+    resetStats();
+}
+
+void PacingScheduler::reset() {
+    m_nextDeadline = Clock::now() + m_period;
+}
+
+PacingScheduler::Clock::duration PacingScheduler::waitNext() {
+    sleepUntil(m_nextDeadline);
+
+    // Spin out the remainder of the window
+    Clock::time_point now = Clock::now();
+    while (now < m_nextDeadline) {
+        std::this_thread::yield();
+        now = Clock::now();
+    }
+
+    Clock::duration lateness = now - m_nextDeadline;
+    m_lateness.record(lateness);
+    m_ticks.fetch_add(1, std::memory_order_relaxed);
+
+    // Advance by whole periods. If we have fallen a full period behind, skip the
+    // missed deadlines instead of bursting to catch up.
+    m_nextDeadline += m_period;
+    if (now >= m_nextDeadline) {
+        auto behind = (now - m_nextDeadline) / m_period + 1;
+        m_nextDeadline += m_period * behind;
+        m_missedTicks.fetch_add(static_cast<uint64_t>(behind), std::memory_order_relaxed);
+    }
+
+    return lateness;
+}
+
+void PacingScheduler::sleepUntil(Clock::time_point deadline) {
+    Clock::time_point wakeAt = deadline - m_spinWindow;
+    if (Clock::now() >= wakeAt) {
+        return;
+    }
+
+#ifdef _WIN32
+    if (m_timer) {
+        // Relative due time in 100 ns units (negative = relative)
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(wakeAt - Clock::now()).count();
+        if (remaining > 0) {
+            LARGE_INTEGER dueTime;
+            dueTime.QuadPart = -static_cast<LONGLONG>(remaining / 100);
+            if (SetWaitableTimer(m_timer, &dueTime, 0, nullptr, nullptr, FALSE)) {
+                WaitForSingleObject(m_timer, INFINITE);
+                return;
+            }
+        }
+    }
+    std::this_thread::sleep_until(wakeAt);
+#else
+    // steady_clock is CLOCK_MONOTONIC on Linux, so deadlines convert directly
+    int64_t ns = toNs(wakeAt);
+    timespec ts;
+    ts.tv_sec = static_cast<time_t>(ns / 1000000000);
+    ts.tv_nsec = static_cast<long>(ns % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#endif
+}
+
+PacingStats PacingScheduler::getStats() const {
+    PacingStats stats;
+    stats.targetHz = m_rateHz;
+    stats.ticks = m_ticks.load(std::memory_order_relaxed);
+    stats.missedTicks = m_missedTicks.load(std::memory_order_relaxed);
+    stats.lateness = m_lateness.summarize();
+
+    double elapsed = static_cast<double>(toNs(Clock::now()) - m_statsStartNs.load(std::memory_order_relaxed)) / 1e9;
+    if (elapsed > 0.0) {
+        stats.achievedHz = static_cast<float>(static_cast<double>(stats.ticks) / elapsed);
+    }
+    return stats;
+}
+
+void PacingScheduler::resetStats() {
+    m_ticks.store(0, std::memory_order_relaxed);
+    m_missedTicks.store(0, std::memory_order_relaxed);
+    m_lateness.reset();
+    m_statsStartNs.store(toNs(Clock::now()), std::memory_order_relaxed);
+}
@@ -0,0 +1,168 @@
+#include "PipelinePool.h"
+#include "PacingScheduler.h"
+#include "ThreadTuning.h"
+#include <iostream>
+
+PipelinePool::PipelinePool(size_t workers)
+    : m_requestedWorkers(workers) {
+}
+
+PipelinePool::~PipelinePool() {
+    stop();
+}
+
+size_t PipelinePool::add(std::unique_ptr<InputProcessor> pipeline) {
+    auto slot = std::make_unique<Slot>();
+    slot->pipeline = std::move(pipeline);
+    m_slots.push_back(std::move(slot));
+    return m_slots.size() - 1;
+}
+
+bool PipelinePool::start() {
+    if (m_running) {
+        return true;
+    }
+    if (m_slots.empty()) {
+        return false;
+    }
+
+    // Sinks and hotplug watchers; the workers do the processing of periodic
+    // pipelines, event-driven ones run their own loop
+    m_pooled.clear();
+    for (auto& slot : m_slots) {
+        bool pooled = slot->pipeline->getInputMode() == InputMode::Periodic;
+        if (!slot->pipeline->start(!pooled)) {
+            std::cerr << "Warning: Failed to start pipeline for " << slot->pipeline->getInputDevice().getName()
+                      << std::endl;
+        } else if (pooled) {
+            m_pooled.push_back(slot.get());
+        }
+    }
+
+    size_t workers = m_requestedWorkers;
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    m_workerCount = std::min(workers, m_pooled.size());
+
+    m_shouldStop = false;
+    m_running = true;
+    for (size_t i = 0; i < m_workerCount; i++) {
+        m_workers.emplace_back(&PipelinePool::workerLoop, this, i);
+    }
+    return true;
+}
+
+void PipelinePool::stop() {
+    if (!m_running) {
+        return;
+    }
+
+    m_shouldStop = true;
+    for (auto& worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+
+    for (auto& slot : m_slots) {
+        slot->pipeline->stop();
+    }
+    m_running = false;
+}
+
+void PipelinePool::setPollRate(float hz) {
+    m_pollRateHz = hz;
+    for (auto& slot : m_slots) {
+        slot->pipeline->setPollRate(hz);
+    }
+}
+
+void PipelinePool::setPacingSpinWindow(int microseconds) {
+    m_pacingSpinUs = microseconds;
+    for (auto& slot : m_slots) {
+        slot->pipeline->setPacingSpinWindow(microseconds);
+    }
+}
+
+void PipelinePool::setInputMode(InputMode mode) {
+    bool restart = m_running;
+    if (restart) {
+        stop();
+    }
+    for (auto& slot : m_slots) {
+        slot->pipeline->setInputMode(mode);
+    }
+    if (restart) {
+        start();
+    }
+}
+
+void PipelinePool::resetServiceHistograms() {
+    for (auto& slot : m_slots) {
+        slot->service.reset();
+    }
+}
+
+void PipelinePool::setThreadTuning(const ThreadTuning& tuning) {
+    {
+        std::lock_guard<std::mutex> lock(m_tuningMutex);
+        m_threadTuning = tuning;
+    }
+    m_tuningGeneration++;
+    for (auto& slot : m_slots) {
+        slot->pipeline->setThreadTuning(tuning);
+    }
+}
+
+ThreadTuning PipelinePool::getThreadTuning() const {
+    std::lock_guard<std::mutex> lock(m_tuningMutex);
+    return m_threadTuning;
+}
+
+void PipelinePool::workerLoop(size_t worker) {
+    PacingScheduler pacer;
+    pacer.setRate(m_pollRateHz);
+
+    std::unique_ptr<ThreadTuningScope> tuning;
+    uint32_t appliedGeneration = 0;
+
+    while (!m_shouldStop) {
+        // (Re)apply thread tuning on start and whenever the settings change
+        uint32_t generation = m_tuningGeneration;
+        if (!tuning || generation != appliedGeneration) {
+            appliedGeneration = generation;
+            tuning.reset();  // Restore defaults before applying the new settings
+            tuning = std::make_unique<ThreadTuningScope>(getThreadTuning());
+            if (!tuning->allApplied()) {
+                std::cerr << "Warning: Pipeline worker tuning incomplete:\n" << tuning->getStatus() << std::endl;
+            }
+        }
+
+        // Pick up settings changed from the GUI
+        float rate = m_pollRateHz;
+        if (rate != pacer.getRate()) {
+            pacer.setRate(rate);
+        }
+        pacer.setSpinWindow(std::chrono::microseconds(m_pacingSpinUs.load()));
+
+        auto wakeTime = std::chrono::steady_clock::now();
+        bool anyConnected = false;
+        for (size_t i = worker; i < m_pooled.size(); i += m_workerCount) {
+            Slot& slot = *m_pooled[i];
+            if (slot.pipeline->update()) {
+                slot.service.record(std::chrono::steady_clock::now() - wakeTime);
+            }
+            anyConnected = anyConnected || slot.pipeline->isDualSenseConnected();
+        }
+
+        // Nothing to pace without a controller; the watchers find them
+        if (!anyConnected) {
+            std::this_thread::sleep_for(IDLE_INTERVAL);
+            pacer.reset();
+            continue;
+        }
+
+        // Sleep to the next absolute deadline so overshoot never accumulates
+        pacer.waitNext();
+    }
+}
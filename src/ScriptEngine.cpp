@@ -2,17 +2,354 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+// Engine that owns a Lua state, for the Lua callbacks. Stored in the state's
+// extra space when it is created (coroutines inherit it), so every engine
+// carries its own binding and engines can run on any number of threads.
+static ScriptEngine* engineOf(lua_State* L) {
+    return *static_cast<ScriptEngine**>(lua_getextraspace(L));
+}
+
+// Collector tuning. Generational: a minor collection once a frame leaves
+// the heap GEN_MINOR_MUL percent bigger than at the last step, a major one
+// when it outgrew the last major by GEN_MAJOR_MUL percent. Incremental: a
+// step every 2^INC_STEP_SIZE_LOG2 bytes allocated, doing INC_STEP_MUL percent
+// of that in collection work so cycles keep ahead of allocation. Never a
+// step for less than GC_MIN_STEP_BYTES.
+static constexpr int GEN_MINOR_MUL = 10;
+static constexpr int GEN_MAJOR_MUL = 100;
+static constexpr int INC_STEP_MUL = 200;
+static constexpr int INC_STEP_SIZE_LOG2 = 12;
+static constexpr uint64_t GC_MIN_STEP_BYTES = 4096;
+
+// Frames between updates of the collector time per second when no step ran
+static constexpr uint32_t GC_RATE_CHECK_FRAMES = 256;
+
+// Script-facing names of the button bits
+struct LuaButton {
+    const char* name;
+    uint32_t bit;
+};
+
+static constexpr LuaButton LUA_BUTTONS[] = {
+    {"square", BUTTON_SQUARE}, {"cross", BUTTON_CROSS}, {"circle", BUTTON_CIRCLE}, {"triangle", BUTTON_TRIANGLE},
+    {"l1", BUTTON_L1}, {"r1", BUTTON_R1}, {"l2_button", BUTTON_L2}, {"r2_button", BUTTON_R2},
+    {"share", BUTTON_SHARE}, {"options", BUTTON_OPTIONS}, {"l3", BUTTON_L3}, {"r3", BUTTON_R3},
+    {"ps", BUTTON_PS}, {"touchpad", BUTTON_TOUCHPAD}, {"mute", BUTTON_MUTE}
+};
+
+// Script-facing names of the gesture bits (true on the frame a gesture completes)
+static constexpr LuaButton LUA_GESTURES[] = {
+    {"tap", GESTURE_TAP}, {"two_finger_tap", GESTURE_TWO_FINGER_TAP},
+    {"swipe_left", GESTURE_SWIPE_LEFT}, {"swipe_right", GESTURE_SWIPE_RIGHT},
+    {"swipe_up", GESTURE_SWIPE_UP}, {"swipe_down", GESTURE_SWIPE_DOWN},
+    {"pinch_in", GESTURE_PINCH_IN}, {"pinch_out", GESTURE_PINCH_OUT}
+};
+
+// Script-facing names of each touch contact's fields
+struct LuaTouchFields {
+    const char* active;
+    const char* x;
+    const char* y;
+    const char* id;
+};
+
+static constexpr LuaTouchFields LUA_TOUCH[TOUCH_POINT_COUNT] = {
+    {"touch1_active", "touch1_x", "touch1_y", "touch1_id"},
+    {"touch2_active", "touch2_x", "touch2_y", "touch2_id"}
+};
+
+// ----------------------------------------------------------------------------
+// Userdata state bridge. The state lives in one full userdata per engine;
+// __index/__newindex resolve the field name through a perfect hash over
+// STATE_FIELDS, so a frame neither allocates nor walks a Lua table.
+// ----------------------------------------------------------------------------
+static const char* const STATE_METATABLE = "ps5scripts.State";
+static const char* const STATE_TABLE_METATABLE = "ps5scripts.StateTable";
+
+enum class FieldKind : uint8_t {
+    Number,         // float at offset
+    Boolean,        // bool at offset
+    Button,         // BUTTON_* bit
+    Gesture,        // GESTURE_* bit
+    Dpad,
+    TouchActive,    // Touch fields: arg is the contact index
+    TouchX,
+    TouchY,
+    TouchId
+};
+
+struct StateField {
+    std::string name;
+    FieldKind kind;
+    uint32_t arg;
+    bool inputOnly = false;     // Passed through; never read back from the script
+};
+
+// The state and the frame's context in one block, so every field is an
+// offset into it
+struct ScriptInput {
+    NormalizedState state;
+    InputContext context;
+};
+
+#define STATE_OFFSET(member) static_cast<uint32_t>(offsetof(ScriptInput, state) + offsetof(NormalizedState, member))
+#define CONTEXT_OFFSET(member) static_cast<uint32_t>(offsetof(ScriptInput, context) + offsetof(InputContext, member))
+#define STATE_NUMBER(name, member) {name, FieldKind::Number, STATE_OFFSET(member)}
+#define STATE_INPUT(name, member) {name, FieldKind::Number, STATE_OFFSET(member), true}
+#define CONTEXT_NUMBER(name, member) {name, FieldKind::Number, CONTEXT_OFFSET(member), true}
+
+static std::vector<StateField> buildStateFields() {
+    std::vector<StateField> fields = {
+        STATE_NUMBER("left_x", leftStickX), STATE_NUMBER("left_y", leftStickY),
+        STATE_NUMBER("right_x", rightStickX), STATE_NUMBER("right_y", rightStickY),
+        STATE_NUMBER("left_trigger", leftTrigger), STATE_NUMBER("right_trigger", rightTrigger),
+        STATE_NUMBER("gyro_x", gyroX), STATE_NUMBER("gyro_y", gyroY), STATE_NUMBER("gyro_z", gyroZ),
+        STATE_NUMBER("accel_x", accelX), STATE_NUMBER("accel_y", accelY), STATE_NUMBER("accel_z", accelZ),
+        CONTEXT_NUMBER("quat_w", quatW), CONTEXT_NUMBER("quat_x", quatX),
+        CONTEXT_NUMBER("quat_y", quatY), CONTEXT_NUMBER("quat_z", quatZ),
+        CONTEXT_NUMBER("gravity_x", gravityX), CONTEXT_NUMBER("gravity_y", gravityY),
+        CONTEXT_NUMBER("gravity_z", gravityZ),
+        CONTEXT_NUMBER("yaw_rate", yawRate), CONTEXT_NUMBER("pitch_rate", pitchRate),
+        STATE_INPUT("dt", deltaTime),
+        {"motion_still", FieldKind::Boolean, CONTEXT_OFFSET(motionStill), true},
+        {"dpad", FieldKind::Dpad, 0}
+    };
+    for (const LuaButton& entry : LUA_BUTTONS) {
+        fields.push_back({entry.name, FieldKind::Button, entry.bit});
+    }
+    for (const LuaButton& entry : LUA_GESTURES) {
+        fields.push_back({entry.name, FieldKind::Gesture, entry.bit, true});
+    }
+    for (uint32_t i = 0; i < TOUCH_POINT_COUNT; i++) {
+        fields.push_back({LUA_TOUCH[i].active, FieldKind::TouchActive, i, true});
+        fields.push_back({LUA_TOUCH[i].x, FieldKind::TouchX, i, true});
+        fields.push_back({LUA_TOUCH[i].y, FieldKind::TouchY, i, true});
+        fields.push_back({LUA_TOUCH[i].id, FieldKind::TouchId, i, true});
+    }
+    return fields;
+}
+
+#undef STATE_OFFSET
+#undef CONTEXT_OFFSET
+#undef STATE_NUMBER
+#undef STATE_INPUT
+#undef CONTEXT_NUMBER
+
+// Field name -> index into the fields, collision-free for the known names.
+// Built once: the first seed that maps every name to its own slot wins.
+class StateFieldHash {
+public:
+    static constexpr size_t SLOTS = 256;
+    static constexpr uint8_t EMPTY = 0xFF;
+
+    StateFieldHash() : m_fields(buildStateFields()) {
+        for (m_seed = 0;; m_seed++) {
+            std::fill(std::begin(m_slots), std::end(m_slots), EMPTY);
+            bool collision = false;
+            for (size_t i = 0; i < m_fields.size() && !collision; i++) {
+                uint8_t& slot = m_slots[slotOf(m_fields[i].name.data(), m_fields[i].name.size())];
+                collision = slot != EMPTY;
+                slot = static_cast<uint8_t>(i);
+            }
+            if (!collision) {
+                break;
+            }
+        }
+    }
+
+    // nullptr for names that are not state fields
+    const StateField* find(const char* name, size_t length) const {
+        uint8_t index = m_slots[slotOf(name, length)];
+        if (index == EMPTY) {
+            return nullptr;
+        }
+        const StateField& field = m_fields[index];
+        if (field.name.size() != length || std::memcmp(field.name.data(), name, length) != 0) {
+            return nullptr;
+        }
+        return &field;
+    }
+
+    const std::vector<StateField>& fields() const { return m_fields; }
+
+private:
+    // FNV-1a, seeded
+    size_t slotOf(const char* name, size_t length) const {
+        uint32_t hash = 2166136261u ^ m_seed;
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ static_cast<uint8_t>(name[i])) * 16777619u;
+        }
+        return (hash ^ (hash >> 16)) & (SLOTS - 1);
+    }
+
+    std::vector<StateField> m_fields;
+    uint32_t m_seed = 0;
+    uint8_t m_slots[SLOTS];
+};
+
+static const StateFieldHash& stateFieldHash() {
+    static const StateFieldHash hash;
+    return hash;
+}
+
+static const StateField* findStateField(lua_State* L, int index) {
+    if (lua_type(L, index) != LUA_TSTRING) {
+        return nullptr;
+    }
+    size_t length = 0;
+    const char* name = lua_tolstring(L, index, &length);
+    return stateFieldHash().find(name, length);
+}
+
+static void pushStateField(lua_State* L, const ScriptInput& input, const StateField& field) {
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(&input);
+    switch (field.kind) {
+        case FieldKind::Number:
+            lua_pushnumber(L, *reinterpret_cast<const float*>(base + field.arg));
+            break;
+        case FieldKind::Boolean:
+            lua_pushboolean(L, *reinterpret_cast<const bool*>(base + field.arg));
+            break;
+        case FieldKind::Button:
+            lua_pushboolean(L, input.state.button(field.arg));
+            break;
+        case FieldKind::Gesture:
+            lua_pushboolean(L, (input.context.gestures & field.arg) != 0);
+            break;
+        case FieldKind::Dpad:
+            lua_pushinteger(L, input.state.dpad);
+            break;
+        case FieldKind::TouchActive:
+            lua_pushboolean(L, input.context.touch[field.arg].active);
+            break;
+        case FieldKind::TouchX:
+            lua_pushnumber(L, input.context.touch[field.arg].x / static_cast<float>(TOUCHPAD_WIDTH - 1));
+            break;
+        case FieldKind::TouchY:
+            lua_pushnumber(L, input.context.touch[field.arg].y / static_cast<float>(TOUCHPAD_HEIGHT - 1));
+            break;
+        case FieldKind::TouchId:
+            lua_pushinteger(L, input.context.touch[field.arg].id);
+            break;
+    }
+}
+
+// Same conversions as readState: wrong types read as 0 / false / neutral
+static void storeStateField(lua_State* L, int index, ScriptInput& input, const StateField& field) {
+    uint8_t* base = reinterpret_cast<uint8_t*>(&input);
+    float number = lua_isnumber(L, index) ? static_cast<float>(lua_tonumber(L, index)) : 0.0f;
+    bool flag = lua_isboolean(L, index) && lua_toboolean(L, index);
+    switch (field.kind) {
+        case FieldKind::Number:
+            *reinterpret_cast<float*>(base + field.arg) = number;
+            break;
+        case FieldKind::Boolean:
+            *reinterpret_cast<bool*>(base + field.arg) = flag;
+            break;
+        case FieldKind::Button:
+            input.state.setButton(field.arg, flag);
+            break;
+        case FieldKind::Gesture:
+            input.context.gestures = flag ? (input.context.gestures | field.arg) : (input.context.gestures & ~field.arg);
+            break;
+        case FieldKind::Dpad:
+            input.state.dpad = lua_isinteger(L, index) ? static_cast<uint8_t>(lua_tointeger(L, index)) : 8;
+            break;
+        case FieldKind::TouchActive:
+            input.context.touch[field.arg].active = flag;
+            break;
+        case FieldKind::TouchX:
+            input.context.touch[field.arg].x = static_cast<int16_t>(std::lround(number * (TOUCHPAD_WIDTH - 1)));
+            break;
+        case FieldKind::TouchY:
+            input.context.touch[field.arg].y = static_cast<int16_t>(std::lround(number * (TOUCHPAD_HEIGHT - 1)));
+            break;
+        case FieldKind::TouchId:
+            input.context.touch[field.arg].id = static_cast<uint8_t>(number);
+            break;
+    }
+}
+
+// Fields a script adds to the state itself go to a side table (the user
+// value), created on first use and dropped after the frame. Argument 1 is
+// not type-checked: the metatable is hidden from scripts (and the debug
+// library is not opened), so only Lua calls these, always with the state.
+static int lua_stateIndex(lua_State* L) {
+    ScriptInput* input = static_cast<ScriptInput*>(lua_touserdata(L, 1));
+    if (const StateField* field = findStateField(L, 2)) {
+        pushStateField(L, *input, *field);
+        return 1;
+    }
+    if (lua_getiuservalue(L, 1, 1) != LUA_TTABLE) {
+        lua_pushnil(L);
+        return 1;
+    }
+    lua_pushvalue(L, 2);
+    lua_rawget(L, -2);
+    return 1;
+}
+
+static int lua_stateNewIndex(lua_State* L) {
+    ScriptInput* input = static_cast<ScriptInput*>(lua_touserdata(L, 1));
+    if (const StateField* field = findStateField(L, 2)) {
+        storeStateField(L, 3, *input, *field);
+        return 0;
+    }
+    if (lua_getiuservalue(L, 1, 1) != LUA_TTABLE) {
+        lua_pop(L, 1);
+        lua_newtable(L);
+        lua_pushvalue(L, -1);
+        lua_setiuservalue(L, 1, 1);
+    }
+    lua_pushvalue(L, 2);
+    lua_pushvalue(L, 3);
+    lua_rawset(L, -3);
+    return 0;
+}
+
+// pairs(input) walks the state fields (not the script's own additions). A
+// script can call the iterator with anything, so the state is its upvalue.
+static int lua_stateNext(lua_State* L) {
+    ScriptInput* input = static_cast<ScriptInput*>(lua_touserdata(L, lua_upvalueindex(1)));
+    const std::vector<StateField>& fields = stateFieldHash().fields();
+    size_t next = 0;
+    if (!lua_isnoneornil(L, 2)) {
+        const StateField* field = findStateField(L, 2);
+        if (!field) {
+            return 0;
+        }
+        next = static_cast<size_t>(field - fields.data()) + 1;
+    }
+    if (next >= fields.size()) {
+        return 0;
+    }
+    lua_pushlstring(L, fields[next].name.data(), fields[next].name.size());
+    pushStateField(L, *input, fields[next]);
+    return 2;
+}
 
-// Global pointer for Lua callbacks (simple approach for single-threaded use)
-static ScriptEngine* g_currentEngine = nullptr;
+// Upvalue 1 is the iterator
+static int lua_statePairs(lua_State* L) {
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_pushvalue(L, 1);
+    lua_pushnil(L);
+    return 3;
+}
 
 // Lua C functions
+
+// get_param(name, default) and set_param(name, value) work on the params
+// table (upvalue 1), so reading a parameter neither allocates nor leaves Lua
 static int lua_getParameter(lua_State* L) {
-    const char* name = luaL_checkstring(L, 1);
+    luaL_checkstring(L, 1);
     float defaultVal = luaL_optnumber(L, 2, 0.0);
-    if (g_currentEngine) {
-        lua_pushnumber(L, g_currentEngine->getParameter(name, defaultVal));
-    } else {
+    lua_pushvalue(L, 1);
+    if (lua_rawget(L, lua_upvalueindex(1)) != LUA_TNUMBER) {
+        lua_pop(L, 1);
         lua_pushnumber(L, defaultVal);
     }
     return 1;
@@ -21,12 +358,95 @@ static int lua_getParameter(lua_State* L) {
 static int lua_setParameter(lua_State* L) {
     const char* name = luaL_checkstring(L, 1);
     float value = luaL_checknumber(L, 2);
-    if (g_currentEngine) {
-        g_currentEngine->setParameter(name, value);
+    lua_pushvalue(L, 1);
+    lua_pushnumber(L, value);
+    lua_rawset(L, lua_upvalueindex(1));
+    engineOf(L)->storeParameter(name, value);
+    return 0;
+}
+
+// set_rumble(left, right): motor strength 0.0-1.0
+static int lua_setRumble(lua_State* L) {
+    float left = std::clamp(static_cast<float>(luaL_checknumber(L, 1)), 0.0f, 1.0f);
+    float right = std::clamp(static_cast<float>(luaL_checknumber(L, 2)), 0.0f, 1.0f);
+    DualSenseOutputRequest& request = engineOf(L)->getOutputRequest();
+    request.hasRumble = true;
+    request.rumbleLeft = static_cast<uint8_t>(left * 255.0f + 0.5f);
+    request.rumbleRight = static_cast<uint8_t>(right * 255.0f + 0.5f);
+    return 0;
+}
+
+// set_trigger_effect(side, mode, params): side is "left" or "right"; mode is
+// "off", "resistance", "weapon", "vibration" or a raw mode byte; params is an
+// optional array of up to 10 bytes (0-255)
+static int lua_setTriggerEffect(lua_State* L) {
+    static const char* const SIDES[] = {"left", "right", nullptr};
+    static const char* const MODE_NAMES[] = {"off", "resistance", "weapon", "vibration", nullptr};
+    static constexpr uint8_t MODES[] = {
+        DUALSENSE_TRIGGER_OFF, DUALSENSE_TRIGGER_RESISTANCE, DUALSENSE_TRIGGER_WEAPON, DUALSENSE_TRIGGER_VIBRATION
+    };
+
+    int side = luaL_checkoption(L, 1, nullptr, SIDES);
+
+    DualSenseTriggerEffect effect;
+    if (lua_type(L, 2) == LUA_TNUMBER) {
+        effect.mode = static_cast<uint8_t>(std::clamp<lua_Integer>(luaL_checkinteger(L, 2), 0, 255));
+    } else {
+        effect.mode = MODES[luaL_checkoption(L, 2, "off", MODE_NAMES)];
+    }
+
+    if (!lua_isnoneornil(L, 3)) {
+        luaL_checktype(L, 3, LUA_TTABLE);
+        for (size_t i = 0; i < DUALSENSE_TRIGGER_PARAM_COUNT; i++) {
+            lua_rawgeti(L, 3, static_cast<lua_Integer>(i + 1));
+            if (lua_isnumber(L, -1)) {
+                effect.params[i] = static_cast<uint8_t>(std::clamp<lua_Integer>(
+                    static_cast<lua_Integer>(lua_tonumber(L, -1)), 0, 255));
+            }
+            lua_pop(L, 1);
+        }
+    }
+
+    DualSenseOutputRequest& request = engineOf(L)->getOutputRequest();
+    if (side == 0) {
+        request.hasLeftTrigger = true;
+        request.leftTrigger = effect;
+    } else {
+        request.hasRightTrigger = true;
+        request.rightTrigger = effect;
     }
     return 0;
 }
 
+// collectgarbage: the engine runs the collector after frames, so "stop",
+// "restart" and "isrunning" act on that; other options go to the base
+// library's version (upvalue 1)
+static int lua_collectGarbage(lua_State* L) {
+    const char* option = luaL_optstring(L, 1, "collect");
+    ScriptEngine* engine = engineOf(L);
+    if (std::strcmp(option, "stop") == 0 || std::strcmp(option, "restart") == 0) {
+        engine->setCollectorStopped(option[0] == 's');
+        lua_pushinteger(L, 0);
+        return 1;
+    }
+    if (std::strcmp(option, "isrunning") == 0) {
+        lua_pushboolean(L, !engine->isCollectorStopped());
+        return 1;
+    }
+    lua_pushvalue(L, lua_upvalueindex(1));
+    lua_insert(L, 1);
+    lua_call(L, lua_gettop(L) - 1, LUA_MULTRET);
+    return lua_gettop(L);
+}
+
+// Errors outside any protected call, reported like luaL_newstate's handler
+static int lua_panic(lua_State* L) {
+    const char* message = lua_tostring(L, -1);
+    std::fprintf(stderr, "PANIC: unprotected error in call to Lua API (%s)\n",
+                 message ? message : "error object is not a string");
+    return 0;
+}
+
 static int lua_clamp(lua_State* L) {
     float value = luaL_checknumber(L, 1);
     float min = luaL_checknumber(L, 2);
@@ -85,9 +505,7 @@ ScriptEngine::~ScriptEngine() {
         callCleanup();
         lua_close(m_lua);
         m_lua = nullptr;
-    }
-    if (g_currentEngine == this) {
-        g_currentEngine = nullptr;
+        m_stateBlock = nullptr;
     }
 }
 
@@ -96,11 +514,13 @@ bool ScriptEngine::initialize() {
         lua_close(m_lua);
     }
 
-    m_lua = luaL_newstate();
+    m_lua = lua_newstate(LuaArena::allocate, &m_arena);
     if (!m_lua) {
         m_lastError = "Failed to create Lua state";
         return false;
     }
+    *static_cast<ScriptEngine**>(lua_getextraspace(m_lua)) = this;
+    lua_atpanic(m_lua, lua_panic);
 
     // Open standard libraries (safe subset)
     luaL_requiref(m_lua, "_G", luaopen_base, 1);
@@ -109,21 +529,238 @@ bool ScriptEngine::initialize() {
     luaL_requiref(m_lua, "table", luaopen_table, 1);
     lua_pop(m_lua, 4);
 
+    m_processRef = m_initRef = m_cleanupRef = LUA_NOREF;
+    m_paramKeysRef = LUA_NOREF;
+    m_hasProcess = false;
+
     registerFunctions();
+    createStateUserdata();
+    createStateTable();
+    applyGcMode();
 
-    g_currentEngine = this;
     m_lastError.clear();
     return true;
 }
 
+void ScriptEngine::createStateUserdata() {
+    void* block = lua_newuserdatauv(m_lua, sizeof(ScriptInput), 1);
+    m_stateBlock = new (block) ScriptInput();
+
+    luaL_newmetatable(m_lua, STATE_METATABLE);
+    lua_pushcfunction(m_lua, lua_stateIndex);
+    lua_setfield(m_lua, -2, "__index");
+    lua_pushcfunction(m_lua, lua_stateNewIndex);
+    lua_setfield(m_lua, -2, "__newindex");
+    lua_pushlightuserdata(m_lua, m_stateBlock);
+    lua_pushcclosure(m_lua, lua_stateNext, 1);
+    lua_pushcclosure(m_lua, lua_statePairs, 1);
+    lua_setfield(m_lua, -2, "__pairs");
+    lua_pushboolean(m_lua, 0);
+    lua_setfield(m_lua, -2, "__metatable");
+    lua_setmetatable(m_lua, -2);
+    m_stateRef = luaL_ref(m_lua, LUA_REGISTRYINDEX);
+}
+
+// The table bridge's table, pre-sized for every field, and the field names as
+// Lua strings in STATE_FIELDS order, so a frame stores by key without
+// hashing a C string or growing the table. The names are also the keys
+// table's own keys, the set clearStateTable() checks against. The state
+// table's metatable is empty but protected, as the userdata's is.
+void ScriptEngine::createStateTable() {
+    const std::vector<StateField>& fields = stateFieldHash().fields();
+    lua_createtable(m_lua, static_cast<int>(fields.size()), static_cast<int>(fields.size()));
+    for (size_t i = 0; i < fields.size(); i++) {
+        lua_pushlstring(m_lua, fields[i].name.data(), fields[i].name.size());
+        lua_pushvalue(m_lua, -1);
+        lua_rawseti(m_lua, -3, static_cast<lua_Integer>(i + 1));
+        lua_pushboolean(m_lua, 1);
+        lua_rawset(m_lua, -3);
+    }
+    m_keysRef = luaL_ref(m_lua, LUA_REGISTRYINDEX);
+
+    lua_createtable(m_lua, 0, static_cast<int>(fields.size()));
+    luaL_newmetatable(m_lua, STATE_TABLE_METATABLE);
+    lua_pushboolean(m_lua, 0);
+    lua_setfield(m_lua, -2, "__metatable");
+    lua_setmetatable(m_lua, -2);
+    m_tableRef = luaL_ref(m_lua, LUA_REGISTRYINDEX);
+}
+
+// LUA_NOREF when the global is not a function
+static int refGlobalFunction(lua_State* L, const char* name) {
+    if (lua_getglobal(L, name) != LUA_TFUNCTION) {
+        lua_pop(L, 1);
+        return LUA_NOREF;
+    }
+    return luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
+void ScriptEngine::resolveFunctions() {
+    releaseFunctions();
+    m_processRef = refGlobalFunction(m_lua, "process");
+    m_initRef = refGlobalFunction(m_lua, "init");
+    m_cleanupRef = refGlobalFunction(m_lua, "cleanup");
+}
+
+void ScriptEngine::releaseFunctions() {
+    luaL_unref(m_lua, LUA_REGISTRYINDEX, m_processRef);
+    luaL_unref(m_lua, LUA_REGISTRYINDEX, m_initRef);
+    luaL_unref(m_lua, LUA_REGISTRYINDEX, m_cleanupRef);
+    m_processRef = m_initRef = m_cleanupRef = LUA_NOREF;
+}
+
+// Slot i is the i-th distinct key in script_info.parameters; the params
+// table starts out with the declared defaults
+void ScriptEngine::resolveParameters() {
+    ScriptConfig info = getScriptInfo();
+    m_paramSlots.clear();
+    for (const ScriptParameter& param : info.parameters) {
+        if (!param.key.empty()) {
+            m_paramSlots.emplace(param.key, m_paramSlots.size());
+        }
+    }
+    m_slotValues = std::vector<std::atomic<float>>(m_paramSlots.size());
+
+    luaL_unref(m_lua, LUA_REGISTRYINDEX, m_paramKeysRef);
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_paramsRef);
+    lua_createtable(m_lua, static_cast<int>(m_paramSlots.size()), 0);
+    for (const ScriptParameter& param : info.parameters) {
+        auto it = m_paramSlots.find(param.key);
+        if (it == m_paramSlots.end()) {
+            continue;
+        }
+        lua_Integer slot = static_cast<lua_Integer>(it->second) + 1;
+        if (lua_rawgeti(m_lua, -1, slot) != LUA_TNIL) {
+            lua_pop(m_lua, 1);
+            continue;   // Declared twice; the first declaration wins
+        }
+        lua_pop(m_lua, 1);
+        m_slotValues[it->second].store(param.defaultValue, std::memory_order_relaxed);
+        lua_pushlstring(m_lua, param.key.data(), param.key.size());
+        lua_pushvalue(m_lua, -1);
+        lua_rawseti(m_lua, -3, slot);
+        lua_pushnumber(m_lua, param.defaultValue);
+        lua_rawset(m_lua, -4);
+    }
+    m_paramKeysRef = luaL_ref(m_lua, LUA_REGISTRYINDEX);
+    lua_pop(m_lua, 1);
+}
+
+void ScriptEngine::flushParameters() {
+    if (!m_parametersDirty.exchange(false)) {
+        return;
+    }
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_paramsRef);
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_paramKeysRef);
+    for (size_t slot = 0; slot < m_slotValues.size(); slot++) {
+        lua_rawgeti(m_lua, -1, static_cast<lua_Integer>(slot + 1));
+        lua_pushnumber(m_lua, m_slotValues[slot].load(std::memory_order_relaxed));
+        lua_rawset(m_lua, -4);
+    }
+    lua_pop(m_lua, 1);
+    if (m_undeclaredDirty.exchange(false)) {
+        for (const auto& entry : m_parameters) {
+            lua_pushlstring(m_lua, entry.first.data(), entry.first.size());
+            lua_pushnumber(m_lua, entry.second);
+            lua_rawset(m_lua, -3);
+        }
+    }
+    lua_pop(m_lua, 1);
+}
+
+void ScriptEngine::applyGcMode() {
+    if (m_gcMode == ScriptGcMode::Generational) {
+        lua_gc(m_lua, LUA_GCGEN, GEN_MINOR_MUL, GEN_MAJOR_MUL);
+    } else {
+        lua_gc(m_lua, LUA_GCINC, 0, INC_STEP_MUL, INC_STEP_SIZE_LOG2);
+    }
+    lua_gc(m_lua, LUA_GCSTOP);
+    m_allocatedAtStep = m_arena.getBytesAllocated();
+    m_gcWindowStart = std::chrono::steady_clock::now();
+    m_gcWindowNs = 0;
+}
+
+void ScriptEngine::collectAfterFrame() {
+    uint64_t allocated = m_arena.getBytesAllocated();
+    uint64_t stepBytes = GC_MIN_STEP_BYTES;
+    if (m_gcMode == ScriptGcMode::Generational) {
+        stepBytes = std::max<uint64_t>(stepBytes, m_arena.getBytesInUse() / 100 * GEN_MINOR_MUL);
+    } else {
+        stepBytes = std::max<uint64_t>(stepBytes, uint64_t{1} << INC_STEP_SIZE_LOG2);
+    }
+    bool step = !m_collectorStopped && allocated - m_allocatedAtStep >= stepBytes;
+    if (!step && ++m_framesSinceRate < GC_RATE_CHECK_FRAMES) {
+        return;
+    }
+    m_framesSinceRate = 0;
+
+    auto now = std::chrono::steady_clock::now();
+    if (step) {
+        lua_gc(m_lua, LUA_GCSTEP, 0);
+        auto end = std::chrono::steady_clock::now();
+        uint64_t ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - now).count());
+        m_allocatedAtStep = m_arena.getBytesAllocated();
+        m_gcWindowNs += ns;
+        m_gcSteps.fetch_add(1, std::memory_order_relaxed);
+        m_gcTimeNs.fetch_add(ns, std::memory_order_relaxed);
+        if (ns > m_gcMaxNs.load(std::memory_order_relaxed)) {
+            m_gcMaxNs.store(ns, std::memory_order_relaxed);
+        }
+        now = end;
+    }
+
+    std::chrono::duration<double> window = now - m_gcWindowStart;
+    if (window.count() >= 1.0) {
+        m_gcMsPerSecond.store(m_gcWindowNs / 1e6 / window.count(), std::memory_order_relaxed);
+        m_gcWindowNs = 0;
+        m_gcWindowStart = now;
+    }
+}
+
+ScriptMemoryStats ScriptEngine::getMemoryStats() const {
+    ScriptMemoryStats stats;
+    stats.heapBytes = m_arena.getBytesInUse();
+    stats.peakBytes = m_arena.getPeakBytes();
+    stats.reservedBytes = m_arena.getReservedBytes();
+    stats.limitBytes = m_arena.getLimit();
+    stats.failedAllocations = m_arena.getFailedAllocations();
+    stats.gcSteps = m_gcSteps.load(std::memory_order_relaxed);
+    stats.gcTimeNs = m_gcTimeNs.load(std::memory_order_relaxed);
+    stats.gcMaxNs = m_gcMaxNs.load(std::memory_order_relaxed);
+    stats.gcMsPerSecond = m_gcMsPerSecond.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void ScriptEngine::resetMemoryStats() {
+    m_arena.resetPeak();
+    m_gcSteps = 0;
+    m_gcTimeNs = 0;
+    m_gcMaxNs = 0;
+}
+
 void ScriptEngine::registerFunctions() {
+    // Parameters, shared by params.<key> and get_param/set_param
+    lua_newtable(m_lua);
+    lua_pushvalue(m_lua, -1);
+    lua_setglobal(m_lua, "params");
+    lua_pushvalue(m_lua, -1);
+    m_paramsRef = luaL_ref(m_lua, LUA_REGISTRYINDEX);
+    lua_pushvalue(m_lua, -1);
+    lua_pushcclosure(m_lua, lua_getParameter, 1);
+    lua_setglobal(m_lua, "get_param");
+    lua_pushcclosure(m_lua, lua_setParameter, 1);
+    lua_setglobal(m_lua, "set_param");
+
     // Register helper functions
-    lua_register(m_lua, "get_param", lua_getParameter);
-    lua_register(m_lua, "set_param", lua_setParameter);
     lua_register(m_lua, "clamp", lua_clamp);
     lua_register(m_lua, "lerp", lua_lerp);
     lua_register(m_lua, "deadzone", lua_deadzone);
     lua_register(m_lua, "print", lua_print);
+    lua_getglobal(m_lua, "collectgarbage");
+    lua_pushcclosure(m_lua, lua_collectGarbage, 1);
+    lua_setglobal(m_lua, "collectgarbage");
+    lua_register(m_lua, "set_rumble", lua_setRumble);
+    lua_register(m_lua, "set_trigger_effect", lua_setTriggerEffect);
 }
 
 bool ScriptEngine::loadScript(const std::string& filename) {
@@ -152,7 +789,6 @@ bool ScriptEngine::loadScriptString(const std::string& script, const std::string
     }
 
     m_scriptName = name;
-    g_currentEngine = this;
 
     // Load and execute the script
     int result = luaL_loadbuffer(m_lua, script.c_str(), script.size(), name.c_str());
@@ -169,9 +805,19 @@ bool ScriptEngine::loadScriptString(const std::string& script, const std::string
         return false;
     }
 
-    // Check if process function exists
-    lua_getglobal(m_lua, "process");
-    m_hasProcess = lua_isfunction(m_lua, -1);
+    // Keep the entry points, so frames don't look them up by name
+    resolveFunctions();
+    m_hasProcess = m_processRef != LUA_NOREF;
+    resolveParameters();
+
+    // Scripts that need a real table for input ask for it
+    if (lua_getglobal(m_lua, "script_info") == LUA_TTABLE) {
+        lua_getfield(m_lua, -1, "state");
+        if (lua_type(m_lua, -1) == LUA_TSTRING && std::strcmp(lua_tostring(m_lua, -1), "table") == 0) {
+            m_stateBridge = StateBridge::Table;
+        }
+        lua_pop(m_lua, 1);
+    }
     lua_pop(m_lua, 1);
 
     if (!m_hasProcess) {
@@ -179,6 +825,10 @@ bool ScriptEngine::loadScriptString(const std::string& script, const std::string
         return false;
     }
 
+    // Start the frames with the garbage of loading gone
+    lua_gc(m_lua, LUA_GCCOLLECT);
+    m_allocatedAtStep = m_arena.getBytesAllocated();
+
     m_lastError.clear();
     return true;
 }
@@ -186,13 +836,12 @@ bool ScriptEngine::loadScriptString(const std::string& script, const std::string
 bool ScriptEngine::callInit() {
     if (!m_lua) return false;
 
-    g_currentEngine = this;
+    flushParameters();
 
-    lua_getglobal(m_lua, "init");
-    if (!lua_isfunction(m_lua, -1)) {
-        lua_pop(m_lua, 1);
+    if (m_initRef == LUA_NOREF) {
         return true;  // init is optional
     }
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_initRef);
 
     int result = lua_pcall(m_lua, 0, 0, 0);
     if (result != LUA_OK) {
@@ -207,186 +856,167 @@ bool ScriptEngine::callInit() {
 void ScriptEngine::callCleanup() {
     if (!m_lua) return;
 
-    g_currentEngine = this;
+    if (m_cleanupRef != LUA_NOREF) {
+        lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_cleanupRef);
+        if (lua_pcall(m_lua, 0, 0, 0) != LUA_OK) {
+            lua_pop(m_lua, 1);
+        }
+    }
+}
 
-    lua_getglobal(m_lua, "cleanup");
-    if (lua_isfunction(m_lua, -1)) {
-        lua_pcall(m_lua, 0, 0, 0);
-    } else {
-        lua_pop(m_lua, 1);
+void ScriptEngine::pushState(const ScriptInput& input) {
+    const std::vector<StateField>& fields = stateFieldHash().fields();
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_tableRef);
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_keysRef);
+    for (size_t i = 0; i < fields.size(); i++) {
+        lua_rawgeti(m_lua, -1, static_cast<lua_Integer>(i + 1));
+        pushStateField(m_lua, input, fields[i]);
+        lua_rawset(m_lua, -4);
     }
+    lua_pop(m_lua, 1);
 }
 
-void ScriptEngine::pushState(const NormalizedState& state) {
-    lua_newtable(m_lua);
+void ScriptEngine::clearStateTable() {
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_keysRef);
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_tableRef);
 
-    // Sticks
-    lua_pushnumber(m_lua, state.leftStickX);
-    lua_setfield(m_lua, -2, "left_x");
-    lua_pushnumber(m_lua, state.leftStickY);
-    lua_setfield(m_lua, -2, "left_y");
-    lua_pushnumber(m_lua, state.rightStickX);
-    lua_setfield(m_lua, -2, "right_x");
-    lua_pushnumber(m_lua, state.rightStickY);
-    lua_setfield(m_lua, -2, "right_y");
-
-    // Triggers
-    lua_pushnumber(m_lua, state.leftTrigger);
-    lua_setfield(m_lua, -2, "left_trigger");
-    lua_pushnumber(m_lua, state.rightTrigger);
-    lua_setfield(m_lua, -2, "right_trigger");
-
-    // Buttons
-    lua_pushboolean(m_lua, state.square);
-    lua_setfield(m_lua, -2, "square");
-    lua_pushboolean(m_lua, state.cross);
-    lua_setfield(m_lua, -2, "cross");
-    lua_pushboolean(m_lua, state.circle);
-    lua_setfield(m_lua, -2, "circle");
-    lua_pushboolean(m_lua, state.triangle);
-    lua_setfield(m_lua, -2, "triangle");
-    lua_pushboolean(m_lua, state.l1);
-    lua_setfield(m_lua, -2, "l1");
-    lua_pushboolean(m_lua, state.r1);
-    lua_setfield(m_lua, -2, "r1");
-    lua_pushboolean(m_lua, state.l2Button);
-    lua_setfield(m_lua, -2, "l2_button");
-    lua_pushboolean(m_lua, state.r2Button);
-    lua_setfield(m_lua, -2, "r2_button");
-    lua_pushboolean(m_lua, state.share);
-    lua_setfield(m_lua, -2, "share");
-    lua_pushboolean(m_lua, state.options);
-    lua_setfield(m_lua, -2, "options");
-    lua_pushboolean(m_lua, state.l3);
-    lua_setfield(m_lua, -2, "l3");
-    lua_pushboolean(m_lua, state.r3);
-    lua_setfield(m_lua, -2, "r3");
-    lua_pushboolean(m_lua, state.ps);
-    lua_setfield(m_lua, -2, "ps");
-    lua_pushboolean(m_lua, state.touchpad);
-    lua_setfield(m_lua, -2, "touchpad");
-    lua_pushboolean(m_lua, state.mute);
-    lua_setfield(m_lua, -2, "mute");
-
-    // D-Pad
-    lua_pushinteger(m_lua, state.dpad);
-    lua_setfield(m_lua, -2, "dpad");
-
-    // Gyro
-    lua_pushnumber(m_lua, state.gyroX);
-    lua_setfield(m_lua, -2, "gyro_x");
-    lua_pushnumber(m_lua, state.gyroY);
-    lua_setfield(m_lua, -2, "gyro_y");
-    lua_pushnumber(m_lua, state.gyroZ);
-    lua_setfield(m_lua, -2, "gyro_z");
-
-    // Delta time
-    lua_pushnumber(m_lua, state.deltaTime);
-    lua_setfield(m_lua, -2, "dt");
+    // Only string keys are in the set (its integer keys are the name
+    // list). Clearing a field during lua_next is allowed; the state fields
+    // are refilled by the next pushState().
+    lua_pushnil(m_lua);
+    while (lua_next(m_lua, -2)) {
+        lua_pop(m_lua, 1);
+        bool known = lua_type(m_lua, -1) == LUA_TSTRING;
+        if (known) {
+            lua_pushvalue(m_lua, -1);
+            known = lua_rawget(m_lua, -4) != LUA_TNIL;
+            lua_pop(m_lua, 1);
+        }
+        if (!known) {
+            lua_pushvalue(m_lua, -1);
+            lua_pushnil(m_lua);
+            lua_rawset(m_lua, -4);
+        }
+    }
+    lua_pop(m_lua, 2);
 }
 
 NormalizedState ScriptEngine::readState(int index) {
-    NormalizedState state;
+    ScriptInput output;
 
     if (!lua_istable(m_lua, index)) {
-        return state;
+        return output.state;
     }
 
-    // Helper to read number fields
-    auto getNumber = [this, index](const char* field, float defaultVal = 0.0f) -> float {
-        lua_getfield(m_lua, index, field);
-        float val = lua_isnumber(m_lua, -1) ? lua_tonumber(m_lua, -1) : defaultVal;
-        lua_pop(m_lua, 1);
-        return val;
-    };
-
-    // Helper to read boolean fields
-    auto getBool = [this, index](const char* field, bool defaultVal = false) -> bool {
-        lua_getfield(m_lua, index, field);
-        bool val = lua_isboolean(m_lua, -1) ? lua_toboolean(m_lua, -1) : defaultVal;
+    // Fields the script can change; the rest are passed through by process()
+    index = lua_absindex(m_lua, index);
+    const std::vector<StateField>& fields = stateFieldHash().fields();
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_keysRef);
+    for (size_t i = 0; i < fields.size(); i++) {
+        if (fields[i].inputOnly) {
+            continue;
+        }
+        lua_rawgeti(m_lua, -1, static_cast<lua_Integer>(i + 1));
+        lua_gettable(m_lua, index);
+        storeStateField(m_lua, -1, output, fields[i]);
         lua_pop(m_lua, 1);
-        return val;
-    };
-
-    // Read sticks
-    state.leftStickX = getNumber("left_x");
-    state.leftStickY = getNumber("left_y");
-    state.rightStickX = getNumber("right_x");
-    state.rightStickY = getNumber("right_y");
-
-    // Read triggers
-    state.leftTrigger = getNumber("left_trigger");
-    state.rightTrigger = getNumber("right_trigger");
-
-    // Read buttons
-    state.square = getBool("square");
-    state.cross = getBool("cross");
-    state.circle = getBool("circle");
-    state.triangle = getBool("triangle");
-    state.l1 = getBool("l1");
-    state.r1 = getBool("r1");
-    state.l2Button = getBool("l2_button");
-    state.r2Button = getBool("r2_button");
-    state.share = getBool("share");
-    state.options = getBool("options");
-    state.l3 = getBool("l3");
-    state.r3 = getBool("r3");
-    state.ps = getBool("ps");
-    state.touchpad = getBool("touchpad");
-    state.mute = getBool("mute");
-
-    // D-Pad
-    lua_getfield(m_lua, index, "dpad");
-    state.dpad = lua_isinteger(m_lua, -1) ? static_cast<uint8_t>(lua_tointeger(m_lua, -1)) : 8;
+    }
     lua_pop(m_lua, 1);
 
-    // Gyro
-    state.gyroX = getNumber("gyro_x");
-    state.gyroY = getNumber("gyro_y");
-    state.gyroZ = getNumber("gyro_z");
-
-    return state;
+    return output.state;
 }
 
-NormalizedState ScriptEngine::process(const NormalizedState& input, float deltaTime) {
+NormalizedState ScriptEngine::process(const NormalizedState& input, const InputContext& context, float deltaTime) {
     if (!m_lua || !m_hasProcess) {
         return input;
     }
 
-    g_currentEngine = this;
-
-    // Get the process function
-    lua_getglobal(m_lua, "process");
-    if (!lua_isfunction(m_lua, -1)) {
-        lua_pop(m_lua, 1);
-        return input;
+    if (m_parametersDirty.load(std::memory_order_relaxed)) {
+        flushParameters();
     }
 
-    // Create input table with delta time
-    NormalizedState inputWithDt = input;
-    inputWithDt.deltaTime = deltaTime;
-    pushState(inputWithDt);
+    lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_processRef);
+
+    // Input with delta time and the context, refilled into the state
+    // userdata or table
+    bool useUserdata = m_stateBridge == StateBridge::Userdata;
+    if (useUserdata) {
+        m_stateBlock->state = input;
+        m_stateBlock->state.deltaTime = deltaTime;
+        m_stateBlock->context = context;
+        lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_stateRef);
+    } else {
+        ScriptInput frame{input, context};
+        frame.state.deltaTime = deltaTime;
+        pushState(frame);
+    }
 
     // Call process(input) -> output
     int result = lua_pcall(m_lua, 1, 1, 0);
+    collectAfterFrame();
+
+    // Drop any fields the script added, as a fresh table would
+    if (useUserdata) {
+        lua_rawgeti(m_lua, LUA_REGISTRYINDEX, m_stateRef);
+        if (lua_getiuservalue(m_lua, -1, 1) != LUA_TNIL) {
+            lua_pushnil(m_lua);
+            lua_setiuservalue(m_lua, -3, 1);
+        }
+        lua_pop(m_lua, 2);
+    } else {
+        clearStateTable();
+    }
+
     if (result != LUA_OK) {
         m_lastError = "Script process error: " + std::string(lua_tostring(m_lua, -1));
         lua_pop(m_lua, 1);
         return input;
     }
 
-    // Read output state
-    NormalizedState output = readState(-1);
+    // Read output state. Scripts normally hand back the state they were
+    // given; a table returned instead is read like the table bridge's.
+    NormalizedState output;
+    if (useUserdata && lua_touserdata(m_lua, -1) == m_stateBlock) {
+        output = m_stateBlock->state;
+    } else {
+        output = readState(-1);
+    }
     lua_pop(m_lua, 1);
 
+    // dt is input only; the context never comes back from the script
+    output.deltaTime = deltaTime;
+
     return output;
 }
 
+DualSenseOutputRequest ScriptEngine::takeOutputRequest() {
+    DualSenseOutputRequest request = m_outputRequest;
+    m_outputRequest = DualSenseOutputRequest();
+    return request;
+}
+
 void ScriptEngine::setParameter(const std::string& name, float value) {
-    m_parameters[name] = value;
+    if (m_paramSlots.find(name) == m_paramSlots.end()) {
+        m_undeclaredDirty = true;
+    }
+    storeParameter(name, value);
+    m_parametersDirty = true;
+}
+
+void ScriptEngine::storeParameter(const std::string& name, float value) {
+    auto slot = m_paramSlots.find(name);
+    if (slot != m_paramSlots.end()) {
+        m_slotValues[slot->second].store(value, std::memory_order_relaxed);
+    } else {
+        m_parameters[name] = value;
+    }
 }
 
 float ScriptEngine::getParameter(const std::string& name, float defaultValue) {
+    auto slot = m_paramSlots.find(name);
+    if (slot != m_paramSlots.end()) {
+        return m_slotValues[slot->second].load(std::memory_order_relaxed);
+    }
     auto it = m_parameters.find(name);
     if (it != m_parameters.end()) {
         return it->second;
@@ -516,18 +1146,25 @@ ScriptConfig ScriptEngine::getScriptInfo() const {
 
 void ScriptEngine::syncParameters(const std::vector<ScriptParameter>& params) {
     for (const auto& param : params) {
-        m_parameters[param.key] = param.value;
+        setParameter(param.key, param.value);
     }
 }
 
 void ScriptEngine::applyWeaponPreset(const WeaponPreset* preset) {
     if (!preset) return;
 
-    // Map weapon preset fields to standard anti-recoil script parameters
-    m_parameters["strength_ads"] = preset->adsStrength;
-    m_parameters["strength_hipfire"] = preset->hipFireStrength;
-    m_parameters["horizontal_strength"] = preset->horizontalStrength;
-    m_parameters["ads_threshold"] = preset->adsThreshold;
-    m_parameters["fire_threshold"] = preset->fireThreshold;
-    m_parameters["smoothing"] = preset->smoothing;
+    // Map weapon preset fields to standard anti-recoil script parameters.
+    // Applied every frame, so only changes are written.
+    static const std::string KEYS[] = {
+        "strength_ads", "strength_hipfire", "horizontal_strength", "ads_threshold", "fire_threshold", "smoothing"
+    };
+    const float values[] = {
+        preset->adsStrength, preset->hipFireStrength, preset->horizontalStrength,
+        preset->adsThreshold, preset->fireThreshold, preset->smoothing
+    };
+    for (size_t i = 0; i < std::size(KEYS); i++) {
+        if (getParameter(KEYS[i], std::nanf("")) != values[i]) {
+            setParameter(KEYS[i], values[i]);
+        }
+    }
 }
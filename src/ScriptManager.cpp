@@ -13,6 +13,11 @@ ScriptManager::~ScriptManager() {
 bool ScriptManager::initialize(const std::string& scriptsFolder, ConfigManager* config) {
     m_scriptsFolder = scriptsFolder;
     m_config = config;
+    if (m_config) {
+        const AppSettings& settings = m_config->getSettings();
+        m_memoryLimit = static_cast<size_t>(std::max(settings.scriptMemoryLimitMB, 0)) * 1024 * 1024;
+        m_gcMode = settings.scriptGcMode;
+    }
 
     // Create scripts folder if it doesn't exist
     if (!fs::exists(m_scriptsFolder)) {
@@ -52,7 +57,7 @@ void ScriptManager::rescanScripts() {
             }
 
             // Try to load the script
-            script.engine = std::make_unique<ScriptEngine>();
+            script.engine = createEngine();
             if (script.engine->initialize() && script.engine->loadScript(filepath)) {
                 script.loaded = true;
 
@@ -98,7 +103,7 @@ bool ScriptManager::loadScript(const std::string& filename) {
     for (auto& script : m_scripts) {
         if (script.config.filename == filepath) {
             // Reload
-            script.engine = std::make_unique<ScriptEngine>();
+            script.engine = createEngine();
             if (script.engine->initialize() && script.engine->loadScript(filepath)) {
                 script.loaded = true;
                 script.engine->callInit();
@@ -113,7 +118,7 @@ bool ScriptManager::loadScript(const std::string& filename) {
     LoadedScript script;
     script.config.name = fs::path(filepath).stem().string();
     script.config.filename = filepath;
-    script.engine = std::make_unique<ScriptEngine>();
+    script.engine = createEngine();
 
     if (script.engine->initialize() && script.engine->loadScript(filepath)) {
         script.loaded = true;
@@ -125,6 +130,22 @@ bool ScriptManager::loadScript(const std::string& filename) {
     return false;
 }
 
+std::unique_ptr<ScriptEngine> ScriptManager::createEngine() const {
+    auto engine = std::make_unique<ScriptEngine>();
+    engine->setMemoryLimit(m_memoryLimit);
+    engine->setGcMode(m_gcMode);
+    return engine;
+}
+
+void ScriptManager::setScriptMemoryLimit(size_t bytes) {
+    m_memoryLimit = bytes;
+    for (auto& script : m_scripts) {
+        if (script.engine) {
+            script.engine->setMemoryLimit(bytes);
+        }
+    }
+}
+
 void ScriptManager::setScriptEnabled(const std::string& name, bool enabled) {
     for (auto& script : m_scripts) {
         if (script.config.name == name) {
@@ -147,8 +168,9 @@ bool ScriptManager::isScriptEnabled(const std::string& name) const {
     return false;
 }
 
-NormalizedState ScriptManager::process(const NormalizedState& input, float deltaTime) {
+NormalizedState ScriptManager::process(const NormalizedState& input, const InputContext& context, float deltaTime) {
     NormalizedState current = input;
+    m_frameOutput = DualSenseOutputRequest();
 
     // Get active weapon preset if available
     const WeaponPreset* activePreset = nullptr;
@@ -164,7 +186,10 @@ NormalizedState ScriptManager::process(const NormalizedState& input, float delta
                                   script.config.name.find("recoil") != std::string::npos)) {
                 script.engine->applyWeaponPreset(activePreset);
             }
-            current = script.engine->process(current, deltaTime);
+            auto start = std::chrono::steady_clock::now();
+            current = script.engine->process(current, context, deltaTime);
+            m_frameOutput.merge(script.engine->takeOutputRequest());
+            script.engine->getProcessHistogram().record(std::chrono::steady_clock::now() - start);
         }
     }
 
@@ -0,0 +1,335 @@
+#include "SimulatedDualSense.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace {
+    // Synthetic time step when no report rate is set (matches USB at 1 kHz)
+    constexpr double DEFAULT_REPORT_PERIOD = 0.001;
+    constexpr double PI = 3.14159265358979323846;
+
+    // Sensor clock starts 3 s before its 32-bit wrap so every run crosses it
+    constexpr uint32_t SENSOR_TIMESTAMP_START = 0xFFFFFFFFu - 9000000u;
+
+    uint8_t toAxis(double value) {
+        return static_cast<uint8_t>(std::clamp(128.0 + value * 127.0, 0.0, 255.0));
+    }
+
+    int16_t toRaw(double counts) {
+        return static_cast<int16_t>(std::clamp(std::round(counts), -32768.0, 32767.0));
+    }
+
+    TouchPoint touchAt(int id, double x, double y) {
+        TouchPoint point;
+        point.active = true;
+        point.id = static_cast<uint8_t>(id & DUALSENSE_TOUCH_ID_MASK);
+        point.x = static_cast<int16_t>(x);
+        point.y = static_cast<int16_t>(y);
+        return point;
+    }
+
+    size_t reportSizeForId(uint8_t reportId) {
+        if (reportId == DUALSENSE_USB_INPUT_REPORT_ID) return DUALSENSE_USB_INPUT_REPORT_SIZE;
+        if (reportId == DUALSENSE_BT_INPUT_REPORT_ID) return DUALSENSE_BT_INPUT_REPORT_SIZE;
+        return 0;
+    }
+}
+
+SimulatedDualSense::SimulatedDualSense(Transport transport)
+    : m_transport(transport)
+    , m_calibrationData(defaultCalibrationData()) {
+}
+
+DualSenseCalibrationData SimulatedDualSense::defaultCalibrationData() {
+    // Gyro references at +-540 deg/s, about 16.4 counts per deg/s with a few
+    // percent of spread between axes; accelerometer about 8192 counts per g
+    DualSenseCalibrationData data;
+    const int16_t gyroBias[3] = {4, -3, 2};
+    const int16_t gyroSpan[3] = {8851, 8760, 8940};
+    const int16_t accelBias[3] = {40, -25, 10};
+    const int16_t accelSpan[3] = {8192, 8150, 8230};
+    for (int axis = 0; axis < 3; axis++) {
+        data.gyroBias[axis] = gyroBias[axis];
+        data.gyroPlus[axis] = static_cast<int16_t>(gyroBias[axis] + gyroSpan[axis]);
+        data.gyroMinus[axis] = static_cast<int16_t>(gyroBias[axis] - gyroSpan[axis]);
+        data.accelPlus[axis] = static_cast<int16_t>(accelBias[axis] + accelSpan[axis]);
+        data.accelMinus[axis] = static_cast<int16_t>(accelBias[axis] - accelSpan[axis]);
+    }
+    data.gyroSpeedPlus = 540;
+    data.gyroSpeedMinus = 540;
+    return data;
+}
+
+SimulatedDualSense::~SimulatedDualSense() {
+    disconnect();
+}
+
+bool SimulatedDualSense::loadReportFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    // Validate the framing up front so update() never has to
+    size_t offset = 0;
+    while (offset < data.size()) {
+        size_t size = reportSizeForId(data[offset]);
+        if (size == 0 || offset + size > data.size()) {
+            return false;
+        }
+        offset += size;
+    }
+
+    if (data.empty()) {
+        return false;
+    }
+
+    m_replayData = std::move(data);
+    m_replayOffset = 0;
+    return true;
+}
+
+bool SimulatedDualSense::connect() {
+    if (!m_pluggedIn) {
+        return false;
+    }
+    m_connected = true;
+    m_reportCount = 0;
+    m_replayOffset = 0;
+    m_state = ControllerState();
+    m_nextReportTime = std::chrono::steady_clock::now();
+
+    // Read the calibration through the same report parser as the hardware
+    m_calibration = DualSenseCalibration();
+    if (m_calibrationAvailable) {
+        bool bluetooth = m_transport == Transport::Bluetooth;
+        uint8_t report[DUALSENSE_CALIBRATION_REPORT_SIZE];
+        size_t size = encodeDualSenseCalibrationReport(m_calibrationData, bluetooth, report, sizeof(report));
+        parseDualSenseCalibrationReport(report, size, bluetooth, m_calibration);
+    }
+
+    m_outputSequence = 0;
+    m_outputScheduler.start([this](const DualSenseOutputState& state) {
+        return writeOutputReport(state);
+    });
+    return true;
+}
+
+void SimulatedDualSense::disconnect() {
+    m_outputScheduler.stop();
+    m_connected = false;
+}
+
+bool SimulatedDualSense::update(int timeoutMs) {
+    if (!m_connected) {
+        return false;
+    }
+    if (!m_pluggedIn) {
+        // Read error on the next poll, like a pulled cable
+        disconnect();
+        return false;
+    }
+
+    if (m_reportRateHz > 0.0f) {
+        // Emulate the device's report cadence
+        auto now = std::chrono::steady_clock::now();
+        if (now < m_nextReportTime) {
+            if (timeoutMs <= 0) {
+                return false;
+            }
+            auto deadline = now + std::chrono::milliseconds(timeoutMs);
+            if (deadline < m_nextReportTime) {
+                std::this_thread::sleep_until(deadline);
+                return false;
+            }
+            std::this_thread::sleep_until(m_nextReportTime);
+        }
+
+        auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(1.0 / m_reportRateHz));
+        m_nextReportTime += period;
+    }
+
+    if (!produceReport()) {
+        return false;
+    }
+
+    if (!m_validator.accept(m_reportBuffer, m_reportSize) ||
+        !parseDualSenseReport(m_reportBuffer, m_reportSize, m_state)) {
+        return false;
+    }
+
+    // Host timestamp, same as the physical controller
+    auto now = std::chrono::high_resolution_clock::now();
+    m_state.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+        now.time_since_epoch()).count();
+
+    m_reportCount++;
+    return true;
+}
+
+void SimulatedDualSense::setLEDColor(uint8_t r, uint8_t g, uint8_t b) {
+    m_outputScheduler.update([r, g, b](DualSenseOutputState& state) {
+        state.ledR = r;
+        state.ledG = g;
+        state.ledB = b;
+    });
+}
+
+void SimulatedDualSense::setPlayerLED(uint8_t pattern) {
+    m_outputScheduler.update([pattern](DualSenseOutputState& state) {
+        state.playerLED = pattern;
+    });
+}
+
+void SimulatedDualSense::requestOutput(const DualSenseOutputRequest& request) {
+    m_outputScheduler.update([&request](DualSenseOutputState& state) {
+        request.applyTo(state);
+    });
+}
+
+void SimulatedDualSense::setOutputCapture(bool enabled) {
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    m_captureOutput = enabled;
+    if (!enabled) {
+        m_capturedOutputReports.clear();
+    }
+}
+
+std::vector<std::vector<uint8_t>> SimulatedDualSense::takeCapturedOutputReports() {
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    return std::move(m_capturedOutputReports);
+}
+
+std::vector<uint8_t> SimulatedDualSense::getLastOutputReport() const {
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    return m_lastOutputReport;
+}
+
+bool SimulatedDualSense::writeOutputReport(const DualSenseOutputState& state) {
+    uint8_t report[DUALSENSE_MAX_OUTPUT_REPORT_SIZE];
+    size_t size = encodeDualSenseOutputReport(state, m_transport == Transport::Bluetooth, m_outputSequence,
+                                              report, sizeof(report));
+    m_outputSequence = (m_outputSequence + 1) & 0x0F;
+
+    int latencyUs = m_outputWriteLatencyUs;
+    if (latencyUs > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(latencyUs));
+    }
+
+    std::lock_guard<std::mutex> lock(m_outputMutex);
+    m_lastOutputReport.assign(report, report + size);
+    if (m_captureOutput) {
+        m_capturedOutputReports.push_back(m_lastOutputReport);
+    }
+    return true;
+}
+
+bool SimulatedDualSense::produceReport() {
+    if (!m_replayData.empty()) {
+        if (m_replayOffset >= m_replayData.size()) {
+            m_replayOffset = 0;
+        }
+        size_t size = reportSizeForId(m_replayData[m_replayOffset]);
+        std::memcpy(m_reportBuffer, &m_replayData[m_replayOffset], size);
+        m_reportSize = size;
+        m_replayOffset += size;
+        return true;
+    }
+
+    ControllerState generated;
+    generateState(generated);
+    m_reportSize = encodeDualSenseReport(generated, m_transport == Transport::Bluetooth,
+                                         m_reportBuffer, sizeof(m_reportBuffer));
+    return m_reportSize > 0;
+}
+
+void SimulatedDualSense::generateState(ControllerState& state) const {
+    // Synthetic time derived from the report index keeps runs reproducible
+    double period = m_reportRateHz > 0.0f ? 1.0 / m_reportRateHz : DEFAULT_REPORT_PERIOD;
+    double t = static_cast<double>(m_reportCount) * period;
+
+    // Device clock advances by exactly one period per report, like the real
+    // controller's, regardless of host scheduling
+    state.sensorTimestamp = SENSOR_TIMESTAMP_START +
+        static_cast<uint32_t>(static_cast<uint64_t>(t / (DUALSENSE_SENSOR_TICK_US * 1e-6) + 0.5));
+
+    // Left stick: slow circle (pushes fully forward once per cycle)
+    state.leftStickX = toAxis(0.9 * std::sin(2.0 * PI * t / 2.0));
+    state.leftStickY = toAxis(-0.9 * std::cos(2.0 * PI * t / 2.0));
+
+    // Right stick: figure eight
+    state.rightStickX = toAxis(0.6 * std::sin(2.0 * PI * t / 1.5));
+    state.rightStickY = toAxis(0.4 * std::sin(4.0 * PI * t / 1.5));
+
+    // Triggers: R2 held for half of each second (firing), L2 ramps (ADS)
+    double phase = std::fmod(t, 1.0);
+    state.rightTrigger = phase < 0.5 ? 255 : 0;
+    state.leftTrigger = static_cast<uint8_t>(std::clamp(std::fmod(t, 3.0) / 3.0 * 255.0, 0.0, 255.0));
+    state.setButton(BUTTON_L2, state.leftTrigger > 0);
+    state.setButton(BUTTON_R2, state.rightTrigger > 0);
+
+    // Buttons: cross tapped every 500 ms, square held every other second
+    state.setButton(BUTTON_CROSS, std::fmod(t, 0.5) < 0.1);
+    state.setButton(BUTTON_SQUARE, static_cast<int>(t) % 2 == 1);
+    state.setButton(BUTTON_L1, std::fmod(t, 4.0) >= 3.0);
+
+    // D-Pad cycles through all directions plus released
+    state.dpad = static_cast<uint8_t>(static_cast<int>(t * 4.0) % 9);
+
+    // Gyro/accel: gentle sway (deg/s) with gravity on Y (g), converted to raw
+    // counts through this unit's sensitivity and bias
+    const DualSenseCalibrationData& cal = m_calibrationData;
+    const double gyroRate[3] = {
+        50.0 * std::sin(2.0 * PI * t * 0.7),
+        36.0 * std::cos(2.0 * PI * t * 0.5),
+        12.0 * std::sin(2.0 * PI * t * 1.3)
+    };
+    const double accel[3] = {
+        0.04 * std::sin(2.0 * PI * t * 0.2),
+        1.0,
+        0.04 * std::cos(2.0 * PI * t * 0.2)
+    };
+    int16_t* gyroOut[3] = {&state.gyroX, &state.gyroY, &state.gyroZ};
+    int16_t* accelOut[3] = {&state.accelX, &state.accelY, &state.accelZ};
+    double gyroSpeed = static_cast<double>(cal.gyroSpeedPlus) + cal.gyroSpeedMinus;
+    for (int axis = 0; axis < 3; axis++) {
+        double gyroCounts = (static_cast<double>(cal.gyroPlus[axis]) - cal.gyroMinus[axis]) / gyroSpeed;
+        *gyroOut[axis] = toRaw(gyroRate[axis] * gyroCounts + cal.gyroBias[axis]);
+        double accelCounts = (static_cast<double>(cal.accelPlus[axis]) - cal.accelMinus[axis]) / 2.0;
+        double accelBias = (static_cast<double>(cal.accelPlus[axis]) + cal.accelMinus[axis]) / 2.0;
+        *accelOut[axis] = toRaw(accel[axis] * accelCounts + accelBias);
+    }
+
+    // Touchpad: every 4 s a tap, a swipe right, a two-finger pinch out and
+    // a two-finger tap. Each new finger gets the next tracking ID.
+    double touchPhase = std::fmod(t, 4.0);
+    int touchBase = static_cast<int>(t / 4.0) * 6;
+    TouchPoint& first = state.touch[0];
+    TouchPoint& second = state.touch[1];
+    first = TouchPoint();
+    second = TouchPoint();
+    if (touchPhase < 0.08) {
+        first = touchAt(touchBase, 960.0, 540.0);
+    } else if (touchPhase >= 0.5 && touchPhase < 0.8) {
+        first = touchAt(touchBase + 1, 400.0 + (touchPhase - 0.5) / 0.3 * 1100.0, 540.0);
+    } else if (touchPhase >= 1.5 && touchPhase < 2.3) {
+        double spread = (touchPhase - 1.5) / 0.8 * 500.0;
+        first = touchAt(touchBase + 2, 800.0 - spread, 540.0);
+        second = touchAt(touchBase + 3, 1120.0 + spread, 540.0);
+    } else if (touchPhase >= 3.0 && touchPhase < 3.08) {
+        first = touchAt(touchBase + 4, 800.0, 540.0);
+        second = touchAt(touchBase + 5, 1120.0, 540.0);
+    }
+}
+
+NormalizedState SimulatedDualSense::getNormalizedState() const {
+    return normalizeControllerState(m_state, m_calibration);
+}
+
+std::string SimulatedDualSense::getName() const {
+    return m_transport == Transport::Bluetooth ? "Simulated DualSense (Bluetooth)"
+                                               : "Simulated DualSense (USB)";
+}
@@ -0,0 +1,217 @@
+#include "ThreadTuning.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <avrt.h>
+#include <timeapi.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <cstring>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+#endif
+
+namespace {
+#ifndef _WIN32
+    // SCHED_FIFO priorities: above SCHED_OTHER, well below kernel threads (50+)
+    int fifoPriorityFor(ThreadPriority priority) {
+        switch (priority) {
+            case ThreadPriority::High: return 1;
+            case ThreadPriority::Games: return 10;
+            case ThreadPriority::ProAudio: return 40;
+            default: return 0;
+        }
+    }
+#endif
+}
+
+const char* getThreadPriorityName(ThreadPriority priority) {
+    switch (priority) {
+        case ThreadPriority::Normal: return "Normal";
+        case ThreadPriority::High: return "High";
+        case ThreadPriority::Games: return "Games";
+        case ThreadPriority::ProAudio: return "Pro Audio";
+    }
+    return "Unknown";
+}
+
+ThreadTuningScope::ThreadTuningScope(const ThreadTuning& tuning) {
+    if (tuning.priority != ThreadPriority::Normal) {
+        applyPriority(tuning.priority);
+    }
+    if (tuning.affinityMask != 0) {
+        applyAffinity(tuning.affinityMask);
+    }
+    if (tuning.timerResolutionUs > 0) {
+        applyTimerResolution(tuning.timerResolutionUs);
+    }
+}
+
+void ThreadTuningScope::report(const std::string& what, bool ok, const std::string& detail) {
+    if (!m_status.empty()) {
+        m_status += "\n";
+    }
+    m_status += what + ": " + (ok ? "ok" : "failed");
+    if (!detail.empty()) {
+        m_status += " (" + detail + ")";
+    }
+    if (!ok) {
+        m_allApplied = false;
+    }
+}
+
+#ifdef _WIN32
+
+ThreadTuningScope::~ThreadTuningScope() {
+    if (m_mmcssHandle) {
+        AvRevertMmThreadCharacteristics(m_mmcssHandle);
+    }
+    if (m_restoreThreadPriority) {
+        SetThreadPriority(GetCurrentThread(), m_oldThreadPriority);
+    }
+    if (m_restoreAffinity) {
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(m_oldAffinity));
+    }
+    if (m_timerPeriodMs > 0) {
+        timeEndPeriod(m_timerPeriodMs);
+    }
+}
+
+void ThreadTuningScope::applyPriority(ThreadPriority priority) {
+    const wchar_t* task = nullptr;
+    AVRT_PRIORITY avrtPriority = AVRT_PRIORITY_NORMAL;
+    if (priority == ThreadPriority::Games) {
+        task = L"Games";
+        avrtPriority = AVRT_PRIORITY_HIGH;
+    } else if (priority == ThreadPriority::ProAudio) {
+        task = L"Pro Audio";
+        avrtPriority = AVRT_PRIORITY_CRITICAL;
+    }
+
+    if (task) {
+        DWORD taskIndex = 0;
+        m_mmcssHandle = AvSetMmThreadCharacteristicsW(task, &taskIndex);
+        if (m_mmcssHandle) {
+            AvSetMmThreadPriority(m_mmcssHandle, avrtPriority);
+            report(std::string("MMCSS ") + getThreadPriorityName(priority), true);
+            return;
+        }
+        // MMCSS service unavailable - fall back to a plain thread priority
+        report(std::string("MMCSS ") + getThreadPriorityName(priority), false,
+               "error " + std::to_string(GetLastError()) + ", falling back to TIME_CRITICAL");
+    }
+
+    m_oldThreadPriority = GetThreadPriority(GetCurrentThread());
+    int threadPriority = task ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST;
+    bool ok = SetThreadPriority(GetCurrentThread(), threadPriority) != 0;
+    DWORD error = ok ? 0 : GetLastError();
+    m_restoreThreadPriority = ok;
+    report(task ? "Thread priority TIME_CRITICAL (MMCSS fallback)" : "Thread priority High", ok,
+           ok ? "" : "error " + std::to_string(error));
+}
+
+void ThreadTuningScope::applyAffinity(uint64_t mask) {
+    DWORD_PTR previous = SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask));
+    if (previous != 0) {
+        m_oldAffinity = previous;
+        m_restoreAffinity = true;
+    }
+    report("CPU affinity", previous != 0, previous != 0 ? "" : "no CPU in mask");
+}
+
+void ThreadTuningScope::applyTimerResolution(int microseconds) {
+    // timeBeginPeriod works in whole milliseconds
+    UINT periodMs = static_cast<UINT>(std::max(1, (microseconds + 999) / 1000));
+    bool ok = timeBeginPeriod(periodMs) == TIMERR_NOERROR;
+    if (ok) {
+        m_timerPeriodMs = periodMs;
+    }
+    report("Timer resolution", ok, std::to_string(periodMs) + " ms");
+}
+
+#else
+
+ThreadTuningScope::~ThreadTuningScope() {
+    if (m_restoreScheduler) {
+        sched_param param = {};
+        param.sched_priority = m_oldPriority;
+        pthread_setschedparam(pthread_self(), m_oldPolicy, &param);
+    }
+#ifdef __linux__
+    if (m_restoreAffinity) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < 64; cpu++) {
+            if (m_oldAffinity & (1ull << cpu)) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+    if (m_restoreTimerSlack) {
+        prctl(PR_SET_TIMERSLACK, m_oldTimerSlackNs, 0, 0, 0);
+    }
+#endif
+}
+
+void ThreadTuningScope::applyPriority(ThreadPriority priority) {
+    sched_param oldParam = {};
+    pthread_getschedparam(pthread_self(), &m_oldPolicy, &oldParam);
+    m_oldPriority = oldParam.sched_priority;
+
+    sched_param param = {};
+    param.sched_priority = fifoPriorityFor(priority);
+    int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    m_restoreScheduler = (result == 0);
+    report("SCHED_FIFO " + std::to_string(param.sched_priority), result == 0,
+           result == 0 ? "" : std::strerror(result));
+}
+
+void ThreadTuningScope::applyAffinity(uint64_t mask) {
+#ifdef __linux__
+    cpu_set_t oldSet;
+    CPU_ZERO(&oldSet);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(oldSet), &oldSet) == 0) {
+        for (int cpu = 0; cpu < 64; cpu++) {
+            if (CPU_ISSET(cpu, &oldSet)) {
+                m_oldAffinity |= 1ull << cpu;
+            }
+        }
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu = 0; cpu < 64; cpu++) {
+        if (mask & (1ull << cpu)) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    m_restoreAffinity = (result == 0 && m_oldAffinity != 0);
+    report("CPU affinity", result == 0, result == 0 ? "" : std::strerror(result));
+#else
+    (void)mask;
+    report("CPU affinity", false, "not supported on this platform");
+#endif
+}
+
+void ThreadTuningScope::applyTimerResolution(int microseconds) {
+#ifdef __linux__
+    // Linux has no global timer rate; timer slack bounds how late a sleep may wake
+    int oldSlack = prctl(PR_GET_TIMERSLACK, 0, 0, 0, 0);
+    unsigned long slackNs = static_cast<unsigned long>(microseconds) * 1000;
+    bool ok = oldSlack >= 0 && prctl(PR_SET_TIMERSLACK, slackNs, 0, 0, 0) == 0;
+    if (ok) {
+        m_oldTimerSlackNs = static_cast<unsigned long>(oldSlack);
+        m_restoreTimerSlack = true;
+    }
+    report("Timer slack", ok, std::to_string(microseconds) + " us");
+#else
+    (void)microseconds;
+    report("Timer resolution", false, "not supported on this platform");
+#endif
+}
+
+#endif
@@ -0,0 +1,113 @@
+#include "TouchGestures.h"
+#include <cmath>
+
+uint8_t TouchGestureRecognizer::update(const TouchPoint (&touch)[TOUCH_POINT_COUNT], float deltaTime) {
+    int contacts = 0;
+    for (const TouchPoint& point : touch) {
+        contacts += point.active ? 1 : 0;
+    }
+
+    if (contacts == 0) {
+        for (Track& track : m_tracks) {
+            track.active = false;
+        }
+        m_pinchTracking = false;
+        if (!m_inGesture) {
+            return 0;
+        }
+        m_inGesture = false;
+        return finishGesture();
+    }
+
+    if (!m_inGesture) {
+        m_inGesture = true;
+        m_elapsed = 0.0f;
+        m_maxContacts = 0;
+        m_maxTravel = 0.0f;
+        m_swipeX = 0.0f;
+        m_swipeY = 0.0f;
+        m_pinched = false;
+    } else {
+        m_elapsed += deltaTime;
+    }
+    m_maxContacts = std::max(m_maxContacts, contacts);
+
+    for (int i = 0; i < TOUCH_POINT_COUNT; i++) {
+        const TouchPoint& point = touch[i];
+        Track& track = m_tracks[i];
+        if (!point.active) {
+            track.active = false;
+            continue;
+        }
+
+        // A new tracking ID in the same slot is a different finger, even if
+        // the lift between them fell between two reports
+        if (!track.active || track.id != point.id) {
+            track.active = true;
+            track.id = point.id;
+            track.startX = point.x;
+            track.startY = point.y;
+        }
+        track.x = point.x;
+        track.y = point.y;
+
+        float dx = track.x - track.startX;
+        float dy = track.y - track.startY;
+        m_maxTravel = std::max(m_maxTravel, std::hypot(dx, dy));
+        if (contacts == 1) {
+            m_swipeX = dx;
+            m_swipeY = dy;
+        }
+    }
+
+    uint8_t events = 0;
+    if (contacts == TOUCH_POINT_COUNT) {
+        float distance = std::hypot(m_tracks[1].x - m_tracks[0].x, m_tracks[1].y - m_tracks[0].y);
+        if (!m_pinchTracking) {
+            m_pinchTracking = true;
+            m_pinchBase = distance;
+        } else if (distance - m_pinchBase >= PINCH_STEP) {
+            events |= GESTURE_PINCH_OUT;
+            m_pinchBase = distance;
+            m_pinched = true;
+        } else if (m_pinchBase - distance >= PINCH_STEP) {
+            events |= GESTURE_PINCH_IN;
+            m_pinchBase = distance;
+            m_pinched = true;
+        }
+    } else {
+        m_pinchTracking = false;
+    }
+    return events;
+}
+
+uint8_t TouchGestureRecognizer::finishGesture() const {
+    if (m_pinched) {
+        return 0;
+    }
+
+    if (m_elapsed <= TAP_MAX_SECONDS && m_maxTravel <= TAP_MAX_TRAVEL) {
+        return m_maxContacts > 1 ? GESTURE_TWO_FINGER_TAP : GESTURE_TAP;
+    }
+
+    if (m_maxContacts == 1 && m_elapsed <= SWIPE_MAX_SECONDS) {
+        // Touchpad Y grows downwards
+        if (std::abs(m_swipeX) >= std::abs(m_swipeY)) {
+            if (std::abs(m_swipeX) >= SWIPE_MIN_TRAVEL) {
+                return m_swipeX > 0.0f ? GESTURE_SWIPE_RIGHT : GESTURE_SWIPE_LEFT;
+            }
+        } else if (std::abs(m_swipeY) >= SWIPE_MIN_TRAVEL) {
+            return m_swipeY > 0.0f ? GESTURE_SWIPE_DOWN : GESTURE_SWIPE_UP;
+        }
+    }
+    return 0;
+}
+
+void TouchGestureRecognizer::reset() {
+    for (Track& track : m_tracks) {
+        track = Track();
+    }
+    m_inGesture = false;
+    m_pinchTracking = false;
+    m_pinched = false;
+}
@@ -0,0 +1,110 @@
+#include "XusbReport.h"
+#include <array>
+
+namespace {
+    // PS5 -> Xbox mapping:
+    // Cross -> A, Circle -> B, Square -> X, Triangle -> Y
+    // L1 -> LB, R1 -> RB, L3 -> LS, R3 -> RS
+    // Share -> Back, Options -> Start, PS -> Guide
+    // L2/R2 buttons, touchpad click and mute have no XUSB equivalent
+    struct ButtonMapping {
+        uint32_t button;
+        uint16_t xusb;
+    };
+
+    constexpr ButtonMapping BUTTON_MAP[] = {
+        {BUTTON_CROSS, XUSB_BUTTON_A},
+        {BUTTON_CIRCLE, XUSB_BUTTON_B},
+        {BUTTON_SQUARE, XUSB_BUTTON_X},
+        {BUTTON_TRIANGLE, XUSB_BUTTON_Y},
+        {BUTTON_L1, XUSB_BUTTON_LEFT_SHOULDER},
+        {BUTTON_R1, XUSB_BUTTON_RIGHT_SHOULDER},
+        {BUTTON_L3, XUSB_BUTTON_LEFT_THUMB},
+        {BUTTON_R3, XUSB_BUTTON_RIGHT_THUMB},
+        {BUTTON_SHARE, XUSB_BUTTON_BACK},
+        {BUTTON_OPTIONS, XUSB_BUTTON_START},
+        {BUTTON_PS, XUSB_BUTTON_GUIDE}
+    };
+
+    // XUSB bits for every value of one byte of the button mask
+    constexpr std::array<uint16_t, 256> buildByteTable(int shift) {
+        std::array<uint16_t, 256> table = {};
+        for (int value = 0; value < 256; value++) {
+            uint32_t buttons = static_cast<uint32_t>(value) << shift;
+            uint16_t xusb = 0;
+            for (const ButtonMapping& mapping : BUTTON_MAP) {
+                if (buttons & mapping.button) {
+                    xusb |= mapping.xusb;
+                }
+            }
+            table[value] = xusb;
+        }
+        return table;
+    }
+
+    constexpr std::array<uint16_t, 256> BUTTONS_LOW_TO_XUSB = buildByteTable(0);
+    constexpr std::array<uint16_t, 256> BUTTONS_HIGH_TO_XUSB = buildByteTable(8);
+    static_assert(BUTTON_COUNT <= 16, "Button mask must fit the two lookup bytes");
+
+    // PS5 D-Pad uses 0-7 for directions clockwise from up, 8 = released
+    constexpr uint16_t DPAD_TO_XUSB[9] = {
+        XUSB_BUTTON_DPAD_UP,
+        XUSB_BUTTON_DPAD_UP | XUSB_BUTTON_DPAD_RIGHT,
+        XUSB_BUTTON_DPAD_RIGHT,
+        XUSB_BUTTON_DPAD_DOWN | XUSB_BUTTON_DPAD_RIGHT,
+        XUSB_BUTTON_DPAD_DOWN,
+        XUSB_BUTTON_DPAD_DOWN | XUSB_BUTTON_DPAD_LEFT,
+        XUSB_BUTTON_DPAD_LEFT,
+        XUSB_BUTTON_DPAD_UP | XUSB_BUTTON_DPAD_LEFT,
+        0
+    };
+}
+
+XusbReport toXusbReport(const NormalizedState& state) {
+    XusbReport report;
+
+    // Convert normalized sticks (-1.0 to 1.0) to Xbox format (-32768 to 32767)
+    report.sThumbLX = static_cast<int16_t>(std::clamp(state.leftStickX * 32767.0f, -32768.0f, 32767.0f));
+    report.sThumbLY = static_cast<int16_t>(std::clamp(-state.leftStickY * 32767.0f, -32768.0f, 32767.0f));  // Inverted Y
+    report.sThumbRX = static_cast<int16_t>(std::clamp(state.rightStickX * 32767.0f, -32768.0f, 32767.0f));
+    report.sThumbRY = static_cast<int16_t>(std::clamp(-state.rightStickY * 32767.0f, -32768.0f, 32767.0f));  // Inverted Y
+
+    // Convert triggers (0.0 to 1.0) to Xbox format (0 to 255)
+    report.bLeftTrigger = static_cast<uint8_t>(std::clamp(state.leftTrigger * 255.0f, 0.0f, 255.0f));
+    report.bRightTrigger = static_cast<uint8_t>(std::clamp(state.rightTrigger * 255.0f, 0.0f, 255.0f));
+
+    // Map buttons and D-Pad by table lookup
+    report.wButtons = static_cast<uint16_t>(BUTTONS_LOW_TO_XUSB[state.buttons & 0xFF] |
+                                            BUTTONS_HIGH_TO_XUSB[(state.buttons >> 8) & 0xFF] |
+                                            DPAD_TO_XUSB[state.dpad < 8 ? state.dpad : 8]);
+
+    return report;
+}
+
+bool XusbSubmitFilter::shouldSubmit(const XusbReport& report, Clock::time_point now) {
+    if (m_hasLast && report == m_last) {
+        int keepaliveMs = m_keepaliveMs;
+        if (keepaliveMs <= 0 || now - m_lastSubmit < std::chrono::milliseconds(keepaliveMs)) {
+            m_suppressed.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    m_last = report;
+    m_hasLast = true;
+    m_lastSubmit = now;
+    m_submitted.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+OutputSubmitStats XusbSubmitFilter::getStats() const {
+    OutputSubmitStats stats;
+    stats.submitted = m_submitted.load(std::memory_order_relaxed);
+    stats.suppressed = m_suppressed.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void XusbSubmitFilter::resetStats() {
+    m_submitted.store(0, std::memory_order_relaxed);
+    m_suppressed.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,450 @@
+// Frame snapshot, latency histograms, backlog draining, the output channel,
+// hotplug, and scripts seeing haptics, gestures and calibrated motion through
+// the full pipeline
+
+#include "TestHarness.h"
+#include "BenchSupport.h"
+#include "InputProcessor.h"
+#include "PipelinePool.h"
+#include "SimulatedDualSense.h"
+#include "CaptureSink.h"
+#include "StateSnapshot.h"
+#include "LatencyHistogram.h"
+#include "PacingScheduler.h"
+#include "MotionFusion.h"
+#include "TouchGestures.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace {
+
+// A script folder under the temp directory, removed again at the end of the test
+class ScriptFolder {
+public:
+    explicit ScriptFolder(const char* name) : m_path(std::filesystem::temp_directory_path() / name) {
+        std::filesystem::remove_all(m_path);
+        std::filesystem::create_directories(m_path);
+    }
+    ~ScriptFolder() { std::filesystem::remove_all(m_path); }
+
+    void write(const char* file, const std::string& source) { std::ofstream(m_path / file) << source; }
+    std::string path() const { return m_path.string(); }
+
+private:
+    std::filesystem::path m_path;
+};
+
+void enableAllScripts(InputProcessor& processor) {
+    for (auto& script : processor.getScriptManager().getScripts()) {
+        processor.getScriptManager().setScriptEnabled(script.config.name, true);
+    }
+}
+
+void runFor(InputProcessor& processor, std::chrono::milliseconds duration) {
+    auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        processor.update(10);
+    }
+}
+
+}  // namespace
+
+// An 8 kHz writer and two readers: every field of a frame is written with
+// the same counter value, so a reader seeing two values saw a torn frame
+TEST(SnapshotReadsAreNeverTorn) {
+    SeqLock<FrameSnapshot> snapshot;
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> torn{0};
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 2; r++) {
+        readers.emplace_back([&]() {
+            while (!stop.load(std::memory_order_relaxed)) {
+                FrameSnapshot frame = snapshot.load();
+                float expected = frame.input.leftStickX;
+                if (frame.input.deltaTime != expected || frame.input.gyroZ != expected ||
+                    frame.output.leftStickX != expected || frame.output.rightTrigger != expected ||
+                    frame.output.deltaTime != expected) {
+                    torn.fetch_add(1, std::memory_order_relaxed);
+                }
+                reads.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(500);
+    auto next = std::chrono::steady_clock::now();
+    for (uint64_t writes = 1; std::chrono::steady_clock::now() < end; writes++) {
+        float value = static_cast<float>(writes);
+        FrameSnapshot frame;
+        frame.input.leftStickX = frame.input.deltaTime = frame.input.gyroZ = value;
+        frame.output.leftStickX = frame.output.rightTrigger = frame.output.deltaTime = value;
+        snapshot.store(frame);
+        next += std::chrono::microseconds(125);
+        std::this_thread::sleep_until(next);
+    }
+    stop = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(reads.load() > 0);
+    CHECK(torn.load() == 0);
+}
+
+// Recorded values come back within the histogram's ~6% bucket resolution
+TEST(HistogramPercentiles) {
+    LatencyHistogram histogram;
+    for (uint64_t ns = 1; ns <= 100000; ns++) {
+        histogram.record(ns);
+    }
+    LatencyHistogram::Summary s = histogram.summarize();
+    CHECK(s.count == 100000);
+    CHECK(s.maxNs == 100000);
+    CHECK(std::abs(s.meanNs - 50000.5) < 1.0);
+    CHECK(std::abs(static_cast<double>(s.p50Ns) - 50000.0) <= 50000.0 * 0.07);
+    CHECK(std::abs(static_cast<double>(s.p99Ns) - 99000.0) <= 99000.0 * 0.07);
+
+    histogram.reset();
+    CHECK(histogram.count() == 0 && histogram.percentile(0.5) == 0);
+}
+
+// Stage names carry script names, which may hold quotes, commas, backslashes
+// and control characters
+TEST(LatencyDumpsEscapeStageNames) {
+    LatencyHistogram histogram;
+    histogram.record(1000);
+    std::vector<LatencyReportEntry> entries = {{"Script: \"Aim\", v2 C:\\x\ty", histogram.summarize()}};
+
+    std::ostringstream csv;
+    writeLatencyCsv(csv, entries);
+    CHECK(csv.str().find("\n\"Script: \"\"Aim\"\", v2 C:\\x\ty\",1,") != std::string::npos);
+
+    std::ostringstream json;
+    writeLatencyJson(json, entries);
+    CHECK(json.str().find("\"stage\": \"Script: \\\"Aim\\\", v2 C:\\\\x\\ty\",") != std::string::npos);
+}
+
+// Reports queue up behind periodic stalls; every one must be processed or,
+// under LatestOnly, counted as coalesced
+TEST(BacklogAccountsForEveryReport) {
+    ScriptFolder folder("ps5scripts_tests_backlog");
+    for (BacklogPolicy policy : {BacklogPolicy::LatestOnly, BacklogPolicy::ReplayAll}) {
+        auto device = std::make_unique<SimulatedDualSense>();
+        device->setReportRate(1000.0f);
+        SimulatedDualSense* devicePtr = device.get();
+        auto sink = std::make_unique<NullSink>();
+        NullSink* sinkPtr = sink.get();
+        InputProcessor processor(std::move(device), std::move(sink));
+        CHECK(processor.initialize(nullptr, folder.path()));
+        processor.setBacklogPolicy(policy);
+
+        for (int i = 0; i < 20; i++) {
+            processor.update(10);
+        }
+        uint64_t reportsBefore = devicePtr->getReportCount();
+        uint64_t framesBefore = sinkPtr->getFrameCount();
+        uint64_t coalescedBefore = processor.getBacklogStats().coalesced;
+        for (int stall = 0; stall < 5; stall++) {
+            runFor(processor, std::chrono::milliseconds(100));
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        }
+        runFor(processor, std::chrono::milliseconds(20));
+
+        uint64_t reports = devicePtr->getReportCount() - reportsBefore;
+        uint64_t frames = sinkPtr->getFrameCount() - framesBefore;
+        uint64_t coalesced = processor.getBacklogStats().coalesced - coalescedBefore;
+        CHECK(frames + coalesced == reports);
+        CHECK(policy == BacklogPolicy::LatestOnly ? coalesced > 0 : coalesced == 0);
+    }
+}
+
+// LED changes at 1 kHz against a rate-limited output channel with a slow
+// write: every change ends up in exactly one report or is coalesced, the
+// rate limit holds, and the last report written carries the final state
+TEST(OutputCoalescesLedChanges) {
+    constexpr float MAX_OUTPUT_RATE = OutputReportScheduler::DEFAULT_MAX_RATE_HZ;
+    SimulatedDualSense device(SimulatedDualSense::Transport::Bluetooth);
+    device.setMaxOutputRate(MAX_OUTPUT_RATE);
+    device.setOutputWriteLatency(std::chrono::microseconds(2000));
+    device.connect();
+
+    PacingScheduler pacer;
+    pacer.setRate(1000.0f);
+    uint64_t changes = 0;
+    uint8_t r = 0;
+    uint8_t g = 0;
+    uint8_t b = 0;
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::seconds(1);
+    while (std::chrono::steady_clock::now() < end) {
+        pacer.waitNext();
+        // Every call is a real change (never the default blue)
+        r = static_cast<uint8_t>(changes + 1);
+        g = static_cast<uint8_t>((changes + 1) >> 8);
+        b = static_cast<uint8_t>(255 - r);
+        device.setLEDColor(r, g, b);
+        changes++;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Let the last pending report go out
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    OutputReportStats stats = device.getOutputReportStats();
+    std::vector<uint8_t> last = device.getLastOutputReport();
+    device.disconnect();
+
+    // The connect-time report plus one per change, each either sent or merged
+    CHECK(stats.sent + stats.coalesced == changes + 1);
+    CHECK(stats.sent <= static_cast<uint64_t>(seconds * MAX_OUTPUT_RATE) + 2);
+    DualSenseOutputState written;
+    CHECK(decodeDualSenseOutputReport(last.data(), last.size(), written));
+    CHECK(written.ledR == r && written.ledG == g && written.ledB == b);
+}
+
+// Two scripts calling set_rumble / set_trigger_effect every frame: the
+// calls collapse to rate-limited, well-formed reports, and the last one
+// carries the final frame's requests (the later set_rumble in a frame wins)
+TEST(ScriptHapticsReachOutputReports) {
+    ScriptFolder folder("ps5scripts_tests_haptics");
+    folder.write("rumble.lua",
+        "function process(input)\n"
+        "    set_rumble(input.right_trigger, 0.25)\n"
+        "    set_trigger_effect(\"right\", \"weapon\", {40, 160, 200})\n"
+        "    set_rumble(input.right_trigger, 0.5)\n"
+        "    return input\n"
+        "end\n");
+    folder.write("resistance.lua",
+        "function process(input)\n"
+        "    set_trigger_effect(\"left\", \"resistance\", {math.floor(input.left_trigger * 255), 200})\n"
+        "    return input\n"
+        "end\n");
+
+    auto device = std::make_unique<SimulatedDualSense>(SimulatedDualSense::Transport::Bluetooth);
+    device->setReportRate(1000.0f);
+    SimulatedDualSense* devicePtr = device.get();
+    InputProcessor processor(std::move(device), std::make_unique<NullSink>());
+    CHECK(processor.initialize(nullptr, folder.path()));
+    enableAllScripts(processor);
+
+    // Connect, then capture from a clean slate
+    processor.update(10);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    devicePtr->setOutputCapture(true);
+    devicePtr->resetOutputReportStats();
+
+    auto start = std::chrono::steady_clock::now();
+    runFor(processor, std::chrono::milliseconds(1000));
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    NormalizedState lastInput = processor.getInputState();
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    std::vector<std::vector<uint8_t>> captured = devicePtr->takeCapturedOutputReports();
+
+    size_t malformed = 0;
+    DualSenseOutputState last;
+    for (const auto& bytes : captured) {
+        malformed += decodeDualSenseOutputReport(bytes.data(), bytes.size(), last) ? 0 : 1;
+    }
+    CHECK(!captured.empty());
+    CHECK(malformed == 0);
+    CHECK(captured.size() <= static_cast<size_t>(seconds * OutputReportScheduler::DEFAULT_MAX_RATE_HZ) + 2);
+
+    DualSenseTriggerEffect right;
+    right.mode = DUALSENSE_TRIGGER_WEAPON;
+    right.params[0] = 40;
+    right.params[1] = 160;
+    right.params[2] = 200;
+    DualSenseTriggerEffect left;
+    left.mode = DUALSENSE_TRIGGER_RESISTANCE;
+    left.params[0] = static_cast<uint8_t>(std::floor(lastInput.leftTrigger * 255.0f));
+    left.params[1] = 200;
+    CHECK(last.rumbleLeft == static_cast<uint8_t>(std::clamp(lastInput.rightTrigger, 0.0f, 1.0f) * 255.0f + 0.5f));
+    CHECK(last.rumbleRight == static_cast<uint8_t>(0.5f * 255.0f + 0.5f));
+    CHECK(last.rightTrigger == right);
+    CHECK(last.leftTrigger == left);
+}
+
+// The generator's touch routine through the pipeline: a script counting each
+// gesture event sees what the recognizer finds natively
+TEST(ScriptsSeeGestures) {
+    constexpr size_t REPORT_COUNT = 8000;
+    const char* const GESTURES[] = {"tap", "two_finger_tap", "swipe_left", "swipe_right",
+                                    "swipe_up", "swipe_down", "pinch_in", "pinch_out"};
+    const uint8_t BITS[] = {GESTURE_TAP, GESTURE_TWO_FINGER_TAP, GESTURE_SWIPE_LEFT, GESTURE_SWIPE_RIGHT,
+                            GESTURE_SWIPE_UP, GESTURE_SWIPE_DOWN, GESTURE_PINCH_IN, GESTURE_PINCH_OUT};
+
+    ScriptFolder folder("ps5scripts_tests_touch");
+    std::string script = "function process(input)\n";
+    for (const char* gesture : GESTURES) {
+        script += std::string("    if input.") + gesture + " then set_param(\"" + gesture + "\", get_param(\"" +
+                  gesture + "\") + 1) end\n";
+    }
+    script += "    return input\nend\n";
+    folder.write("gestures.lua", script);
+
+    auto device = std::make_unique<SimulatedDualSense>(SimulatedDualSense::Transport::Bluetooth);
+    device->setReportRate(0.0f);
+    auto sink = std::make_unique<NullSink>();
+    NullSink* sinkPtr = sink.get();
+    InputProcessor processor(std::move(device), std::move(sink));
+    CHECK(processor.initialize(nullptr, folder.path()));
+    processor.setBacklogPolicy(BacklogPolicy::ReplayAll);
+    processor.setDeltaTimeSource(DeltaTimeSource::Device);
+    enableAllScripts(processor);
+    while (sinkPtr->getFrameCount() < REPORT_COUNT) {
+        processor.update(10);
+    }
+    size_t frames = static_cast<size_t>(sinkPtr->getFrameCount());
+
+    uint64_t expected[8] = {};
+    TouchGestureRecognizer recognizer;
+    for (const auto& report : generateReports(true, frames)) {
+        ControllerState state;
+        parseDualSenseReport(report.data(), report.size(), state);
+        uint8_t events = recognizer.update(state.touch, 0.001f);
+        for (size_t g = 0; g < 8; g++) {
+            expected[g] += (events & BITS[g]) ? 1 : 0;
+        }
+    }
+
+    const auto& scripts = processor.getScriptManager().getScripts();
+    CHECK(!scripts.empty());
+    for (size_t g = 0; g < 8 && !scripts.empty(); g++) {
+        CHECK(static_cast<uint64_t>(scripts[0].engine->getParameter(GESTURES[g], 0.0f)) == expected[g]);
+    }
+}
+
+// Scripts see the factory-calibrated accelerometer: gravity as 1 g at rest
+TEST(ScriptsSeeCalibratedMotion) {
+    ScriptFolder folder("ps5scripts_tests_calibration");
+    folder.write("gravity.lua",
+        "function process(input)\n"
+        "    set_param(\"accel_y\", input.accel_y)\n"
+        "    return input\n"
+        "end\n");
+    InputProcessor processor(std::make_unique<SimulatedDualSense>(SimulatedDualSense::Transport::Bluetooth),
+                             std::make_unique<NullSink>());
+    CHECK(processor.initialize(nullptr, folder.path()));
+    enableAllScripts(processor);
+    for (int i = 0; i < 10; i++) {
+        processor.update(10);
+    }
+    const auto& scripts = processor.getScriptManager().getScripts();
+    float gravity = scripts.empty() ? 0.0f : scripts[0].engine->getParameter("accel_y", 0.0f);
+    CHECK(processor.hasFactoryCalibration());
+    CHECK(std::abs(gravity - 1.0f) <= 0.001f);
+}
+
+// The filter tracks tilt through 10 s of rotation on all axes, and
+// still-detection removes the gyro bias so yaw stops drifting at rest
+TEST(FusionTracksTiltAndRemovesBias) {
+    const double bias[3] = {1.5, -2.0, 1.0};
+    std::vector<FusionSample> samples = generateFusionTrajectory(20.0, bias);
+
+    MotionFusion fusion;
+    fusion.setAutoBias(true);
+    double maxTiltErrorDeg = 0.0;
+    double yawSum = 0.0;
+    size_t yawCount = 0;
+    size_t restStart = samples.size() - 2000;
+    for (size_t i = 0; i < samples.size(); i++) {
+        FusionSample& sample = samples[i];
+        fusion.update(sample.state, sample.context, sample.state.deltaTime);
+        double dot = -(sample.context.gravityX * sample.upX + sample.context.gravityY * sample.upY +
+                       sample.context.gravityZ * sample.upZ);
+        maxTiltErrorDeg = std::max(maxTiltErrorDeg,
+                                   std::acos(std::clamp(dot, -1.0, 1.0)) * 180.0 / 3.14159265358979323846);
+        if (i >= restStart) {
+            yawSum += sample.context.yawRate;
+            yawCount++;
+        }
+    }
+    CHECK(maxTiltErrorDeg <= 3.0);
+    CHECK(std::abs(yawSum / static_cast<double>(yawCount)) <= 0.1);
+    for (int axis = 0; axis < 3; axis++) {
+        CHECK(std::abs(fusion.getGyroBias()[axis] - bias[axis]) <= 0.1);
+    }
+}
+
+// Unplugging disconnects the running pipeline; re-plugging with a poke (as an
+// arrival notification or the Reconnect button gives) brings frames back
+TEST(PipelineReconnectsAfterReplug) {
+    ScriptFolder folder("ps5scripts_tests_hotplug");
+    auto device = std::make_unique<SimulatedDualSense>();
+    device->setReportRate(1000.0f);
+    SimulatedDualSense* devicePtr = device.get();
+    auto sink = std::make_unique<NullSink>();
+    NullSink* sinkPtr = sink.get();
+    InputProcessor processor(std::move(device), std::move(sink));
+    CHECK(processor.initialize(nullptr, folder.path()));
+    CHECK(processor.start());
+    processor.setInputMode(InputMode::EventDriven);
+
+    auto waitFor = [](auto condition) {
+        for (int i = 0; i < 3000 && !condition(); i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return condition();
+    };
+    CHECK(waitFor([&] { return sinkPtr->getFrameCount() > 0; }));
+
+    devicePtr->setPluggedIn(false);
+    CHECK(waitFor([&] { return !processor.isDualSenseConnected(); }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    uint64_t frames = sinkPtr->getFrameCount();
+    devicePtr->setPluggedIn(true);
+    processor.reconnectDualSense();
+    CHECK(waitFor([&] { return sinkPtr->getFrameCount() > frames; }));
+    CHECK(processor.getHotplugStats().connects >= 1);
+    processor.stop();
+}
+
+// Pooled pads keep their input mode: a periodic pad is serviced by a worker,
+// an event-driven one runs on its own thread, and switching the pool's mode
+// moves both onto the workers
+TEST(PoolKeepsEachPadsInputMode) {
+    ScriptFolder folder("ps5scripts_tests_pool");
+    PipelinePool pool(2);
+    std::vector<NullSink*> sinks;
+    for (InputMode mode : {InputMode::Periodic, InputMode::EventDriven}) {
+        auto device = std::make_unique<SimulatedDualSense>();
+        device->setReportRate(1000.0f);
+        auto sink = std::make_unique<NullSink>();
+        sinks.push_back(sink.get());
+        auto pipeline = std::make_unique<InputProcessor>(std::move(device), std::move(sink));
+        CHECK(pipeline->initialize(nullptr, folder.path()));
+        pipeline->setInputMode(mode);
+        pool.add(std::move(pipeline));
+    }
+
+    auto waitForFrames = [&]() {
+        uint64_t before[2] = {sinks[0]->getFrameCount(), sinks[1]->getFrameCount()};
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while ((sinks[0]->getFrameCount() < before[0] + 50 || sinks[1]->getFrameCount() < before[1] + 50) &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        return sinks[0]->getFrameCount() >= before[0] + 50 && sinks[1]->getFrameCount() >= before[1] + 50;
+    };
+
+    CHECK(pool.start());
+    CHECK(pool.getWorkerCount() == 1);
+    CHECK(waitForFrames());
+    CHECK(pool.get(0).getInputMode() == InputMode::Periodic);
+    CHECK(pool.get(1).getInputMode() == InputMode::EventDriven);
+    CHECK(pool.getServiceHistogram(0).count() > 0);
+    CHECK(pool.getServiceHistogram(1).count() == 0);
+
+    pool.setInputMode(InputMode::Periodic);
+    pool.resetServiceHistograms();
+    CHECK(pool.isRunning());
+    CHECK(pool.getWorkerCount() == 2);
+    CHECK(waitForFrames());
+    CHECK(pool.getServiceHistogram(0).count() > 0);
+    CHECK(pool.getServiceHistogram(1).count() > 0);
+    pool.stop();
+}
@@ -0,0 +1,323 @@
+// Input report parsing, Xbox conversion, CRC-32, Bluetooth validation,
+// motion calibration and touch decoding
+
+#include "TestHarness.h"
+#include "BenchSupport.h"
+#include "LegacyReference.h"
+#include "DualSenseReport.h"
+#include "XusbReport.h"
+#include "Crc32.h"
+#include "SimulatedDualSense.h"
+#include "TouchGestures.h"
+#include <cmath>
+#include <random>
+
+namespace {
+
+// Legacy button bools against the bits that replaced them
+struct LegacyButton {
+    bool legacy::ControllerState::* member;
+    uint32_t bit;
+};
+
+constexpr LegacyButton LEGACY_BUTTONS[] = {
+    {&legacy::ControllerState::square, BUTTON_SQUARE}, {&legacy::ControllerState::cross, BUTTON_CROSS},
+    {&legacy::ControllerState::circle, BUTTON_CIRCLE}, {&legacy::ControllerState::triangle, BUTTON_TRIANGLE},
+    {&legacy::ControllerState::l1, BUTTON_L1}, {&legacy::ControllerState::r1, BUTTON_R1},
+    {&legacy::ControllerState::l2Button, BUTTON_L2}, {&legacy::ControllerState::r2Button, BUTTON_R2},
+    {&legacy::ControllerState::share, BUTTON_SHARE}, {&legacy::ControllerState::options, BUTTON_OPTIONS},
+    {&legacy::ControllerState::l3, BUTTON_L3}, {&legacy::ControllerState::r3, BUTTON_R3},
+    {&legacy::ControllerState::ps, BUTTON_PS}, {&legacy::ControllerState::touchpad, BUTTON_TOUCHPAD},
+    {&legacy::ControllerState::mute, BUTTON_MUTE}
+};
+
+// The legacy parser decoded only the first touch contact, only over USB, and
+// kept the old position while the finger was lifted; touch is compared where
+// it decoded anything
+bool sameState(const legacy::ControllerState& a, const ControllerState& b, bool compareTouch) {
+    if (compareTouch) {
+        const TouchPoint& touch = b.touch[0];
+        if (a.touchActive != touch.active ||
+            (a.touchActive && (a.touchX != touch.x || a.touchY != touch.y))) {
+            return false;
+        }
+    }
+    for (const LegacyButton& entry : LEGACY_BUTTONS) {
+        if (a.*entry.member != b.button(entry.bit)) {
+            return false;
+        }
+    }
+    return a.leftStickX == b.leftStickX && a.leftStickY == b.leftStickY &&
+           a.rightStickX == b.rightStickX && a.rightStickY == b.rightStickY &&
+           a.leftTrigger == b.leftTrigger && a.rightTrigger == b.rightTrigger &&
+           a.dpad == b.dpad &&
+           a.gyroX == b.gyroX && a.gyroY == b.gyroY && a.gyroZ == b.gyroZ &&
+           a.accelX == b.accelX && a.accelY == b.accelY && a.accelZ == b.accelZ &&
+           a.sensorTimestamp == b.sensorTimestamp && a.timestamp == b.timestamp;
+}
+
+XusbReport convertLegacy(const legacy::ControllerState& state) {
+    return legacy::toXusbReport(legacy::normalizeControllerState(state));
+}
+
+XusbReport convertPacked(const ControllerState& state) {
+    return toXusbReport(normalizeControllerState(state));
+}
+
+}  // namespace
+
+// Random payloads with a valid report ID decode to the same state as the
+// original hand-written parsers. The stream is parsed in order, as the
+// device would send it, so a field that persisted between legacy reports
+// (touch position) is compared too.
+TEST(ParserMatchesLegacy) {
+    for (bool bluetooth : {false, true}) {
+        std::mt19937 rng(bluetooth ? 31 : 1);
+        size_t size = bluetooth ? DUALSENSE_BT_INPUT_REPORT_SIZE : DUALSENSE_USB_INPUT_REPORT_SIZE;
+        legacy::ControllerState expected;
+        ControllerState actual;
+        size_t mismatches = 0;
+        for (int i = 0; i < 4096; i++) {
+            std::vector<uint8_t> report(size);
+            for (auto& byte : report) {
+                byte = static_cast<uint8_t>(rng());
+            }
+            report[0] = bluetooth ? DUALSENSE_BT_INPUT_REPORT_ID : DUALSENSE_USB_INPUT_REPORT_ID;
+            bool expectedOk = legacy::parseDualSenseReport(report.data(), report.size(), expected);
+            bool actualOk = parseDualSenseReport(report.data(), report.size(), actual);
+            mismatches += (expectedOk != actualOk || !sameState(expected, actual, !bluetooth)) ? 1 : 0;
+        }
+        CHECK(mismatches == 0);
+    }
+}
+
+TEST(ParserRejectsShortAndUnknownReports) {
+    std::vector<std::vector<uint8_t>> reports = generateReports(false, 1);
+    ControllerState state;
+    CHECK(parseDualSenseReport(reports[0].data(), reports[0].size(), state));
+    CHECK(!parseDualSenseReport(reports[0].data(), 10, state));
+    reports[0][0] = 0x02;
+    CHECK(!parseDualSenseReport(reports[0].data(), reports[0].size(), state));
+}
+
+// Generator states and every button combination with every D-Pad value give
+// the same Xbox report as the one-bool-per-button conversion
+TEST(XusbMatchesLegacy) {
+    size_t mismatches = 0;
+    for (const auto& report : generateReports(false, 4096)) {
+        legacy::ControllerState legacyState;
+        ControllerState packedState;
+        legacy::parseDualSenseReport(report.data(), report.size(), legacyState);
+        parseDualSenseReport(report.data(), report.size(), packedState);
+        mismatches += convertLegacy(legacyState) != convertPacked(packedState) ? 1 : 0;
+    }
+
+    for (uint32_t buttons = 0; buttons < (1u << BUTTON_COUNT); buttons++) {
+        uint8_t dpad = static_cast<uint8_t>(buttons % 9);
+        legacy::ControllerState legacyState;
+        ControllerState packedState;
+        for (const LegacyButton& entry : LEGACY_BUTTONS) {
+            legacyState.*entry.member = (buttons & entry.bit) != 0;
+        }
+        packedState.buttons = buttons;
+        legacyState.dpad = dpad;
+        packedState.dpad = dpad;
+        mismatches += convertLegacy(legacyState) != convertPacked(packedState) ? 1 : 0;
+    }
+    CHECK(mismatches == 0);
+}
+
+// Standard check value, then random lengths against the bitwise reference,
+// in one call and chained
+TEST(Crc32MatchesReference) {
+    const char* check = "123456789";
+    CHECK(crc32(reinterpret_cast<const uint8_t*>(check), 9) == 0xCBF43926u);
+
+    std::mt19937 rng(7);
+    for (size_t length = 0; length < 256; length++) {
+        std::vector<uint8_t> data(length);
+        for (auto& byte : data) {
+            byte = static_cast<uint8_t>(rng());
+        }
+        size_t split = length / 3;
+        uint32_t chained = crc32Update(crc32Update(0, data.data(), split), data.data() + split, length - split);
+        uint32_t expected = crc32Bitwise(data.data(), length);
+        CHECK(crc32(data.data(), length) == expected);
+        CHECK(chained == expected);
+    }
+}
+
+// Every generated Bluetooth report passes; any single flipped bit fails
+TEST(BluetoothInputRejectsFlippedBits) {
+    std::vector<std::vector<uint8_t>> reports = generateReports(true, 4096);
+    std::mt19937 rng(7);
+    DualSenseReportValidator validator;
+    size_t validRejected = 0;
+    size_t corruptAccepted = 0;
+    for (auto& report : reports) {
+        validRejected += validator.accept(report.data(), report.size()) ? 0 : 1;
+        std::vector<uint8_t> corrupt = report;
+        size_t bit = rng() % (corrupt.size() * 8);
+        corrupt[bit / 8] ^= static_cast<uint8_t>(1u << (bit % 8));
+        // A flipped report ID is no longer a Bluetooth report; the parser rejects it
+        if (corrupt[0] == DUALSENSE_BT_INPUT_REPORT_ID && validator.accept(corrupt.data(), corrupt.size())) {
+            corruptAccepted++;
+        }
+    }
+    CHECK(validRejected == 0);
+    CHECK(corruptAccepted == 0);
+    CHECK(validator.getStats().crcFailures > 0);
+}
+
+TEST(BluetoothOutputReportIsSigned) {
+    uint8_t output[DUALSENSE_MAX_OUTPUT_REPORT_SIZE];
+    DualSenseOutputState state;
+    state.ledR = 10;
+    state.rumbleLeft = 200;
+    size_t size = encodeDualSenseOutputReport(state, true, 5, output, sizeof(output));
+    CHECK(size == DUALSENSE_BT_OUTPUT_REPORT_SIZE);
+    CHECK(checkDualSenseBtCrc(DUALSENSE_BT_OUTPUT_CRC_SEED, output, size));
+
+    DualSenseOutputState decoded;
+    CHECK(decodeDualSenseOutputReport(output, size, decoded));
+    CHECK(decoded.ledR == 10 && decoded.rumbleLeft == 200);
+}
+
+// The feature report round-trips over USB and Bluetooth, the reference
+// readings map to their physical values, and a single flipped bit fails the
+// Bluetooth CRC
+TEST(CalibrationRoundTrips) {
+    DualSenseCalibrationData data = SimulatedDualSense::defaultCalibrationData();
+    for (bool bluetooth : {false, true}) {
+        uint8_t report[DUALSENSE_CALIBRATION_REPORT_SIZE];
+        size_t size = encodeDualSenseCalibrationReport(data, bluetooth, report, sizeof(report));
+        DualSenseCalibration calibration;
+        CHECK(parseDualSenseCalibrationReport(report, size, bluetooth, calibration));
+        CHECK(calibration.factory);
+
+        double worstGyro = 0.0;
+        double worstAccel = 0.0;
+        for (int axis = 0; axis < 3; axis++) {
+            auto gyro = [&](int16_t raw) -> double {
+                return raw * calibration.gyroScale[axis] + calibration.gyroOffset[axis];
+            };
+            auto accel = [&](int16_t raw) -> double {
+                return raw * calibration.accelScale[axis] + calibration.accelOffset[axis];
+            };
+            worstGyro = std::max({worstGyro, std::abs(gyro(data.gyroPlus[axis]) - data.gyroSpeedPlus),
+                                  std::abs(gyro(data.gyroMinus[axis]) + data.gyroSpeedMinus),
+                                  std::abs(gyro(data.gyroBias[axis]))});
+            worstAccel = std::max({worstAccel, std::abs(accel(data.accelPlus[axis]) - 1.0),
+                                   std::abs(accel(data.accelMinus[axis]) + 1.0)});
+        }
+        CHECK(worstGyro <= 0.01);
+        CHECK(worstAccel <= 1e-5);
+
+        if (bluetooth) {
+            size_t corruptAccepted = 0;
+            for (size_t byte = 1; byte < size - DUALSENSE_BT_CRC_SIZE; byte++) {
+                report[byte] ^= 0x10;
+                DualSenseCalibration ignored;
+                corruptAccepted += parseDualSenseCalibrationReport(report, size, true, ignored) ? 1 : 0;
+                report[byte] ^= 0x10;
+            }
+            CHECK(corruptAccepted == 0);
+        }
+    }
+}
+
+// Unusable data keeps the nominal ranges
+TEST(DegenerateCalibrationIsRejected) {
+    DualSenseCalibrationData broken = SimulatedDualSense::defaultCalibrationData();
+    broken.accelPlus[1] = broken.accelMinus[1];
+    DualSenseCalibration fallback;
+    CHECK(!computeDualSenseCalibration(broken, fallback));
+    CHECK(!fallback.factory);
+}
+
+// Two simulated units with different sensitivities and biases report the
+// same motion in deg/s and g once calibrated, to one raw count per unit
+TEST(CalibratedUnitsAgree) {
+    DualSenseCalibrationData other = SimulatedDualSense::defaultCalibrationData();
+    const int16_t gyroBias[3] = {-11, 7, 15};
+    const int16_t gyroSpan[3] = {9150, 8420, 8700};
+    const int16_t accelBias[3] = {-60, 35, -80};
+    const int16_t accelSpan[3] = {8010, 8390, 8120};
+    for (int axis = 0; axis < 3; axis++) {
+        other.gyroBias[axis] = gyroBias[axis];
+        other.gyroPlus[axis] = static_cast<int16_t>(gyroBias[axis] + gyroSpan[axis]);
+        other.gyroMinus[axis] = static_cast<int16_t>(gyroBias[axis] - gyroSpan[axis]);
+        other.accelPlus[axis] = static_cast<int16_t>(accelBias[axis] + accelSpan[axis]);
+        other.accelMinus[axis] = static_cast<int16_t>(accelBias[axis] - accelSpan[axis]);
+    }
+
+    SimulatedDualSense a;
+    SimulatedDualSense b;
+    b.setCalibrationData(other);
+    a.connect();
+    b.connect();
+
+    double gyroError = 0.0;
+    double accelError = 0.0;
+    for (int i = 0; i < 4000 && a.update() && b.update(); i++) {
+        NormalizedState x = a.getNormalizedState();
+        NormalizedState y = b.getNormalizedState();
+        gyroError = std::max({gyroError, std::abs(double(x.gyroX) - y.gyroX),
+                              std::abs(double(x.gyroY) - y.gyroY), std::abs(double(x.gyroZ) - y.gyroZ)});
+        accelError = std::max({accelError, std::abs(double(x.accelX) - y.accelX),
+                               std::abs(double(x.accelY) - y.accelY), std::abs(double(x.accelZ) - y.accelZ)});
+    }
+    CHECK(gyroError <= 0.15);
+    CHECK(accelError <= 0.0005);
+}
+
+// Both contacts decode the same over USB and Bluetooth
+TEST(TouchDecodesTheSameOverUsbAndBluetooth) {
+    std::vector<std::vector<uint8_t>> usbReports = generateReports(false, 4000);
+    std::vector<std::vector<uint8_t>> btReports = generateReports(true, 4000);
+    CHECK(usbReports.size() == btReports.size());
+    size_t mismatches = 0;
+    size_t twoContactFrames = 0;
+    for (size_t i = 0; i < usbReports.size() && i < btReports.size(); i++) {
+        ControllerState usb;
+        ControllerState bt;
+        parseDualSenseReport(usbReports[i].data(), usbReports[i].size(), usb);
+        parseDualSenseReport(btReports[i].data(), btReports[i].size(), bt);
+        for (int c = 0; c < TOUCH_POINT_COUNT; c++) {
+            const TouchPoint& a = usb.touch[c];
+            const TouchPoint& b = bt.touch[c];
+            mismatches += (a.active != b.active || a.id != b.id || a.x != b.x || a.y != b.y) ? 1 : 0;
+        }
+        twoContactFrames += (usb.touch[0].active && usb.touch[1].active) ? 1 : 0;
+    }
+    CHECK(mismatches == 0);
+    CHECK(twoContactFrames > 0);
+}
+
+// The generator's 4 s touch routine is a tap, a swipe right, a pinch out and
+// a two-finger tap; each cycle must give exactly those gestures
+TEST(GesturesMatchTouchRoutine) {
+    constexpr size_t CYCLES = 3;
+    const struct {
+        uint8_t bit;
+        int perCycle;       // -1 = at least one
+    } expected[] = {
+        {GESTURE_TAP, 1}, {GESTURE_TWO_FINGER_TAP, 1}, {GESTURE_SWIPE_LEFT, 0}, {GESTURE_SWIPE_RIGHT, 1},
+        {GESTURE_SWIPE_UP, 0}, {GESTURE_SWIPE_DOWN, 0}, {GESTURE_PINCH_IN, 0}, {GESTURE_PINCH_OUT, -1}
+    };
+
+    uint64_t counts[sizeof(expected) / sizeof(expected[0])] = {};
+    TouchGestureRecognizer recognizer;
+    for (const auto& report : generateReports(false, CYCLES * 4000)) {
+        ControllerState state;
+        parseDualSenseReport(report.data(), report.size(), state);
+        uint8_t events = recognizer.update(state.touch, 0.001f);
+        for (size_t g = 0; g < sizeof(expected) / sizeof(expected[0]); g++) {
+            counts[g] += (events & expected[g].bit) ? 1 : 0;
+        }
+    }
+    for (size_t g = 0; g < sizeof(expected) / sizeof(expected[0]); g++) {
+        int perCycle = expected[g].perCycle;
+        CHECK(perCycle < 0 ? counts[g] >= CYCLES : counts[g] == perCycle * CYCLES);
+    }
+}
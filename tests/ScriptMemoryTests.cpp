@@ -0,0 +1,104 @@
+// Per-script Lua heap: the pooled arena, collector modes and the heap cap
+
+#include "TestHarness.h"
+#include "ScriptEngine.h"
+#include "LuaArena.h"
+
+namespace {
+
+// Leaves a small table and a string behind every frame
+const char* const LUA_GC_GARBAGE =
+    "local history = {}\n"
+    "local frame = 0\n"
+    "function process(input)\n"
+    "    frame = frame + 1\n"
+    "    local snapshot = { x = input.left_x, y = input.left_y, t = input.dt, n = frame }\n"
+    "    history[frame % 64 + 1] = snapshot\n"
+    "    local label = \"frame \" .. frame\n"
+    "    input.left_x = snapshot.x + #label * 0\n"
+    "    return input\n"
+    "end\n";
+
+const char* const LUA_GC_LEAK =
+    "local kept = {}\n"
+    "function process(input)\n"
+    "    for i = 1, 64 do kept[#kept + 1] = { input.left_x, i } end\n"
+    "    return input\n"
+    "end\n";
+
+void* failChunk(size_t) {
+    return nullptr;
+}
+
+}  // namespace
+
+// Under either collector mode the collector steps after frames, and once
+// warm the script's pool stops growing
+TEST(CollectorKeepsPoolStable) {
+    for (ScriptGcMode mode : {ScriptGcMode::Generational, ScriptGcMode::Incremental}) {
+        ScriptEngine engine;
+        engine.setGcMode(mode);
+        CHECK(engine.initialize() && engine.loadScriptString(LUA_GC_GARBAGE, "gc"));
+
+        NormalizedState state;
+        for (int i = 0; i < 20000; i++) {
+            engine.process(state, 0.001f);
+        }
+        size_t reserved = engine.getMemoryStats().reservedBytes;
+        engine.resetMemoryStats();
+        for (int i = 0; i < 50000; i++) {
+            state.leftStickX = static_cast<float>(i % 100) / 100.0f;
+            engine.process(state, 0.001f);
+        }
+
+        ScriptMemoryStats memory = engine.getMemoryStats();
+        CHECK(memory.gcSteps > 0);
+        CHECK(memory.reservedBytes <= reserved);
+        CHECK(engine.getLastError().empty());
+    }
+}
+
+// A leak runs into the cap and fails with "not enough memory" without the
+// heap passing the cap; failed frames pass the input through
+TEST(LeakStopsAtHeapCap) {
+    constexpr size_t LIMIT = 256 * 1024;
+    ScriptEngine engine;
+    engine.setMemoryLimit(LIMIT);
+    CHECK(engine.initialize() && engine.loadScriptString(LUA_GC_LEAK, "leak"));
+
+    NormalizedState input;
+    input.leftStickX = 0.5f;
+    bool passedThrough = true;
+    for (int frames = 0; frames < 100000 && engine.getLastError().empty(); frames++) {
+        passedThrough = engine.process(input, 0.001f).leftStickX == input.leftStickX && passedThrough;
+    }
+    for (int i = 0; i < 100; i++) {
+        passedThrough = engine.process(input, 0.001f).leftStickX == input.leftStickX && passedThrough;
+    }
+
+    ScriptMemoryStats memory = engine.getMemoryStats();
+    CHECK(engine.getLastError().find("not enough memory") != std::string::npos);
+    CHECK(memory.failedAllocations > 0);
+    CHECK(memory.peakBytes <= LIMIT);
+    CHECK(passedThrough);
+}
+
+// Shrinking a large block into the pool with no chunk to carve from keeps
+// the block, still counted at its old size, and does not count as a failure;
+// once freed it serves pooled allocations
+TEST(ShrinkWithoutChunkKeepsBlock) {
+    LuaArena arena;
+    arena.setChunkAllocator(failChunk);
+    void* large = LuaArena::allocate(&arena, nullptr, 0, 1024);
+    CHECK(large != nullptr);
+
+    void* shrunk = LuaArena::allocate(&arena, large, 1024, 64);
+    CHECK(shrunk == large);
+    CHECK(arena.getBytesInUse() == 1024);
+    CHECK(arena.getFailedAllocations() == 0);
+
+    LuaArena::allocate(&arena, shrunk, 64, 0);
+    CHECK(LuaArena::allocate(&arena, nullptr, 0, 64) == large);
+    CHECK(LuaArena::allocate(&arena, nullptr, 0, 64) == nullptr);
+    CHECK(arena.getFailedAllocations() == 1);
+}
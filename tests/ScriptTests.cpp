@@ -0,0 +1,245 @@
+// Script engine: the userdata and table state bridges, parameters, engines
+// on several threads, and the per-script Lua heap
+
+#include "TestHarness.h"
+#include "BenchSupport.h"
+#include "ScriptEngine.h"
+#include <cmath>
+
+namespace {
+
+const char* const LUA_BRIDGE_PASSTHROUGH =
+    "function process(input) return input end\n";
+
+const char* const LUA_BRIDGE_TYPICAL =
+    "function process(input)\n"
+    "    local output = input\n"
+    "    output.left_x = deadzone(input.left_x, 0.1)\n"
+    "    output.left_y = deadzone(input.left_y, 0.1)\n"
+    "    output.right_x = deadzone(input.right_x, 0.05)\n"
+    "    output.right_y = deadzone(input.right_y, 0.05)\n"
+    "    if input.cross and input.right_trigger > 0.5 then\n"
+    "        output.circle = not input.circle\n"
+    "    end\n"
+    "    output.gyro_x = input.gyro_x * 0.5 + input.dt\n"
+    "    return output\n"
+    "end\n";
+
+const char* const LUA_BRIDGE_COPY =
+    "function process(input)\n"
+    "    local output = {}\n"
+    "    for k, v in pairs(input) do output[k] = v end\n"
+    "    output.scratch = output.left_x\n"
+    "    output.right_y = -output.right_y\n"
+    "    return output\n"
+    "end\n";
+
+// A key the script adds to the state must not survive to the next frame
+const char* const LUA_BRIDGE_EXTRA_KEY =
+    "function process(input)\n"
+    "    input.left_x = input.seen and 1 or 0\n"
+    "    input.seen = true\n"
+    "    return input\n"
+    "end\n";
+
+#define LUA_PARAMS_DECLARATIONS \
+    "script_info = { name = \"Params\", parameters = {\n" \
+    "    { key = \"strength_ads\", default = 0.15 }, { key = \"strength_hipfire\", default = 0.10 },\n" \
+    "    { key = \"horizontal_strength\", default = 0.0 }, { key = \"smoothing\", default = 0.5 },\n" \
+    "    { key = \"fire_threshold\", default = 0.3 }, { key = \"ads_threshold\", default = 0.3 } } }\n"
+
+const char* const LUA_PARAMS_GET =
+    LUA_PARAMS_DECLARATIONS
+    "function process(input)\n"
+    "    input.left_x = get_param(\"strength_ads\", 0.15) + get_param(\"strength_hipfire\", 0.10) +\n"
+    "        get_param(\"horizontal_strength\", 0.0) + get_param(\"smoothing\", 0.5) +\n"
+    "        get_param(\"fire_threshold\", 0.3) + get_param(\"ads_threshold\", 0.3)\n"
+    "    return input\n"
+    "end\n";
+
+const char* const LUA_PARAMS_TABLE =
+    LUA_PARAMS_DECLARATIONS
+    "function process(input)\n"
+    "    input.left_x = params.strength_ads + params.strength_hipfire + params.horizontal_strength +\n"
+    "        params.smoothing + params.fire_threshold + params.ads_threshold\n"
+    "    return input\n"
+    "end\n";
+
+#undef LUA_PARAMS_DECLARATIONS
+
+// Fields a script can change (the rest are passed through)
+bool sameScriptOutput(const NormalizedState& a, const NormalizedState& b) {
+    return a.leftStickX == b.leftStickX && a.leftStickY == b.leftStickY && a.rightStickX == b.rightStickX &&
+           a.rightStickY == b.rightStickY && a.leftTrigger == b.leftTrigger && a.rightTrigger == b.rightTrigger &&
+           a.gyroX == b.gyroX && a.gyroY == b.gyroY && a.gyroZ == b.gyroZ && a.accelX == b.accelX &&
+           a.accelY == b.accelY && a.accelZ == b.accelZ && a.buttons == b.buttons && a.dpad == b.dpad &&
+           a.deltaTime == b.deltaTime;
+}
+
+// Lua heap bytes a script allocates over the given frames, with the collector
+// stopped so nothing is freed in between
+size_t luaBytesAllocated(const char* source, StateBridge bridge, const std::vector<NormalizedState>& states) {
+    ScriptEngine engine;
+    engine.setStateBridge(bridge);
+    std::string stopped = std::string("collectgarbage(\"stop\")\n") + source;
+    if (!engine.initialize() || !engine.loadScriptString(stopped, "test")) {
+        return SIZE_MAX;
+    }
+    engine.process(states[0], 0.001f);
+    size_t before = engine.getHeapBytes();
+    for (const NormalizedState& state : states) {
+        engine.process(state, 0.001f);
+    }
+    return engine.getHeapBytes() - before;
+}
+
+}  // namespace
+
+// The same script gives the same output through either bridge, including a
+// pairs() copy of the state and a key added to it
+TEST(BridgesProduceTheSameOutput) {
+    std::vector<NormalizedState> states = generateStates(4096);
+    for (const char* source : {LUA_BRIDGE_TYPICAL, LUA_BRIDGE_COPY, LUA_BRIDGE_EXTRA_KEY}) {
+        ScriptEngine table;
+        ScriptEngine userdata;
+        table.setStateBridge(StateBridge::Table);
+        CHECK(table.initialize() && table.loadScriptString(source, "table"));
+        CHECK(userdata.initialize() && userdata.loadScriptString(source, "userdata"));
+        size_t mismatches = 0;
+        for (const NormalizedState& state : states) {
+            mismatches += sameScriptOutput(table.process(state, 0.001f), userdata.process(state, 0.001f)) ? 0 : 1;
+        }
+        CHECK(mismatches == 0);
+        CHECK(table.getLastError().empty() && userdata.getLastError().empty());
+    }
+}
+
+TEST(BridgesDoNotAllocate) {
+    std::vector<NormalizedState> states = generateStates(1024);
+    for (const char* source : {LUA_BRIDGE_PASSTHROUGH, LUA_BRIDGE_TYPICAL}) {
+        CHECK(luaBytesAllocated(source, StateBridge::Userdata, states) == 0);
+        CHECK(luaBytesAllocated(source, StateBridge::Table, states) == 0);
+    }
+}
+
+// The userdata's metamethods skip the type check on argument 1, so scripts
+// must not be able to call them with anything else
+TEST(StateMetamethodsAreHidden) {
+    ScriptEngine engine;
+    CHECK(engine.initialize() && engine.loadScriptString(
+        "function process(input)\n"
+        "    assert(getmetatable(input) == false)\n"
+        "    local next_field, state = pairs(input)\n"
+        "    assert(next_field(42) == next_field(state))\n"
+        "    input.left_x = 0.5\n"
+        "    return input\n"
+        "end\n", "test"));
+    CHECK(engine.process(NormalizedState(), 0.001f).leftStickX == 0.5f);
+    CHECK(engine.getLastError().empty());
+}
+
+// Keys added around the table's metamethods, or under an integer that is also
+// a slot in the field name list, are dropped like any other
+TEST(TableBridgeDropsRawsetKeys) {
+    ScriptEngine engine;
+    engine.setStateBridge(StateBridge::Table);
+    CHECK(engine.initialize() && engine.loadScriptString(
+        "function process(input)\n"
+        "    input.left_x = (rawget(input, \"seen\") or input[1]) and 1 or 0\n"
+        "    rawset(input, \"seen\", true)\n"
+        "    input[1] = true\n"
+        "    return input\n"
+        "end\n", "test"));
+    for (int i = 0; i < 3; i++) {
+        CHECK(engine.process(NormalizedState(), 0.001f).leftStickX == 0.0f);
+    }
+    CHECK(engine.getLastError().empty());
+}
+
+TEST(ScriptInfoSelectsTableBridge) {
+    ScriptEngine engine;
+    CHECK(engine.initialize() && engine.loadScriptString(
+        "script_info = { name = \"Wants table\", state = \"table\" }\n"
+        "function process(input) assert(type(input) == \"table\") return input end\n", "test"));
+    CHECK(engine.getStateBridge() == StateBridge::Table);
+    engine.process(NormalizedState(), 0.001f);
+    CHECK(engine.getLastError().empty());
+}
+
+// Both ways of reading parameters see a host write on the next frame, and
+// neither allocates on the Lua or the C++ heap
+TEST(ParamsSeeHostWrites) {
+    std::vector<NormalizedState> states = generateStates(1024);
+    const float expected = 0.75f + 0.10f + 0.0f + 0.25f + 0.3f + 0.3f;
+    for (const char* source : {LUA_PARAMS_GET, LUA_PARAMS_TABLE}) {
+        ScriptEngine engine;
+        CHECK(engine.initialize() && engine.loadScriptString(source, "test"));
+        engine.setParameter("strength_ads", 0.75f);
+        engine.setParameter("smoothing", 0.25f);
+        CHECK(std::abs(engine.process(states[0], 0.001f).leftStickX - expected) <= 1e-5f);
+
+        uint64_t before = heapAllocationCount();
+        for (const NormalizedState& state : states) {
+            engine.process(state, 0.001f);
+        }
+        CHECK(heapAllocationCount() == before);
+        CHECK(luaBytesAllocated(source, StateBridge::Userdata, states) == 0);
+    }
+}
+
+// 32 engines created on this thread and run from 8 others. Each script
+// writes its own id through set_param, set_rumble, set_trigger_effect and
+// the state; an engine seeing another's id is cross-talk between the Lua
+// callbacks. The script works a little before its callbacks so threads get
+// preempted in between, even on one core.
+TEST(EnginesDoNotCrossTalk) {
+    constexpr size_t THREADS = 8;
+    constexpr size_t ENGINES_PER_THREAD = 4;
+    constexpr size_t FRAMES = 2000;
+    const char* const script =
+        "script_info = { name = \"Engine id\", parameters = { { key = \"id\", default = 0 } } }\n"
+        "function process(input)\n"
+        "    local work = 0\n"
+        "    for i = 1, 500 do work = work + i * input.left_x end\n"
+        "    set_param(\"seen\", params.id + work)\n"
+        "    set_rumble(params.id / 64, 0)\n"
+        "    set_trigger_effect(\"right\", params.id)\n"
+        "    input.right_x = params.id / 64\n"
+        "    return input\n"
+        "end\n";
+
+    std::vector<std::unique_ptr<ScriptEngine>> engines;
+    for (size_t i = 0; i < THREADS * ENGINES_PER_THREAD; i++) {
+        auto engine = std::make_unique<ScriptEngine>();
+        CHECK(engine->initialize() && engine->loadScriptString(script, "engine"));
+        engine->setParameter("id", static_cast<float>(i + 1));
+        engines.push_back(std::move(engine));
+    }
+
+    std::atomic<uint64_t> crossTalk{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < THREADS; t++) {
+        threads.emplace_back([&, t]() {
+            NormalizedState input;
+            for (size_t frame = 0; frame < FRAMES; frame++) {
+                size_t index = t * ENGINES_PER_THREAD + frame % ENGINES_PER_THREAD;
+                ScriptEngine& engine = *engines[index];
+                float id = static_cast<float>(index + 1);
+                NormalizedState output = engine.process(input, 0.001f);
+                DualSenseOutputRequest request = engine.takeOutputRequest();
+                if (output.rightStickX != id / 64.0f || engine.getParameter("seen", 0.0f) != id ||
+                    !request.hasRumble || request.rumbleLeft != static_cast<uint8_t>(id / 64.0f * 255.0f + 0.5f) ||
+                    !request.hasRightTrigger || request.rightTrigger.mode != static_cast<uint8_t>(id)) {
+                    crossTalk.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (frame % 64 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    CHECK(crossTalk.load() == 0);
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+// Minimal test registry for ps5scripts_tests. TEST(name) defines and
+// registers a test; CHECK(condition) records a failure and carries on, so
+// one run reports every broken expectation.
+
+#include <cstdio>
+#include <vector>
+
+namespace tests {
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& registry();
+void fail(const char* file, int line, const char* expression);
+
+struct Registrar {
+    Registrar(const char* name, void (*run)()) { registry().push_back({name, run}); }
+};
+
+}  // namespace tests
+
+#define TEST(name)                                                  \
+    static void name();                                             \
+    static const ::tests::Registrar name##Registrar(#name, name);   \
+    static void name()
+
+#define CHECK(condition)                                            \
+    do {                                                            \
+        if (!(condition)) {                                         \
+            ::tests::fail(__FILE__, __LINE__, #condition);          \
+        }                                                           \
+    } while (false)
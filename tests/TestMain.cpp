@@ -0,0 +1,49 @@
+// Correctness checks for the portable pipeline. Runs every registered test,
+// or only those named on the command line, and exits non-zero on a failure.
+//
+// Usage: ps5scripts_tests [test name ...]
+
+#include "TestHarness.h"
+#include <cstring>
+
+namespace tests {
+
+static size_t g_failures = 0;
+
+std::vector<TestCase>& registry() {
+    static std::vector<TestCase> tests;
+    return tests;
+}
+
+void fail(const char* file, int line, const char* expression) {
+    std::fprintf(stderr, "  %s:%d: CHECK(%s) failed\n", file, line, expression);
+    g_failures++;
+}
+
+}  // namespace tests
+
+int main(int argc, char* argv[]) {
+    size_t run = 0;
+    size_t failed = 0;
+    for (const tests::TestCase& test : tests::registry()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc && !selected; i++) {
+            selected = std::strcmp(argv[i], test.name) == 0;
+        }
+        if (!selected) {
+            continue;
+        }
+
+        size_t failuresBefore = tests::g_failures;
+        std::printf("[ RUN  ] %s\n", test.name);
+        std::fflush(stdout);
+        test.run();
+        bool ok = tests::g_failures == failuresBefore;
+        std::printf("[ %s ] %s\n", ok ? " OK " : "FAIL", test.name);
+        run++;
+        failed += ok ? 0 : 1;
+    }
+
+    std::printf("%zu tests, %zu failed\n", run, failed);
+    return run > 0 && failed == 0 ? 0 : 1;
+}